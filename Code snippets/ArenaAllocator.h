@@ -0,0 +1,276 @@
+/*
+ *  ArenaAllocator - memória temporária do carregador, liberada de uma vez
+ *
+ *  O carregamento de um .OBJ cria muitas estruturas que só vivem até o fim
+ *  da carga: as tabelas do ObjData, a malha indexada, as tabelas hash da
+ *  soldagem e os vetores auxiliares da otimização, dos LODs e dos meshlets.
+ *  Com o heap, cada nó de tabela hash e cada crescimento de vetor é uma
+ *  chamada a `new`. Aqui elas vêm de uma arena (ArenaResource, um
+ *  std::pmr::memory_resource): blocos grandes pedidos ao sistema e
+ *  distribuídos por incremento de ponteiro. Um pedido liberado vai para uma
+ *  lista de livres do seu tamanho (potências de 2) e é reaproveitado pelos
+ *  pedidos seguintes do mesmo tamanho; nada volta ao sistema antes da
+ *  destruição da arena, que devolve tudo de uma vez.
+ *
+ *  Pedidos de ARENA_LARGE_BYTES ou mais (os vetores do tamanho da malha) vão
+ *  direto ao sistema e são devolvidos assim que liberados: são poucos, um por
+ *  vetor grande, e sem isso os temporários de cada etapa (otimização, LODs,
+ *  meshlets) se somariam até o fim da carga em vez de reaproveitar a memória.
+ *
+ *  Os contêineres temporários (ScratchVector, ScratchHashMap) usam a arena
+ *  do ScratchScope ativo na thread em que são criados, ou o heap se não
+ *  houver nenhum: as funções de processamento não precisam receber a arena
+ *  como parâmetro e continuam funcionando sem ela. Um contêiner guarda o seu
+ *  recurso desde a criação, então não deve sobreviver à arena (o resultado
+ *  final vai para estruturas comuns, como MeshData).
+ *
+ *  A arena pode ser usada por várias threads ao mesmo tempo (a leitura
+ *  paralela do ObjParser cresce vetores criados na thread principal).
+ *
+ *  Forma de uso
+ *  -----------------
+ *  {
+ *      ArenaResource arena;
+ *      ScratchScope scope(&arena);
+ *      ObjData obj;  // vetores na arena
+ *      ...
+ *      std::cout << arena.heapAllocationCount() << " alocacoes no heap" << std::endl;
+ *  }   // toda a memória temporária é devolvida aqui
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Tamanho do primeiro bloco da arena; cada bloco novo tem o dobro do
+// anterior, até ARENA_MAX_BLOCK_BYTES
+const size_t ARENA_FIRST_BLOCK_BYTES = 1 << 20;
+const size_t ARENA_MAX_BLOCK_BYTES = 64u << 20;
+// A partir deste tamanho o pedido vai direto ao sistema
+const size_t ARENA_LARGE_BYTES = 256 * 1024;
+// Menor tamanho de pedido; os demais são arredondados para potências de 2
+const size_t ARENA_MIN_BYTES = 16;
+const int ARENA_SIZE_CLASSES = 15; // 16 bytes a 256 KB
+
+class ArenaResource : public std::pmr::memory_resource
+{
+public:
+    explicit ArenaResource(size_t firstBlockBytes = ARENA_FIRST_BLOCK_BYTES,
+                           std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+        : nextBlockBytes(std::max<size_t>(firstBlockBytes, 4096)), upstream(upstream)
+    {
+    }
+
+    ~ArenaResource() override { release(); }
+
+    ArenaResource(const ArenaResource &) = delete;
+    ArenaResource &operator=(const ArenaResource &) = delete;
+
+    // Devolve tudo ao sistema, inclusive os pedidos grandes ainda não
+    // liberados (os contêineres da arena ficam inválidos)
+    void release()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (blocks)
+        {
+            Block *prev = blocks->prev;
+            upstream->deallocate(blocks, blocks->size, alignof(std::max_align_t));
+            blocks = prev;
+        }
+        while (large.next != &large)
+            freeLarge(large.next);
+        std::fill(freeLists, freeLists + ARENA_SIZE_CLASSES, nullptr);
+        cursor = limit = 0;
+    }
+
+    // Contador de alocações: pedidos feitos ao sistema (blocos e pedidos
+    // grandes, as alocações de verdade) e pedidos atendidos pela arena
+    size_t heapAllocationCount() const { return blocksAllocated + largeAllocated; }
+    size_t allocationCount() const { return allocations; }
+    // Bytes nos blocos da arena e maior soma de pedidos grandes vivos
+    size_t reservedBytes() const { return bytesReserved; }
+    size_t peakLargeBytes() const { return largePeak; }
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        allocations++;
+        if (bytes >= ARENA_LARGE_BYTES || alignment > alignof(std::max_align_t))
+            return allocateLarge(bytes, alignment);
+        int sizeClass = arenaSizeClass(bytes);
+        if (FreeNode *node = freeLists[sizeClass])
+        {
+            freeLists[sizeClass] = node->next;
+            return node;
+        }
+        bytes = ARENA_MIN_BYTES << sizeClass;
+        alignment = alignof(std::max_align_t);
+        uintptr_t p = (cursor + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        if (!blocks || p + bytes > limit)
+        {
+            size_t size = std::max(nextBlockBytes, sizeof(Block) + bytes + alignment);
+            Block *block = (Block *)upstream->allocate(size, alignof(std::max_align_t));
+            block->prev = blocks;
+            block->size = size;
+            blocks = block;
+            blocksAllocated++;
+            bytesReserved += size;
+            nextBlockBytes = std::min(nextBlockBytes * 2, ARENA_MAX_BLOCK_BYTES);
+            cursor = (uintptr_t)(block + 1);
+            limit = (uintptr_t)block + size;
+            p = (cursor + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        }
+        cursor = p + bytes;
+        return (void *)p;
+    }
+
+    // Pedidos pequenos vão para a lista de livres do seu tamanho; pedidos
+    // grandes voltam ao sistema
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (bytes >= ARENA_LARGE_BYTES || alignment > alignof(std::max_align_t))
+            freeLarge((Large *)((uint8_t *)p - largeHeaderBytes(alignment)));
+        else
+        {
+            int sizeClass = arenaSizeClass(bytes);
+            FreeNode *node = (FreeNode *)p;
+            node->next = freeLists[sizeClass];
+            freeLists[sizeClass] = node;
+        }
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+private:
+    struct alignas(std::max_align_t) Block
+    {
+        Block *prev;
+        size_t size;
+    };
+
+    struct FreeNode
+    {
+        FreeNode *next;
+    };
+
+    // Menor k com ARENA_MIN_BYTES << k >= bytes
+    static int arenaSizeClass(size_t bytes)
+    {
+        int k = 0;
+        while ((ARENA_MIN_BYTES << k) < bytes)
+            k++;
+        return k;
+    }
+
+    // Cabeçalho de um pedido grande, em uma lista duplamente ligada circular
+    struct alignas(std::max_align_t) Large
+    {
+        Large *prev, *next;
+        size_t size, alignment;
+    };
+
+    // O cabeçalho ocupa um múltiplo do alinhamento, para o dado ficar alinhado
+    static size_t largeHeaderBytes(size_t alignment) { return std::max(sizeof(Large), alignment); }
+
+    void *allocateLarge(size_t bytes, size_t alignment)
+    {
+        size_t header = largeHeaderBytes(alignment);
+        alignment = std::max(alignment, alignof(Large));
+        Large *node = (Large *)upstream->allocate(header + bytes, alignment);
+        node->size = header + bytes;
+        node->alignment = alignment;
+        node->prev = &large;
+        node->next = large.next;
+        large.next->prev = node;
+        large.next = node;
+        largeAllocated++;
+        largeBytes += bytes;
+        largePeak = std::max(largePeak, largeBytes);
+        return (uint8_t *)node + header;
+    }
+
+    void freeLarge(Large *node)
+    {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        largeBytes -= node->size - largeHeaderBytes(node->alignment);
+        upstream->deallocate(node, node->size, node->alignment);
+    }
+
+    std::mutex mutex;
+    Block *blocks = nullptr;
+    uintptr_t cursor = 0, limit = 0;
+    size_t nextBlockBytes;
+    FreeNode *freeLists[ARENA_SIZE_CLASSES] = {};
+    Large large{&large, &large, 0, 0}; // sentinela da lista de pedidos grandes
+    size_t blocksAllocated = 0, largeAllocated = 0, allocations = 0;
+    size_t bytesReserved = 0, largeBytes = 0, largePeak = 0;
+    std::pmr::memory_resource *upstream;
+};
+
+// Recurso dos contêineres temporários criados na thread atual
+inline std::pmr::memory_resource *&currentScratchResource()
+{
+    thread_local std::pmr::memory_resource *resource = nullptr;
+    return resource;
+}
+
+inline std::pmr::memory_resource *scratchResource()
+{
+    std::pmr::memory_resource *resource = currentScratchResource();
+    return resource ? resource : std::pmr::new_delete_resource();
+}
+
+// Enquanto existir, os contêineres temporários criados nesta thread usam `resource`
+class ScratchScope
+{
+public:
+    explicit ScratchScope(std::pmr::memory_resource *resource) : previous(currentScratchResource())
+    {
+        currentScratchResource() = resource;
+    }
+    ~ScratchScope() { currentScratchResource() = previous; }
+
+    ScratchScope(const ScratchScope &) = delete;
+    ScratchScope &operator=(const ScratchScope &) = delete;
+
+private:
+    std::pmr::memory_resource *previous;
+};
+
+// polymorphic_allocator cujo recurso padrão é o do ScratchScope ativo (e não
+// o std::pmr::get_default_resource global, que valeria para todas as threads)
+template <typename T>
+class ScratchAllocator : public std::pmr::polymorphic_allocator<T>
+{
+public:
+    template <typename U>
+    struct rebind
+    {
+        using other = ScratchAllocator<U>;
+    };
+
+    ScratchAllocator() noexcept : std::pmr::polymorphic_allocator<T>(scratchResource()) {}
+    ScratchAllocator(std::pmr::memory_resource *resource) noexcept : std::pmr::polymorphic_allocator<T>(resource) {}
+    ScratchAllocator(const ScratchAllocator &other) noexcept = default;
+    template <typename U>
+    ScratchAllocator(const ScratchAllocator<U> &other) noexcept : std::pmr::polymorphic_allocator<T>(other.resource()) {}
+
+    // Uma cópia de contêiner usa o recurso de quem copia, como no std::pmr
+    ScratchAllocator select_on_container_copy_construction() const { return ScratchAllocator(); }
+};
+
+template <typename T>
+using ScratchVector = std::vector<T, ScratchAllocator<T>>;
+
+template <typename K, typename V, typename Hash = std::hash<K>, typename Equal = std::equal_to<K>>
+using ScratchHashMap = std::unordered_map<K, V, Hash, Equal, ScratchAllocator<std::pair<const K, V>>>;
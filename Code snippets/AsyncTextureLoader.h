@@ -0,0 +1,574 @@
+/*
+ *  AsyncTextureLoader - texturas decodificadas em threads de trabalho e
+ *  enviadas à GPU por pixel buffer objects (PBOs)
+ *
+ *  Com o TextureManager, `stbi_load`, os mipmaps e a cópia para a OpenGL
+ *  rodam na thread de desenho: uma imagem grande (como o SuzanneUV.png)
+ *  para a janela por vários quadros. Aqui o trabalho é dividido assim:
+ *
+ *  1. `request` (thread da OpenGL) devolve na hora o TextureHandle, com um
+ *     texel branco até a imagem chegar, e põe o arquivo na fila das threads;
+ *  2. uma thread de trabalho lê só o cabeçalho da imagem (stbi_info), ou
+ *     mapeia o .ktx2 pré-processado (KtxTexture.h), para saber o tamanho de
+ *     todos os níveis;
+ *  3. `update` (thread da OpenGL, a cada quadro) reserva esse espaço em um
+ *     anel de PBO mapeado de forma persistente e devolve a imagem às threads;
+ *  4. uma thread de trabalho decodifica a imagem direto no PBO: o nível 0 de
+ *     stbi_load (que só devolve memória própria, copiada uma vez) e os
+ *     mipmaps, gerados no lugar com TextureSampler::mipFilter
+ *     (MipGenerator.h). Os níveis do .ktx2 (BC1, BC3, BC7) vão como estão, ou
+ *     descomprimidos para RGBA8 se o driver não tiver o formato;
+ *  5. `update` reserva os níveis com glTexStorage2D, envia cada um com
+ *     glTexSubImage2D (ou glCompressedTexSubImage2D) a partir da região do
+ *     anel e põe uma fence (glFenceSync) nela: o driver copia da memória do
+ *     PBO sem passar pela thread de desenho, que não toca em nenhum pixel, e
+ *     a região só volta a ser usada depois que a GPU terminar de lê-la.
+ *
+ *  O anel (TEXTURE_STAGING_BYTES, com glBufferStorage: OpenGL 4.4 ou
+ *  ARB_buffer_storage) é mapeado uma única vez, na criação do carregador.
+ *  Sem glBufferStorage, e para uma imagem maior que o anel (que vai
+ *  sozinha), cada imagem usa um PBO mapeado só para ela, reaproveitado
+ *  entre as texturas. Cada `update` envia texturas até esgotar o orçamento
+ *  de tempo do quadro, e pelo menos uma por chamada, para sempre avançar.
+ *
+ *  As texturas pedidas entram no TextureManager: um pedido de um arquivo que
+ *  já está carregado (ou em carregamento) recebe a mesma textura. Uma imagem
+ *  que não pode ser lida continua como o texel branco.
+ *
+ *  Destruir o carregador antes de glfwTerminate; as texturas ainda não
+ *  enviadas ficam com o texel branco.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  AsyncTextureLoader textures;
+ *  TextureHandle uv = textures.request("../assets/Modelos3D/SuzanneUV.png");
+ *  ...
+ *  while (!glfwWindowShouldClose(window))
+ *  {
+ *      textures.update(2.0); // até 2 ms de envio por quadro
+ *      bindTexture(*uv); // branca enquanto uv->loading
+ *      ...
+ *  }
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// GLAD
+#include <glad/glad.h>
+
+// STB_IMAGE (a implementação, STB_IMAGE_IMPLEMENTATION, fica no programa)
+#include <stb_image.h>
+
+#include "BlockCompression.h"
+#include "KtxTexture.h"
+#include "MipGenerator.h"
+#include "MpscQueue.h"
+#include "ParallelFor.h"
+#include "TextureManager.h"
+
+// Bytes de PBOs mapeados ao mesmo tempo (o tamanho do anel)
+const size_t TEXTURE_STAGING_BYTES = 64u << 20;
+
+// Alinhamento das regiões do anel
+const size_t TEXTURE_STAGING_ALIGNMENT = 256;
+
+// Bits de mapeamento persistente (OpenGL 4.4 ou ARB_buffer_storage), que a
+// GLAD 4.0 não traz
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+// glBufferStorage (OpenGL 4.4 ou ARB_buffer_storage), carregada na primeira
+// chamada; nullptr se o driver não a tiver
+typedef void(APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+
+inline BufferStorageProc bufferStorage()
+{
+    static const BufferStorageProc storage = []() -> BufferStorageProc
+    {
+        if (!hasGLVersion(4, 4) && !hasGLExtension("GL_ARB_buffer_storage"))
+            return nullptr;
+        return (BufferStorageProc)glfwGetProcAddress("glBufferStorage");
+    }();
+    return storage;
+}
+
+class AsyncTextureLoader
+{
+public:
+    // nThreads = 0 usa todos os núcleos menos um (o da thread de desenho)
+    explicit AsyncTextureLoader(unsigned nThreads = 0, TextureManager &manager = textureManager())
+        : manager(manager)
+    {
+        nThreads = nThreads == 0 ? std::max(resolveThreadCount(0), 2u) - 1 : nThreads;
+        // Consultado aqui, na thread da OpenGL: as threads de trabalho só leem
+        for (int srgb = 0; srgb < 2; srgb++)
+            for (TextureFormat format : {TextureFormat::BC1, TextureFormat::BC3, TextureFormat::BC7})
+                compressedSupported[srgb][(int)format] = textureFormatSupported(format, srgb != 0);
+        createRing();
+        for (unsigned i = 0; i < nThreads; i++)
+            workers.emplace_back([this]() { work(); });
+    }
+
+    ~AsyncTextureLoader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &w : workers)
+            w.join();
+        // Apagar um PBO mapeado também o desmapeia
+        for (const Pbo &pbo : pbos)
+            glDeleteBuffers(1, &pbo.id);
+        for (const RingRegion &region : ringRegions)
+            if (region.fence)
+                glDeleteSync(region.fence);
+        if (ring)
+            glDeleteBuffers(1, &ring);
+    }
+
+    AsyncTextureLoader(const AsyncTextureLoader &) = delete;
+    AsyncTextureLoader &operator=(const AsyncTextureLoader &) = delete;
+
+    // Textura do arquivo, compartilhada pelo TextureManager. Uma textura nova
+    // começa como um texel branco (loading = true) até ser enviada por update.
+    TextureHandle request(const std::string &filePath, const TextureSampler &sampler = TextureSampler())
+    {
+        return manager.acquire(filePath, sampler, [&](const std::string &canonicalPath)
+        {
+            std::shared_ptr<Texture> texture = createBoundTexture(canonicalPath, sampler);
+            setWhiteTexel(*texture);
+            glBindTexture(GL_TEXTURE_2D, 0);
+            if (filePath.empty())
+                return texture;
+
+            texture->loading = true;
+            std::unique_ptr<Job> job(new Job());
+            job->texture = texture;
+            job->path = filePath;
+            job->mipmaps = sampler.usesMipmaps();
+            job->srgb = sampler.srgb;
+            job->mipFilter = sampler.mipFilter;
+            inFlight++;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.push_back(std::move(job));
+            }
+            wake.notify_one();
+            return texture;
+        });
+    }
+
+    // Reserva memória mapeada para as imagens com o cabeçalho já lido e envia
+    // as que já foram decodificadas, por até `budgetMs` milissegundos (pelo menos uma textura por
+    // chamada). Retorna quantas texturas ficaram prontas nesta chamada.
+    size_t update(double budgetMs)
+    {
+        auto start = std::chrono::steady_clock::now();
+        size_t completed = 0;
+        for (;;)
+        {
+            // Reservar é barato: todas as imagens que couberem recebem espaço
+            while (!waiting.empty() && mapStaging(*waiting.front()))
+            {
+                std::unique_ptr<Job> mapped = std::move(waiting.front());
+                waiting.pop_front();
+                if (!mapped->ok)
+                {
+                    finish(*mapped);
+                    continue;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    tasks.push_back(std::move(mapped));
+                }
+                wake.notify_one();
+            }
+
+            std::unique_ptr<Job> job;
+            if (!finished.pop(job))
+                break;
+            if (!job->mapped && !job->ok)
+                finish(*job);
+            else if (!job->mapped)
+                waiting.push_back(std::move(job)); // cabeçalho lido: falta o PBO
+            else
+            {
+                upload(*job);
+                completed++;
+                if (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() >= budgetMs)
+                    break;
+            }
+        }
+        return completed;
+    }
+
+    // Texturas pedidas e ainda não enviadas
+    size_t pending() const { return inFlight; }
+
+private:
+    struct Job
+    {
+        std::shared_ptr<Texture> texture;
+        std::string path;
+        bool mipmaps = false;
+        bool srgb = false; // níveis em sRGB na GPU (pedido no amostrador; no .ktx2, também o do arquivo)
+        MipFilter mipFilter = MipFilter::Box;
+        bool ok = false;
+        int channels = 0;               // da imagem original (a decodificada é RGBA)
+        unsigned char *image = nullptr; // nível 0, de stbi_load
+        std::unique_ptr<KtxTextureView> cooked; // no lugar de image, se houver .ktx2
+        TextureFormat format = TextureFormat::RGBA8; // dos níveis no PBO
+        std::vector<MipLevel> levels;   // deslocamentos a partir de `offset`
+        size_t bytes = 0;               // todos os níveis
+        bool inRing = false;            // região do anel ou PBO próprio
+        size_t offset = 0;              // início no PBO (no anel, o da região)
+        size_t pbo = 0;                 // índice em `pbos`, fora do anel
+        void *mapped = nullptr;
+
+        Job() = default;
+        Job(const Job &) = delete;
+        Job &operator=(const Job &) = delete;
+        ~Job()
+        {
+            stbi_image_free(image);
+            texture->loading = false; // não enviada: fica o texel branco
+        }
+    };
+
+    struct Pbo
+    {
+        GLuint id;
+        size_t capacity;
+        bool inUse;
+    };
+
+    // Trecho do anel reservado para uma imagem
+    struct RingRegion
+    {
+        size_t offset;
+        size_t bytes;
+        bool released; // enviada (ou que desistiu do envio)
+        GLsync fence;  // depois do envio; a região volta ao anel quando sinalizada
+    };
+
+    // Thread de trabalho: lê o cabeçalho das imagens novas e decodifica as
+    // que já têm memória mapeada
+    void work()
+    {
+        for (;;)
+        {
+            std::unique_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                if (stopping)
+                    return;
+                job = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            if (!job->mapped)
+                readHeader(*job);
+            else
+                decode(*job);
+            finished.push(std::move(job));
+        }
+    }
+
+    // Só o tamanho dos níveis, que decide o espaço a reservar no PBO
+    void readHeader(Job &job)
+    {
+        std::unique_ptr<KtxTextureView> cooked(new KtxTextureView());
+        if (openCookedTexture(job.path, *cooked))
+        {
+            job.srgb = job.srgb && cooked->srgb;
+            if (compressedSupported[job.srgb][(int)cooked->format])
+                job.format = cooked->format;
+            // Os deslocamentos de mipLevels são os do RGBA8; no formato
+            // comprimido, os níveis ficam um depois do outro
+            job.levels = mipLevels(cooked->width, cooked->height, job.mipmaps);
+            job.levels.resize(std::min(job.levels.size(), cooked->levels.size()));
+            for (size_t l = 1; l < job.levels.size(); l++)
+                job.levels[l].offset = job.levels[l - 1].offset + levelBytes(job, l - 1);
+            job.channels = cooked->format == TextureFormat::BC1 ? 3 : 4;
+            job.cooked = std::move(cooked);
+        }
+        else
+        {
+            int width, height;
+            if (!stbi_info(job.path.c_str(), &width, &height, &job.channels))
+            {
+                std::cout << "Failed to load texture: " << job.path << std::endl;
+                return;
+            }
+            job.levels = mipLevels(width, height, job.mipmaps);
+        }
+        job.bytes = job.levels.back().offset + levelBytes(job, job.levels.size() - 1);
+        job.ok = true;
+    }
+
+    static size_t levelBytes(const Job &job, size_t l)
+    {
+        return textureLevelBytes(job.levels[l].width, job.levels[l].height, job.format);
+    }
+
+    // Decodifica a imagem direto na memória mapeada
+    void decode(Job &job)
+    {
+        uint8_t *mapped = (uint8_t *)job.mapped;
+        if (job.cooked)
+        {
+            for (size_t l = 0; l < job.levels.size(); l++)
+            {
+                const KtxLevel &level = job.cooked->levels[l];
+                if (job.format == job.cooked->format)
+                    std::memcpy(mapped + job.levels[l].offset, level.data, level.size);
+                else
+                    decompressImage(level.data, level.width, level.height, job.cooked->format, mapped + job.levels[l].offset);
+            }
+            job.cooked.reset();
+            return;
+        }
+        int width, height, channels;
+        job.image = stbi_load(job.path.c_str(), &width, &height, &channels, 4);
+        if (!job.image || width != job.levels[0].width || height != job.levels[0].height)
+        {
+            // O arquivo não pode ser lido (ou mudou depois do cabeçalho)
+            std::cout << "Failed to load texture: " << job.path << std::endl;
+            job.ok = false;
+            return;
+        }
+        // stbi_load não decodifica em um buffer dado: o nível 0 é copiado uma
+        // vez. Os mipmaps são gerados no PBO, cada um a partir do anterior.
+        std::memcpy(mapped, job.image, mipLevelBytes(job.levels[0]));
+        if (job.levels.size() > 1)
+            // Uma thread por imagem: as outras threads de trabalho cuidam das outras
+            generateMipChain(job.image, mapped + job.levels[1].offset, job.levels, job.srgb, job.mipFilter, 4, 1);
+        stbi_image_free(job.image);
+        job.image = nullptr;
+    }
+
+    // Cria o anel e o mapeia para sempre (leitura também: os mipmaps são
+    // gerados a partir do nível anterior, já no PBO). Sem glBufferStorage,
+    // fica ring = 0 e cada imagem usa um PBO próprio.
+    void createRing()
+    {
+        BufferStorageProc storage = bufferStorage();
+        if (!storage)
+            return;
+        const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &ring);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring);
+        storage(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)TEXTURE_STAGING_BYTES, nullptr, flags);
+        ringMemory = (uint8_t *)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)TEXTURE_STAGING_BYTES, flags);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        if (!ringMemory)
+        {
+            std::cerr << "Aviso: nao foi possivel mapear o anel de PBO; as texturas usam um PBO cada" << std::endl;
+            glDeleteBuffers(1, &ring);
+            ring = 0;
+        }
+    }
+
+    // Devolve ao anel, a partir da mais antiga, as regiões que a GPU já leu
+    void retireRegions()
+    {
+        while (!ringRegions.empty() && ringRegions.front().released)
+        {
+            RingRegion &region = ringRegions.front();
+            if (region.fence)
+            {
+                if (glClientWaitSync(region.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+                    break;
+                glDeleteSync(region.fence);
+            }
+            ringRegions.pop_front();
+        }
+    }
+
+    // Reserva uma região do anel para a imagem: depois da mais nova ou, dando
+    // a volta, antes da mais antiga ainda em uso
+    bool reserveRegion(Job &job)
+    {
+        retireRegions();
+        size_t bytes = (job.bytes + TEXTURE_STAGING_ALIGNMENT - 1) / TEXTURE_STAGING_ALIGNMENT * TEXTURE_STAGING_ALIGNMENT;
+        size_t offset;
+        if (ringRegions.empty())
+            offset = ringHead = 0;
+        else
+        {
+            size_t tail = ringRegions.front().offset;
+            if (ringHead > tail && ringHead + bytes <= TEXTURE_STAGING_BYTES)
+                offset = ringHead;
+            else if (ringHead > tail && bytes <= tail)
+                offset = 0;
+            else if (ringHead <= tail && ringHead + bytes <= tail)
+                offset = ringHead;
+            else
+                return false;
+        }
+        RingRegion region = {offset, bytes, false, nullptr};
+        ringRegions.push_back(region);
+        ringHead = offset + bytes;
+        job.inRing = true;
+        job.offset = offset;
+        job.mapped = ringMemory + offset;
+        return true;
+    }
+
+    // A região da imagem volta ao anel quando a GPU terminar os envios já
+    // feitos a partir dela (`sent`) ou na hora, se não houve envio
+    void releaseRegion(size_t offset, bool sent)
+    {
+        for (RingRegion &region : ringRegions)
+            if (region.offset == offset && !region.released)
+            {
+                region.fence = sent ? glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) : nullptr;
+                region.released = true;
+                return;
+            }
+    }
+
+    // Reserva memória mapeada para a imagem: uma região do anel ou, sem ele
+    // (ou para uma imagem maior que ele), um PBO mapeado só para ela. Retorna
+    // false se não houver espaço agora (a imagem espera o próximo quadro).
+    bool mapStaging(Job &job)
+    {
+        if (ring && job.bytes <= TEXTURE_STAGING_BYTES)
+            return reserveRegion(job);
+        if (stagingBytes > 0 && stagingBytes + job.bytes > TEXTURE_STAGING_BYTES)
+            return false;
+
+        // O menor PBO livre que comporte a imagem; senão, um livre qualquer
+        // (que cresce) ou um novo
+        size_t best = pbos.size();
+        for (size_t i = 0; i < pbos.size(); i++)
+            if (!pbos[i].inUse && (best == pbos.size() ||
+                                   (pbos[i].capacity >= job.bytes && (pbos[best].capacity < job.bytes || pbos[i].capacity < pbos[best].capacity))))
+                best = i;
+        if (best == pbos.size())
+        {
+            Pbo pbo = {0, 0, false};
+            glGenBuffers(1, &pbo.id);
+            pbos.push_back(pbo);
+        }
+        Pbo &pbo = pbos[best];
+
+        // Memória nova para o PBO (glBufferData), sem esperar o fim do envio
+        // anterior dele; mapeado para leitura também, como o anel
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo.id);
+        pbo.capacity = std::max(pbo.capacity, job.bytes);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, pbo.capacity, nullptr, GL_STREAM_DRAW);
+        job.mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, job.bytes, GL_MAP_READ_BIT | GL_MAP_WRITE_BIT);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        if (!job.mapped)
+        {
+            // A imagem desiste do envio e fica com o texel branco
+            std::cerr << "Erro ao mapear o PBO da textura " << job.path << std::endl;
+            job.ok = false;
+            return true;
+        }
+        pbo.inUse = true;
+        job.pbo = best;
+        stagingBytes += job.bytes;
+        return true;
+    }
+
+    // Cria os níveis da textura a partir do PBO
+    void upload(Job &job)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, job.inRing ? ring : pbos[job.pbo].id);
+        // O anel fica mapeado; um PBO próprio é desmapeado antes do envio
+        if (!job.inRing && glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) != GL_TRUE && job.ok)
+        {
+            std::cerr << "Erro: o conteudo do PBO da textura " << job.path << " foi perdido" << std::endl;
+            job.ok = false;
+        }
+        // Se ninguém mais usa a textura, não há o que enviar
+        bool sent = job.ok && job.texture.use_count() > 1;
+        if (sent)
+        {
+            Texture &texture = *job.texture;
+            TexelFormat rgba = texelFormat(4, job.srgb);
+            GLenum internalFormat = textureFormatGLEnum(job.format, job.srgb);
+            glBindTexture(GL_TEXTURE_2D, texture.id);
+            bool immutable = allocateTextureStorage((GLsizei)job.levels.size(), internalFormat, job.levels[0].width,
+                                                    job.levels[0].height);
+            for (size_t l = 0; l < job.levels.size(); l++)
+            {
+                const MipLevel &level = job.levels[l];
+                if (job.format == TextureFormat::RGBA8)
+                    uploadTextureLevel(immutable, (GLint)l, rgba, level.width, level.height,
+                                       (GLvoid *)(job.offset + level.offset));
+                else
+                    uploadCompressedLevel(immutable, (GLint)l, internalFormat, level.width, level.height,
+                                          levelBytes(job, l), (GLvoid *)(job.offset + level.offset));
+            }
+            texture.width = job.levels[0].width;
+            texture.height = job.levels[0].height;
+            texture.channels = job.channels;
+            texture.levels = (int)job.levels.size();
+            texture.internalFormat = internalFormat;
+            texture.bytes = job.bytes;
+#ifndef NDEBUG
+            validateMipChain(texture);
+#endif
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        if (job.inRing)
+            releaseRegion(job.offset, sent);
+        else
+        {
+            pbos[job.pbo].inUse = false;
+            stagingBytes -= job.bytes;
+        }
+        finish(job);
+    }
+
+    void finish(Job &job)
+    {
+        if (!job.ok)
+            job.texture->path.clear();
+        job.texture->loading = false;
+        inFlight--;
+    }
+
+    TextureManager &manager;
+    bool compressedSupported[2][4] = {}; // por sRGB e TextureFormat
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::unique_ptr<Job>> tasks; // protegidos por `mutex`: cabeçalho a ler ou imagem a decodificar
+    bool stopping = false;
+    MpscQueue<std::unique_ptr<Job>> finished; // das threads de trabalho para update
+
+    // Só na thread da OpenGL
+    std::deque<std::unique_ptr<Job>> waiting; // com o cabeçalho lido, esperando um PBO
+    GLuint ring = 0;                 // anel mapeado de forma persistente (0 sem glBufferStorage)
+    uint8_t *ringMemory = nullptr;
+    std::deque<RingRegion> ringRegions; // em ordem de reserva
+    size_t ringHead = 0;             // fim da região mais nova
+    std::vector<Pbo> pbos;           // PBOs próprios, fora do anel
+    size_t stagingBytes = 0;         // mapeados nos PBOs próprios
+    size_t inFlight = 0;
+};
@@ -0,0 +1,106 @@
+/*
+ *  AtlasInstances - vários objetos com imagens diferentes do TextureAtlas em
+ *  chamadas de desenho instanciadas
+ *
+ *  Cada instância tem as suas transformações e a região dela no atlas.
+ *  `drawAtlasInstances` envia, para até ATLAS_MAX_INSTANCES instâncias de
+ *  cada vez, as matrizes de modelo e as regiões nos vetores de uniforms
+ *  `models`, `uvRects` e `layers`, e desenha todas com um
+ *  glDrawArraysInstanced; mais instâncias vão em outras chamadas. O vertex
+ *  shader declara esses vetores com ATLAS_INSTANCE_UNIFORMS, que leva o
+ *  tamanho de ATLAS_MAX_INSTANCES para o código GLSL:
+ *
+ *      const GLchar *vertexShaderSource = R"(
+ *      #version 400
+ *      ...
+ *      )" ATLAS_INSTANCE_UNIFORMS R"(
+ *      void main()
+ *      {
+ *          gl_Position = projection * models[gl_InstanceID] * vec4(position, 1.0);
+ *          texCoord = uvRects[gl_InstanceID].xy + texc * uvRects[gl_InstanceID].zw;
+ *          layer = layers[gl_InstanceID];
+ *      })";
+ *
+ *  Forma de uso
+ *  -----------------
+ *  std::vector<AtlasInstance> objects = {
+ *      {glm::vec3(-0.5, 0.0, 0.0), glm::vec3(0.5), 0.0, wallRegion},
+ *      {glm::vec3(0.5, 0.0, 0.0), glm::vec3(0.5), 0.0, uvRegion}};
+ *  ...
+ *  glBindVertexArray(VAO);
+ *  drawAtlasInstances(shaderID, atlas, objects, nVertices);
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+// GLAD
+#include <glad/glad.h>
+
+// GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "TextureAtlas.h"
+
+// Instâncias por chamada de desenho: tamanho dos vetores de uniforms do
+// vertex shader. É uma macro para entrar também no código GLSL.
+#define ATLAS_MAX_INSTANCES 16
+
+#define ATLAS_STRINGIFY_VALUE(x) #x
+#define ATLAS_STRINGIFY(x) ATLAS_STRINGIFY_VALUE(x)
+
+// Declarações GLSL dos vetores de uniforms de drawAtlasInstances: um
+// elemento por instância, a matriz de modelo e a região no atlas
+#define ATLAS_INSTANCE_UNIFORMS                                            \
+    "uniform mat4 models[" ATLAS_STRINGIFY(ATLAS_MAX_INSTANCES) "];\n"     \
+    "uniform vec4 uvRects[" ATLAS_STRINGIFY(ATLAS_MAX_INSTANCES) "];\n"    \
+    "uniform int layers[" ATLAS_STRINGIFY(ATLAS_MAX_INSTANCES) "];\n"
+
+// Um objeto da cena: transformações e a imagem dele no atlas
+struct AtlasInstance
+{
+    glm::vec3 position;
+    glm::vec3 dimensions;
+    float angle;  // em graus, em torno de `axis`
+    int region;   // índice da região em TextureAtlas
+    glm::vec3 axis = glm::vec3(0.0f, 0.0f, 1.0f);
+};
+
+// Desenha as instâncias (com o programa e o VAO de `nVertices` vértices já
+// vinculados), ATLAS_MAX_INSTANCES por chamada de desenho. Instance tem os
+// mesmos campos de AtlasInstance.
+template <typename Instance>
+inline void drawAtlasInstances(GLuint shaderID, const TextureAtlas &atlas, const std::vector<Instance> &instances,
+                               GLsizei nVertices)
+{
+    glm::mat4 models[ATLAS_MAX_INSTANCES];
+    glm::vec4 uvRects[ATLAS_MAX_INSTANCES];
+    GLint layers[ATLAS_MAX_INSTANCES];
+    GLint modelsLoc = glGetUniformLocation(shaderID, "models");
+    GLint uvRectsLoc = glGetUniformLocation(shaderID, "uvRects");
+    GLint layersLoc = glGetUniformLocation(shaderID, "layers");
+    for (size_t first = 0; first < instances.size(); first += ATLAS_MAX_INSTANCES)
+    {
+        GLsizei count = (GLsizei)std::min(instances.size() - first, (size_t)ATLAS_MAX_INSTANCES);
+        for (GLsizei i = 0; i < count; i++)
+        {
+            const Instance &instance = instances[first + i];
+            // Matriz de modelo: translação, rotação e escala
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), instance.position);
+            model = glm::rotate(model, glm::radians(instance.angle), instance.axis);
+            models[i] = glm::scale(model, instance.dimensions);
+
+            const AtlasRegion &region = atlas.region(instance.region);
+            uvRects[i] = region.uvRect;
+            layers[i] = region.layer;
+        }
+        glUniformMatrix4fv(modelsLoc, count, GL_FALSE, glm::value_ptr(models[0]));
+        glUniform4fv(uvRectsLoc, count, glm::value_ptr(uvRects[0]));
+        glUniform1iv(layersLoc, count, layers);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, nVertices, count);
+    }
+}
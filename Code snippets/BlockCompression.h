@@ -0,0 +1,652 @@
+/*
+ *  BlockCompression - compressão de texturas RGBA8 em blocos BC1, BC3 e BC7
+ *
+ *  Os formatos BC dividem a imagem em blocos de 4x4 texels. Cada bloco guarda
+ *  duas cores extremas e, para cada texel, o índice de um dos tons entre
+ *  elas; a GPU lê os blocos comprimidos direto da memória de vídeo:
+ *
+ *  BC1 (DXT1)  8 bytes por bloco (0,5 byte/texel, 8x menor que RGBA8): RGB,
+ *              extremos em 16 bits (5:6:5) e 4 tons
+ *  BC3 (DXT5)  16 bytes (1 byte/texel): um bloco de alfa (extremos de 8
+ *              bits e 8 tons) e um bloco BC1 com as cores
+ *  BC7         16 bytes (1 byte/texel): RGBA com extremos de 7 bits mais um
+ *              bit P e 16 tons. Só o modo 6 é gravado (uma única reta por
+ *              bloco): perde para os modos com partições em blocos com duas
+ *              cores bem diferentes, mas já é bem melhor que o BC3
+ *
+ *  Cada bloco é comprimido assim: os extremos iniciais são as pontas da reta
+ *  principal das cores (análise de componentes principais); cada texel
+ *  recebe o tom mais próximo; os extremos são reajustados por mínimos
+ *  quadrados aos índices escolhidos, e a busca se repete enquanto o erro
+ *  cair (até BLOCK_REFINE_STEPS vezes). A busca do tom mais próximo usa
+ *  SSE2 (4 texels por vez), quando disponível, e `compressImage` divide as
+ *  linhas de blocos entre as threads (ParallelFor.h).
+ *
+ *  `decompressImage` faz o caminho inverso: o TextureCooker mede a
+ *  qualidade (PSNR) com ele, e o TextureManager o usa em drivers sem os
+ *  formatos comprimidos. No BC7, só o modo 6 é lido (os outros modos dão
+ *  preto transparente). No BC1 e no BC3, os tons intermediários podem
+ *  diferir em 1 dos decodificados pela GPU (arredondamento).
+ *
+ *  Forma de uso
+ *  -----------------
+ *  std::vector<uint8_t> blocks(textureLevelBytes(width, height, TextureFormat::BC7));
+ *  compressImage(pixels, width, height, TextureFormat::BC7, blocks.data());
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLOCK_COMPRESSION_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#include "ParallelFor.h"
+
+enum class TextureFormat
+{
+    RGBA8 = 0, // sem compressão
+    BC1 = 1,   // RGB, 8 bytes por bloco de 4x4
+    BC3 = 2,   // RGBA, 16 bytes por bloco
+    BC7 = 3    // RGBA, 16 bytes por bloco
+};
+
+// Reajustes dos extremos por mínimos quadrados em cada bloco
+const int BLOCK_REFINE_STEPS = 2;
+
+inline const char *textureFormatName(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::BC1:
+        return "BC1";
+    case TextureFormat::BC3:
+        return "BC3";
+    case TextureFormat::BC7:
+        return "BC7";
+    default:
+        return "RGBA8";
+    }
+}
+
+// Bytes de um nível (nos formatos BC, blocos inteiros, mesmo em 2x2 e 1x1)
+inline size_t textureLevelBytes(int width, int height, TextureFormat format)
+{
+    if (format == TextureFormat::RGBA8)
+        return (size_t)width * (size_t)height * 4;
+    size_t blocks = (size_t)((width + 3) / 4) * (size_t)((height + 3) / 4);
+    return blocks * (format == TextureFormat::BC1 ? 8 : 16);
+}
+
+// Texels de um bloco, canal a canal (R, G, B e A de 0 a 255)
+struct BlockTexels
+{
+    alignas(16) float c[4][16];
+};
+
+// Copia o bloco (bx, by) de uma imagem RGBA8. Nas bordas, a última
+// linha/coluna é repetida para completar o bloco.
+inline void loadBlock(const uint8_t *rgba, int width, int height, int bx, int by, BlockTexels &texels)
+{
+    for (int y = 0; y < 4; y++)
+    {
+        const uint8_t *row = rgba + (size_t)std::min(by * 4 + y, height - 1) * width * 4;
+        for (int x = 0; x < 4; x++)
+        {
+            const uint8_t *p = row + (size_t)std::min(bx * 4 + x, width - 1) * 4;
+            for (int k = 0; k < 4; k++)
+                texels.c[k][y * 4 + x] = (float)p[k];
+        }
+    }
+}
+
+// Índice do tom mais próximo de cada texel, pela distância nos canais
+// [first, first + channels), e o erro quadrático do bloco
+inline float nearestTones(const BlockTexels &texels, int first, int channels, const float tones[][4], int count, uint8_t indices[16])
+{
+    float error = 0.0f;
+#ifdef BLOCK_COMPRESSION_SSE2
+    for (int i = 0; i < 16; i += 4)
+    {
+        __m128 best = _mm_set1_ps(FLT_MAX);
+        __m128i bestIndex = _mm_setzero_si128();
+        for (int t = 0; t < count; t++)
+        {
+            __m128 d = _mm_setzero_ps();
+            for (int k = first; k < first + channels; k++)
+            {
+                __m128 diff = _mm_sub_ps(_mm_load_ps(&texels.c[k][i]), _mm_set1_ps(tones[t][k]));
+                d = _mm_add_ps(d, _mm_mul_ps(diff, diff));
+            }
+            __m128i closer = _mm_castps_si128(_mm_cmplt_ps(d, best));
+            bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(t)), _mm_andnot_si128(closer, bestIndex));
+            best = _mm_min_ps(d, best);
+        }
+        alignas(16) float distances[4];
+        alignas(16) int32_t found[4];
+        _mm_store_ps(distances, best);
+        _mm_store_si128((__m128i *)found, bestIndex);
+        for (int j = 0; j < 4; j++)
+        {
+            indices[i + j] = (uint8_t)found[j];
+            error += distances[j];
+        }
+    }
+#else
+    for (int i = 0; i < 16; i++)
+    {
+        float best = FLT_MAX;
+        for (int t = 0; t < count; t++)
+        {
+            float d = 0.0f;
+            for (int k = first; k < first + channels; k++)
+            {
+                float diff = texels.c[k][i] - tones[t][k];
+                d += diff * diff;
+            }
+            if (d < best)
+            {
+                best = d;
+                indices[i] = (uint8_t)t;
+            }
+        }
+        error += best;
+    }
+#endif
+    return error;
+}
+
+// Extremos iniciais: as projeções extremas dos texels na reta principal
+// (autovetor da covariância, por iteração de potência)
+inline void principalEndpoints(const BlockTexels &texels, int first, int channels, float e0[4], float e1[4])
+{
+    float mean[4] = {}, low[4], high[4];
+    for (int k = first; k < first + channels; k++)
+    {
+        low[k] = high[k] = texels.c[k][0];
+        for (int i = 0; i < 16; i++)
+        {
+            mean[k] += texels.c[k][i];
+            low[k] = std::min(low[k], texels.c[k][i]);
+            high[k] = std::max(high[k], texels.c[k][i]);
+        }
+        mean[k] /= 16.0f;
+        e0[k] = e1[k] = mean[k];
+    }
+
+    float cov[4][4] = {};
+    for (int i = 0; i < 16; i++)
+        for (int a = first; a < first + channels; a++)
+            for (int b = first; b < first + channels; b++)
+                cov[a][b] += (texels.c[a][i] - mean[a]) * (texels.c[b][i] - mean[b]);
+
+    // Começa pela diagonal da caixa envolvente, com o sinal de cada canal
+    // dado pela covariância com o canal de maior variação
+    int widest = first;
+    for (int k = first; k < first + channels; k++)
+        if (cov[k][k] > cov[widest][widest])
+            widest = k;
+    if (cov[widest][widest] <= 0.0f)
+        return; // bloco de uma cor só
+    float axis[4] = {};
+    for (int k = first; k < first + channels; k++)
+        axis[k] = cov[widest][k] < 0.0f ? low[k] - high[k] : high[k] - low[k];
+    for (int iteration = 0; iteration < 8; iteration++)
+    {
+        float next[4] = {}, length = 0.0f;
+        for (int a = first; a < first + channels; a++)
+        {
+            for (int b = first; b < first + channels; b++)
+                next[a] += cov[a][b] * axis[b];
+            length += next[a] * next[a];
+        }
+        if (length <= 0.0f)
+            break;
+        length = 1.0f / std::sqrt(length);
+        for (int k = first; k < first + channels; k++)
+            axis[k] = next[k] * length;
+    }
+
+    float tMin = FLT_MAX, tMax = -FLT_MAX;
+    for (int i = 0; i < 16; i++)
+    {
+        float t = 0.0f;
+        for (int k = first; k < first + channels; k++)
+            t += (texels.c[k][i] - mean[k]) * axis[k];
+        tMin = std::min(tMin, t);
+        tMax = std::max(tMax, t);
+    }
+    for (int k = first; k < first + channels; k++)
+    {
+        e0[k] = std::min(std::max(mean[k] + tMin * axis[k], 0.0f), 255.0f);
+        e1[k] = std::min(std::max(mean[k] + tMax * axis[k], 0.0f), 255.0f);
+    }
+}
+
+// Extremos que minimizam o erro quadrático para os índices dados, com
+// `weights[i]` a fração do extremo 1 no tom i
+inline void leastSquaresEndpoints(const BlockTexels &texels, int first, int channels, const uint8_t indices[16],
+                                  const float *weights, float e0[4], float e1[4])
+{
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f, ax[4] = {}, bx[4] = {};
+    for (int i = 0; i < 16; i++)
+    {
+        float w = weights[indices[i]], a = 1.0f - w;
+        aa += a * a;
+        ab += a * w;
+        bb += w * w;
+        for (int k = first; k < first + channels; k++)
+        {
+            ax[k] += a * texels.c[k][i];
+            bx[k] += w * texels.c[k][i];
+        }
+    }
+    float det = aa * bb - ab * ab;
+    if (std::fabs(det) < 1e-4f)
+        return; // todos os texels no mesmo tom
+    for (int k = first; k < first + channels; k++)
+    {
+        e0[k] = std::min(std::max((bb * ax[k] - ab * bx[k]) / det, 0.0f), 255.0f);
+        e1[k] = std::min(std::max((aa * bx[k] - ab * ax[k]) / det, 0.0f), 255.0f);
+    }
+}
+
+// Ajusta os extremos de um modo de bloco (Bc1Colors, Bc4Alpha, Bc7Mode6) e
+// escolhe os índices. q0 e q1 saem já quantizados, nos valores de 0 a 255
+// que o decodificador reconstrói.
+template <typename Mode>
+inline void fitBlock(const BlockTexels &texels, float q0[4], float q1[4], uint8_t indices[16])
+{
+    float e0[4] = {}, e1[4] = {};
+    principalEndpoints(texels, Mode::first, Mode::channels, e0, e1);
+    float best = FLT_MAX;
+    for (int step = 0; step <= BLOCK_REFINE_STEPS; step++)
+    {
+        float c0[4], c1[4], tones[16][4];
+        uint8_t trial[16];
+        std::memcpy(c0, e0, sizeof(c0));
+        std::memcpy(c1, e1, sizeof(c1));
+        Mode::quantize(c0, c1);
+        Mode::tones(c0, c1, tones);
+        float error = nearestTones(texels, Mode::first, Mode::channels, tones, Mode::count, trial);
+        if (error >= best)
+            break;
+        best = error;
+        std::memcpy(q0, c0, sizeof(c0));
+        std::memcpy(q1, c1, sizeof(c1));
+        std::memcpy(indices, trial, 16);
+        if (error == 0.0f)
+            break;
+        leastSquaresEndpoints(texels, Mode::first, Mode::channels, trial, Mode::weights(), e0, e1);
+    }
+}
+
+inline uint16_t packColor565(const float c[4])
+{
+    int r = (int)(c[0] * 31.0f / 255.0f + 0.5f), g = (int)(c[1] * 63.0f / 255.0f + 0.5f), b = (int)(c[2] * 31.0f / 255.0f + 0.5f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+inline void unpackColor565(uint16_t color, int rgb[3])
+{
+    int r = color >> 11, g = (color >> 5) & 63, b = color & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+// Cores de um bloco BC1: extremos em 5:6:5 e os tons a 1/3 e 2/3
+struct Bc1Colors
+{
+    static const int first = 0, channels = 3, count = 4;
+
+    static const float *weights()
+    {
+        static const float w[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+        return w;
+    }
+
+    static void quantize(float e0[4], float e1[4])
+    {
+        int rgb[3];
+        unpackColor565(packColor565(e0), rgb);
+        for (int k = 0; k < 3; k++)
+            e0[k] = (float)rgb[k];
+        unpackColor565(packColor565(e1), rgb);
+        for (int k = 0; k < 3; k++)
+            e1[k] = (float)rgb[k];
+    }
+
+    static void tones(const float e0[4], const float e1[4], float tones[][4])
+    {
+        for (int t = 0; t < count; t++)
+            for (int k = 0; k < 3; k++)
+                tones[t][k] = std::floor(e0[k] + (e1[k] - e0[k]) * weights()[t] + 0.5f);
+    }
+};
+
+// Alfa de um bloco BC3 (o mesmo bloco do BC4): extremos de 8 bits e 6 tons
+// entre eles, a cada 1/7
+struct Bc4Alpha
+{
+    static const int first = 3, channels = 1, count = 8;
+
+    static const float *weights()
+    {
+        static const float w[8] = {0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f};
+        return w;
+    }
+
+    static void quantize(float e0[4], float e1[4])
+    {
+        e0[3] = std::floor(e0[3] + 0.5f);
+        e1[3] = std::floor(e1[3] + 0.5f);
+    }
+
+    static void tones(const float e0[4], const float e1[4], float tones[][4])
+    {
+        for (int t = 0; t < count; t++)
+            tones[t][3] = std::floor(e0[3] + (e1[3] - e0[3]) * weights()[t] + 0.5f);
+    }
+};
+
+const int BC7_WEIGHTS4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// Modo 6 do BC7: extremos RGBA de 7 bits mais um bit P (o bit menos
+// significativo dos 4 canais do extremo) e 16 tons
+struct Bc7Mode6
+{
+    static const int first = 0, channels = 4, count = 16;
+
+    static const float *weights()
+    {
+        static const float w[16] = {0.0f / 64, 4.0f / 64, 9.0f / 64, 13.0f / 64, 17.0f / 64, 21.0f / 64, 26.0f / 64, 30.0f / 64,
+                                    34.0f / 64, 38.0f / 64, 43.0f / 64, 47.0f / 64, 51.0f / 64, 55.0f / 64, 60.0f / 64, 64.0f / 64};
+        return w;
+    }
+
+    // O bit P que dá o menor erro nos 4 canais
+    static void quantizeEndpoint(float e[4])
+    {
+        float bestError = FLT_MAX, best[4] = {};
+        for (int p = 0; p < 2; p++)
+        {
+            float error = 0.0f, v[4];
+            for (int k = 0; k < 4; k++)
+            {
+                int c = std::min(std::max((int)std::floor((e[k] - (float)p) / 2.0f + 0.5f), 0), 127);
+                v[k] = (float)(c * 2 + p);
+                error += (v[k] - e[k]) * (v[k] - e[k]);
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                std::memcpy(best, v, sizeof(best));
+            }
+        }
+        std::memcpy(e, best, sizeof(best));
+    }
+
+    static void quantize(float e0[4], float e1[4])
+    {
+        quantizeEndpoint(e0);
+        quantizeEndpoint(e1);
+    }
+
+    static void tones(const float e0[4], const float e1[4], float tones[][4])
+    {
+        for (int t = 0; t < count; t++)
+            for (int k = 0; k < 4; k++)
+                tones[t][k] = (float)((((64 - BC7_WEIGHTS4[t]) * (int)e0[k] + BC7_WEIGHTS4[t] * (int)e1[k] + 32) >> 6));
+    }
+};
+
+// Escreve e lê campos de bits de um bloco, do bit menos significativo do
+// primeiro byte em diante
+struct BlockBits
+{
+    uint8_t *bytes;
+    int position = 0;
+
+    void put(uint32_t value, int count)
+    {
+        for (int i = 0; i < count; i++, position++)
+            if ((value >> i) & 1u)
+                bytes[position >> 3] |= (uint8_t)(1u << (position & 7));
+    }
+};
+
+struct BlockBitReader
+{
+    const uint8_t *bytes;
+    int position = 0;
+
+    uint32_t get(int count)
+    {
+        uint32_t value = 0;
+        for (int i = 0; i < count; i++, position++)
+            value |= (uint32_t)((bytes[position >> 3] >> (position & 7)) & 1u) << i;
+        return value;
+    }
+};
+
+inline void encodeBC1Block(const BlockTexels &texels, uint8_t out[8])
+{
+    float q0[4], q1[4];
+    uint8_t indices[16];
+    fitBlock<Bc1Colors>(texels, q0, q1, indices);
+    uint16_t c0 = packColor565(q0), c1 = packColor565(q1);
+    // c0 > c1 escolhe os 4 tons; trocar os extremos troca 0 <-> 1 e 2 <-> 3.
+    // Com c0 == c1, todos os texels usam o tom 0 (o tom 3 seria preto).
+    if (c0 < c1)
+    {
+        std::swap(c0, c1);
+        for (uint8_t &i : indices)
+            i ^= 1;
+    }
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; i++)
+        bits |= (uint32_t)(c0 == c1 ? 0 : indices[i]) << (2 * i);
+    out[0] = (uint8_t)c0;
+    out[1] = (uint8_t)(c0 >> 8);
+    out[2] = (uint8_t)c1;
+    out[3] = (uint8_t)(c1 >> 8);
+    for (int b = 0; b < 4; b++)
+        out[4 + b] = (uint8_t)(bits >> (8 * b));
+}
+
+inline void encodeBC4AlphaBlock(const BlockTexels &texels, uint8_t out[8])
+{
+    float q0[4], q1[4];
+    uint8_t indices[16];
+    fitBlock<Bc4Alpha>(texels, q0, q1, indices);
+    uint8_t a0 = (uint8_t)q0[3], a1 = (uint8_t)q1[3];
+    // a0 > a1 escolhe os 8 tons; trocar os extremos troca 0 <-> 1 e i <-> 9 - i
+    if (a0 < a1)
+    {
+        std::swap(a0, a1);
+        for (uint8_t &i : indices)
+            i = i < 2 ? (uint8_t)(i ^ 1) : (uint8_t)(9 - i);
+    }
+    uint64_t bits = 0;
+    for (int i = 0; i < 16; i++)
+        bits |= (uint64_t)(a0 == a1 ? 0 : indices[i]) << (3 * i);
+    out[0] = a0;
+    out[1] = a1;
+    for (int b = 0; b < 6; b++)
+        out[2 + b] = (uint8_t)(bits >> (8 * b));
+}
+
+inline void encodeBC3Block(const BlockTexels &texels, uint8_t out[16])
+{
+    encodeBC4AlphaBlock(texels, out);
+    encodeBC1Block(texels, out + 8);
+}
+
+inline void encodeBC7Block(const BlockTexels &texels, uint8_t out[16])
+{
+    float q0[4], q1[4];
+    uint8_t indices[16];
+    fitBlock<Bc7Mode6>(texels, q0, q1, indices);
+    uint8_t v0[4], v1[4];
+    for (int k = 0; k < 4; k++)
+    {
+        v0[k] = (uint8_t)q0[k];
+        v1[k] = (uint8_t)q1[k];
+    }
+    // O bit mais significativo do índice do texel 0 fica implícito (zero):
+    // se ele for 1, os extremos são trocados e os índices invertidos
+    if (indices[0] & 8)
+    {
+        std::swap(v0, v1);
+        for (uint8_t &i : indices)
+            i = (uint8_t)(15 - i);
+    }
+    std::memset(out, 0, 16);
+    BlockBits bits = {out};
+    bits.put(1u << 6, 7); // modo 6
+    for (int k = 0; k < 4; k++)
+    {
+        bits.put(v0[k] >> 1, 7);
+        bits.put(v1[k] >> 1, 7);
+    }
+    bits.put(v0[0] & 1u, 1);
+    bits.put(v1[0] & 1u, 1);
+    bits.put(indices[0], 3);
+    for (int i = 1; i < 16; i++)
+        bits.put(indices[i], 4);
+}
+
+// Comprime uma imagem RGBA8 em `out` (textureLevelBytes(width, height,
+// format) bytes), com as linhas de blocos divididas entre as threads
+inline void compressImage(const uint8_t *rgba, int width, int height, TextureFormat format, uint8_t *out, unsigned nThreads = 0)
+{
+    int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    size_t blockBytes = format == TextureFormat::BC1 ? 8 : 16;
+    parallelFor((size_t)blocksY, nThreads, [&](size_t begin, size_t end)
+    {
+        BlockTexels texels;
+        for (size_t by = begin; by < end; by++)
+            for (int bx = 0; bx < blocksX; bx++)
+            {
+                loadBlock(rgba, width, height, bx, (int)by, texels);
+                uint8_t *block = out + (by * blocksX + bx) * blockBytes;
+                if (format == TextureFormat::BC1)
+                    encodeBC1Block(texels, block);
+                else if (format == TextureFormat::BC3)
+                    encodeBC3Block(texels, block);
+                else
+                    encodeBC7Block(texels, block);
+            }
+    }, std::max<size_t>(1, 1024 / blocksX)); // pelo menos ~1024 blocos por thread
+}
+
+// Bloco BC1 em 16 texels RGBA8. `opaque` (bloco de cores do BC3) usa sempre
+// os 4 tons.
+inline void decodeBC1Block(const uint8_t *block, uint8_t rgba[64], bool opaque = false)
+{
+    uint16_t c0 = (uint16_t)(block[0] | (block[1] << 8)), c1 = (uint16_t)(block[2] | (block[3] << 8));
+    int e0[3], e1[3], tones[4][4];
+    unpackColor565(c0, e0);
+    unpackColor565(c1, e1);
+    for (int k = 0; k < 3; k++)
+    {
+        tones[0][k] = e0[k];
+        tones[1][k] = e1[k];
+        if (c0 > c1 || opaque)
+        {
+            tones[2][k] = (2 * e0[k] + e1[k] + 1) / 3;
+            tones[3][k] = (e0[k] + 2 * e1[k] + 1) / 3;
+        }
+        else
+        {
+            tones[2][k] = (e0[k] + e1[k] + 1) / 2;
+            tones[3][k] = 0;
+        }
+    }
+    tones[0][3] = tones[1][3] = tones[2][3] = 255;
+    tones[3][3] = c0 > c1 || opaque ? 255 : 0;
+    uint32_t bits = (uint32_t)block[4] | ((uint32_t)block[5] << 8) | ((uint32_t)block[6] << 16) | ((uint32_t)block[7] << 24);
+    for (int i = 0; i < 16; i++)
+        for (int k = 0; k < 4; k++)
+            rgba[i * 4 + k] = (uint8_t)tones[(bits >> (2 * i)) & 3][k];
+}
+
+// Bloco de alfa do BC3 no canal A de 16 texels
+inline void decodeBC4AlphaBlock(const uint8_t *block, uint8_t rgba[64])
+{
+    int a0 = block[0], a1 = block[1], tones[8] = {a0, a1};
+    for (int t = 2; t < 8; t++)
+    {
+        if (a0 > a1)
+            tones[t] = ((8 - t) * a0 + (t - 1) * a1 + 3) / 7;
+        else
+            tones[t] = t < 6 ? ((6 - t) * a0 + (t - 1) * a1 + 2) / 5 : (t == 6 ? 0 : 255);
+    }
+    uint64_t bits = 0;
+    for (int b = 0; b < 6; b++)
+        bits |= (uint64_t)block[2 + b] << (8 * b);
+    for (int i = 0; i < 16; i++)
+        rgba[i * 4 + 3] = (uint8_t)tones[(bits >> (3 * i)) & 7];
+}
+
+inline void decodeBC7Block(const uint8_t *block, uint8_t rgba[64])
+{
+    if ((block[0] & 0x7F) != 0x40)
+    {
+        std::memset(rgba, 0, 64); // modo diferente do 6
+        return;
+    }
+    BlockBitReader bits = {block};
+    bits.get(7);
+    int e[2][4];
+    for (int k = 0; k < 4; k++)
+    {
+        e[0][k] = (int)bits.get(7) << 1;
+        e[1][k] = (int)bits.get(7) << 1;
+    }
+    for (int side = 0; side < 2; side++)
+    {
+        int p = (int)bits.get(1);
+        for (int k = 0; k < 4; k++)
+            e[side][k] |= p;
+    }
+    for (int i = 0; i < 16; i++)
+    {
+        int w = BC7_WEIGHTS4[bits.get(i == 0 ? 3 : 4)];
+        for (int k = 0; k < 4; k++)
+            rgba[i * 4 + k] = (uint8_t)(((64 - w) * e[0][k] + w * e[1][k] + 32) >> 6);
+    }
+}
+
+// Descomprime um nível comprimido por compressImage em RGBA8
+inline void decompressImage(const uint8_t *blocks, int width, int height, TextureFormat format, uint8_t *rgba)
+{
+    int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    size_t blockBytes = format == TextureFormat::BC1 ? 8 : 16;
+    uint8_t texels[64];
+    for (int by = 0; by < blocksY; by++)
+        for (int bx = 0; bx < blocksX; bx++)
+        {
+            const uint8_t *block = blocks + ((size_t)by * blocksX + bx) * blockBytes;
+            if (format == TextureFormat::BC1)
+                decodeBC1Block(block, texels);
+            else if (format == TextureFormat::BC3)
+            {
+                decodeBC1Block(block + 8, texels, true);
+                decodeBC4AlphaBlock(block, texels);
+            }
+            else
+                decodeBC7Block(block, texels);
+            for (int y = 0; y < 4 && by * 4 + y < height; y++)
+                for (int x = 0; x < 4 && bx * 4 + x < width; x++)
+                    std::memcpy(rgba + ((size_t)(by * 4 + y) * width + bx * 4 + x) * 4, texels + (y * 4 + x) * 4, 4);
+        }
+}
@@ -0,0 +1,333 @@
+/*
+ *  KtxTexture - texturas pré-processadas (.ktx2), com todos os mipmaps prontos
+ *
+ *  O programa TextureCooker (src/TextureCooker.cpp) lê uma imagem com o
+ *  stb_image, gera a cadeia de mipmaps com média em espaço linear
+ *  (MipGenerator.h), comprime os níveis em blocos BC1, BC3 ou BC7
+ *  (BlockCompression.h) e grava tudo em um arquivo KTX 2.0
+ *  (https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html) ao lado da
+ *  imagem: pixelWall.png -> pixelWall.ktx2. Na carga, o TextureManager mapeia
+ *  o .ktx2 em memória e envia cada nível direto dos bytes do arquivo
+ *  (glCompressedTexImage2D nos formatos BC), sem descompactar o PNG nem
+ *  chamar glGenerateMipmap.
+ *
+ *  Só o subconjunto do KTX 2.0 que o cozinheiro grava é lido: uma textura 2D
+ *  RGBA8 (VK_FORMAT_R8G8B8A8_SRGB ou _UNORM), BC1 sem alfa, BC3 ou BC7,
+ *  sem camadas, faces nem supercompressão. Qualquer outro .ktx2 é recusado,
+ *  e a imagem original é lida normalmente.
+ *
+ *  Layout do arquivo (little-endian)
+ *  -----------------
+ *  Ktx2Header                      identificador, formato, dimensões e índices
+ *  Ktx2LevelIndex[levelCount]      posição e tamanho de cada nível (nível 0 primeiro)
+ *  descritor de formato (DFD)      bloco básico do Khronos Data Format: modelo
+ *                                  RGBSDA ou BC1A/BC3/BC7, função de
+ *                                  transferência sRGB ou linear
+ *  chave/valor (KVD)               KTXwriter
+ *  níveis                          do menor (1x1) ao maior, alinhados em 4 bytes
+ *                                  (8 no BC1 e 16 no BC3 e BC7: um bloco)
+ *
+ *  Os níveis são guardados com a primeira linha em cima (a ordem do
+ *  stb_image), como as imagens que os exemplos enviam hoje.
+ *
+ *  Um .ktx2 mais antigo que a imagem de origem é ignorado: basta rodar o
+ *  TextureCooker de novo depois de editar a imagem.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "BlockCompression.h"
+#include "MappedFile.h"
+#include "MipGenerator.h"
+
+const uint8_t KTX2_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+// Formatos Vulkan usados no campo vkFormat
+const uint32_t KTX2_VK_FORMAT_R8G8B8A8_UNORM = 37;
+const uint32_t KTX2_VK_FORMAT_R8G8B8A8_SRGB = 43;
+const uint32_t KTX2_VK_FORMAT_BC1_RGB_UNORM = 131;
+const uint32_t KTX2_VK_FORMAT_BC1_RGB_SRGB = 132;
+const uint32_t KTX2_VK_FORMAT_BC3_UNORM = 137;
+const uint32_t KTX2_VK_FORMAT_BC3_SRGB = 138;
+const uint32_t KTX2_VK_FORMAT_BC7_UNORM = 145;
+const uint32_t KTX2_VK_FORMAT_BC7_SRGB = 146;
+
+struct Ktx2Header
+{
+    uint8_t identifier[12];
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+};
+
+struct Ktx2LevelIndex
+{
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+static_assert(sizeof(Ktx2Header) == 80, "cabecalho KTX2 com 80 bytes");
+static_assert(sizeof(Ktx2LevelIndex) == 24, "indice de nivel KTX2 com 24 bytes");
+
+// Nível dentro do arquivo mapeado
+struct KtxLevel
+{
+    int width, height;
+    const uint8_t *data;
+    size_t size;
+};
+
+// .ktx2 aberto: os níveis apontam para dentro do arquivo mapeado
+struct KtxTextureView
+{
+    MappedFile file;
+    int width = 0, height = 0;
+    TextureFormat format = TextureFormat::RGBA8;
+    bool srgb = true;
+    std::vector<KtxLevel> levels; // nível 0 primeiro
+};
+
+// Arquivo pré-processado de uma imagem: a mesma pasta e o mesmo nome, com .ktx2
+inline std::string cookedTexturePath(const std::string &imagePath)
+{
+    std::filesystem::path path(imagePath);
+    return path.replace_extension(".ktx2").string();
+}
+
+inline uint64_t ktx2Align(uint64_t offset, uint64_t alignment)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+// Alinhamento dos níveis: mínimo múltiplo comum de 4 e do tamanho do bloco
+inline uint64_t ktx2LevelAlignment(TextureFormat format)
+{
+    return format == TextureFormat::RGBA8 ? 4 : textureLevelBytes(4, 4, format);
+}
+
+inline uint32_t ktx2VkFormat(TextureFormat format, bool srgb)
+{
+    switch (format)
+    {
+    case TextureFormat::BC1:
+        return srgb ? KTX2_VK_FORMAT_BC1_RGB_SRGB : KTX2_VK_FORMAT_BC1_RGB_UNORM;
+    case TextureFormat::BC3:
+        return srgb ? KTX2_VK_FORMAT_BC3_SRGB : KTX2_VK_FORMAT_BC3_UNORM;
+    case TextureFormat::BC7:
+        return srgb ? KTX2_VK_FORMAT_BC7_SRGB : KTX2_VK_FORMAT_BC7_UNORM;
+    default:
+        return srgb ? KTX2_VK_FORMAT_R8G8B8A8_SRGB : KTX2_VK_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+
+// Formato de um vkFormat gravado pelo TextureCooker; false para os outros
+inline bool ktx2TextureFormat(uint32_t vkFormat, TextureFormat &format, bool &srgb)
+{
+    for (TextureFormat f : {TextureFormat::RGBA8, TextureFormat::BC1, TextureFormat::BC3, TextureFormat::BC7})
+        for (bool s : {false, true})
+            if (ktx2VkFormat(f, s) == vkFormat)
+            {
+                format = f;
+                srgb = s;
+                return true;
+            }
+    return false;
+}
+
+// Descritor de formato (Khronos Data Format 1.3, bloco básico). RGBA8 tem uma
+// amostra de 8 bits por canal; os formatos BC, uma amostra por parte do
+// bloco (as cores e, no BC3, o alfa).
+inline std::vector<uint32_t> ktx2Descriptor(TextureFormat format, bool srgb)
+{
+    // Canais das amostras: R, G, B, A no RGBA8; cor no BC1 e BC7; alfa e cor no BC3
+    std::vector<uint32_t> channels;
+    uint32_t colorModel, bitLength, blockDimensions = 0;
+    int blockSide = 1;
+    if (format == TextureFormat::RGBA8)
+    {
+        channels = {0, 1, 2, 15};
+        colorModel = 1; // RGBSDA
+        bitLength = 8;
+    }
+    else
+    {
+        channels = format == TextureFormat::BC3 ? std::vector<uint32_t>{15, 0} : std::vector<uint32_t>{0};
+        colorModel = format == TextureFormat::BC1 ? 128 : (format == TextureFormat::BC3 ? 130 : 132); // BC1A, BC3, BC7
+        bitLength = format == TextureFormat::BC7 ? 128 : 64;
+        blockSide = 4;
+        blockDimensions = 3 | (3 << 8); // 4x4 (cada dimensão menos 1)
+    }
+    const uint32_t samples = (uint32_t)channels.size(), blockSize = 24 + 16 * samples;
+    std::vector<uint32_t> dfd;
+    dfd.push_back(4 + blockSize);           // dfdTotalSize
+    dfd.push_back(0);                       // vendorId = Khronos, descriptorType = básico
+    dfd.push_back((blockSize << 16) | 2);   // versionNumber = 2 (KDF 1.3)
+    // colorPrimaries = BT709, transferFunction = sRGB ou linear, flags = alfa direto
+    dfd.push_back(colorModel | (1u << 8) | ((srgb ? 2u : 1u) << 16));
+    dfd.push_back(blockDimensions);
+    dfd.push_back((uint32_t)textureLevelBytes(blockSide, blockSide, format)); // bytesPlane0
+    dfd.push_back(0);
+    for (uint32_t c = 0; c < samples; c++)
+    {
+        // O alfa é sempre linear (qualificador KHR_DF_SAMPLE_DATATYPE_LINEAR)
+        uint32_t channelType = channels[c] | (srgb && channels[c] == 15 ? 0x10u : 0u);
+        dfd.push_back((c * bitLength) | ((bitLength - 1) << 16) | (channelType << 24)); // bitOffset, bitLength - 1, canal
+        dfd.push_back(0);                                                             // samplePosition
+        dfd.push_back(0);                                                             // sampleLower
+        dfd.push_back(format == TextureFormat::RGBA8 ? 255 : 0xFFFFFFFFu);            // sampleUpper
+    }
+    return dfd;
+}
+
+// Grava os níveis (nível 0 primeiro, já no formato `format`) em um .ktx2.
+// Grava primeiro em um arquivo temporário e só então o renomeia.
+inline bool writeKtx2(const std::string &path, const std::vector<KtxLevel> &levels, TextureFormat format, bool srgb)
+{
+    Ktx2Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.identifier, KTX2_IDENTIFIER, sizeof(header.identifier));
+    header.vkFormat = ktx2VkFormat(format, srgb);
+    header.typeSize = 1;
+    header.pixelWidth = (uint32_t)levels[0].width;
+    header.pixelHeight = (uint32_t)levels[0].height;
+    header.faceCount = 1;
+    header.levelCount = (uint32_t)levels.size();
+
+    std::vector<uint32_t> dfd = ktx2Descriptor(format, srgb);
+    header.dfdByteOffset = (uint32_t)(sizeof(Ktx2Header) + levels.size() * sizeof(Ktx2LevelIndex));
+    header.dfdByteLength = (uint32_t)(dfd.size() * sizeof(uint32_t));
+
+    // Um par chave/valor: tamanho, chave e valor terminados em '\0', e o
+    // preenchimento até 4 bytes
+    const char key[] = "KTXwriter", value[] = "CGCCHIB TextureCooker";
+    uint32_t kvLength = (uint32_t)(sizeof(key) + sizeof(value));
+    std::vector<uint8_t> kvd(ktx2Align(4 + kvLength, 4), 0);
+    std::memcpy(kvd.data(), &kvLength, 4);
+    std::memcpy(kvd.data() + 4, key, sizeof(key));
+    std::memcpy(kvd.data() + 4 + sizeof(key), value, sizeof(value));
+    header.kvdByteOffset = header.dfdByteOffset + header.dfdByteLength;
+    header.kvdByteLength = (uint32_t)kvd.size();
+
+    // Níveis do menor para o maior, cada um alinhado no seu bloco (os
+    // tamanhos dos níveis já são múltiplos dele)
+    std::vector<Ktx2LevelIndex> index(levels.size());
+    uint64_t offset = ktx2Align(header.kvdByteOffset + header.kvdByteLength, ktx2LevelAlignment(format));
+    for (size_t l = levels.size(); l-- > 0;)
+    {
+        index[l].byteOffset = offset;
+        index[l].byteLength = index[l].uncompressedByteLength = levels[l].size;
+        offset += index[l].byteLength;
+    }
+
+    std::string tmpPath = path + ".tmp";
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+        return false;
+    const char padding[4] = {};
+    auto writeAt = [&](uint64_t at, const void *bytes, size_t size)
+    {
+        uint64_t pos = (uint64_t)out.tellp();
+        out.write(padding, (std::streamsize)(at - pos));
+        out.write((const char *)bytes, (std::streamsize)size);
+    };
+    writeAt(0, &header, sizeof(header));
+    writeAt(sizeof(header), index.data(), index.size() * sizeof(Ktx2LevelIndex));
+    writeAt(header.dfdByteOffset, dfd.data(), header.dfdByteLength);
+    writeAt(header.kvdByteOffset, kvd.data(), kvd.size());
+    for (size_t l = levels.size(); l-- > 0;)
+        writeAt(index[l].byteOffset, levels[l].data, levels[l].size);
+    out.close();
+    if (!out)
+    {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec)
+    {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Abre um .ktx2 gravado pelo TextureCooker. Retorna false para qualquer
+// outro conteúdo (o chamador lê a imagem original).
+inline bool openKtx2(const std::string &path, KtxTextureView &view)
+{
+    if (!view.file.open(path) || view.file.size() < sizeof(Ktx2Header))
+        return false;
+    Ktx2Header h;
+    std::memcpy(&h, view.file.data(), sizeof(h));
+    uint64_t fileSize = view.file.size();
+    TextureFormat format;
+    bool srgb;
+    if (std::memcmp(h.identifier, KTX2_IDENTIFIER, sizeof(h.identifier)) != 0 || !ktx2TextureFormat(h.vkFormat, format, srgb) ||
+        h.typeSize != 1 || h.pixelWidth == 0 || h.pixelHeight == 0 || h.pixelDepth != 0 || h.layerCount != 0 ||
+        h.faceCount != 1 || h.levelCount == 0 || h.levelCount > 32 || h.supercompressionScheme != 0 ||
+        sizeof(Ktx2Header) + (uint64_t)h.levelCount * sizeof(Ktx2LevelIndex) > fileSize)
+        return false;
+
+    const uint8_t *base = (const uint8_t *)view.file.data();
+    std::vector<MipLevel> expected = mipLevels((int)h.pixelWidth, (int)h.pixelHeight);
+    if (h.levelCount > expected.size())
+        return false;
+    view.levels.clear();
+    for (uint32_t l = 0; l < h.levelCount; l++)
+    {
+        Ktx2LevelIndex entry;
+        std::memcpy(&entry, base + sizeof(Ktx2Header) + l * sizeof(Ktx2LevelIndex), sizeof(entry));
+        size_t size = textureLevelBytes(expected[l].width, expected[l].height, format);
+        if (entry.byteLength != size || entry.byteOffset > fileSize || size > fileSize - entry.byteOffset)
+            return false;
+        view.levels.push_back({expected[l].width, expected[l].height, base + entry.byteOffset, size});
+    }
+    view.width = (int)h.pixelWidth;
+    view.height = (int)h.pixelHeight;
+    view.format = format;
+    view.srgb = srgb;
+    return true;
+}
+
+// Abre o .ktx2 de uma imagem, se existir e não for mais antigo que ela.
+// `imagePath` também pode ser o próprio .ktx2.
+inline bool openCookedTexture(const std::string &imagePath, KtxTextureView &view)
+{
+    std::string cookedPath = cookedTexturePath(imagePath);
+    if (cookedPath != imagePath)
+    {
+        std::error_code ec;
+        std::filesystem::file_time_type cooked = std::filesystem::last_write_time(cookedPath, ec);
+        if (ec)
+            return false;
+        std::filesystem::file_time_type source = std::filesystem::last_write_time(imagePath, ec);
+        if (!ec && source > cooked)
+            return false;
+    }
+    return openKtx2(cookedPath, view);
+}
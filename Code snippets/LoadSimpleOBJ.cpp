@@ -6,28 +6,93 @@
  *
  *  Este arquivo contém a função `loadSimpleOBJ`, responsável por carregar arquivos
  *  no formato Wavefront .OBJ e armazenar seus vértices em um VAO para renderização
- *  com OpenGL.
+ *  com OpenGL. Os vértices repetidos são soldados: o VAO guarda um buffer de
+ *  vértices compacto e um buffer de índices (EBO) de 16 ou 32 bits.
  *
  *  Forma de uso (carregamento de um .obj)
  *  -----------------
  *  ...
- *  int nVertices;
- *  GLuint objVAO = loadSimpleOBJ("../Modelos3D/Cube.obj", nVertices);
+ *  Mesh objMesh;
+ *  GLuint objVAO = loadSimpleOBJ("../Modelos3D/Cube.obj", objMesh);
  *  ...
  *
  *  Chamada de desenho (Polígono Preenchido - GL_TRIANGLES), no loop do programa:
  *  ----------------------------------------------------------
  *  ...
- *  glBindVertexArray(objVAO);
- *  glDrawArrays(GL_TRIANGLES, 0, nVertices);
+ *  glBindVertexArray(objMesh.VAO);
+ *  glDrawElements(GL_TRIANGLES, objMesh.nIndices, objMesh.indexType, 0);
+ *
+ *  Com níveis de detalhe (ver MeshSimplifier.h):
+ *  OBJLoadOptions options;
+ *  options.lodLevels = 4;
+ *  loadSimpleOBJ("../assets/Modelos3D/Suzanne.obj", objMesh, options);
+ *  ...
+ *  const MeshLod &lod = objMesh.lods[selectLod(objMesh.lods, escala, distancia, projScale, 1.0f)];
+ *  glDrawElements(GL_TRIANGLES, lod.indexCount, objMesh.indexType,
+ *                 (GLvoid*)(size_t)(lod.firstIndex * indexTypeSize(objMesh.indexType)));
+ *
+ *  Com materiais (.MTL, ver MtlParser.h): cada submalha é uma faixa do EBO com um
+ *  só material; as texturas são carregadas uma única vez por arquivo (ver
+ *  TextureManager.h) e apagadas quando a última malha que as usa for destruída.
+ *  for (const Submesh &part : objMesh.submeshes)
+ *      if (part.lod == 0)
+ *      {
+ *          bindMaterial(shaderID, objMesh.materials[part.material]);
+ *          drawSubmesh(objMesh, part);
+ *      }
+ *
+ *  Arquivos muito grandes (varreduras de vários GB) podem ser lidos em fluxo,
+ *  com a memória do carregador limitada a um orçamento (ver ObjStream.h):
+ *  options.streamBudget = 256u << 20; // 256 MB
+ *  loadSimpleOBJ("scan.obj", objMesh, options);
+ *
+ *  Os objetos e grupos do .OBJ (`o`/`g`) também separam as submalhas (uma por
+ *  par material/objeto, com a sua caixa envolvente), todas no mesmo VBO/EBO.
+ *  Cada parte pode ser descartada ou escondida, em um glMultiDrawElements por
+ *  material (ver objMesh.objectNames):
+ *  std::vector<uint8_t> visible(objMesh.objectNames.size(), 1);
+ *  glBindVertexArray(objMesh.VAO);
+ *  drawVisibleSubmeshes(shaderID, objMesh, model, projection * view, &visible);
+ *
+ *  Em segundo plano, sem parar o laço de desenho (ver AsyncMeshLoader):
+ *  AsyncMeshLoader loader;
+ *  int id = loader.request("../assets/Modelos3D/Suzanne.obj", options);
+ *  ...
+ *  loader.update(2.0); // a cada quadro: até 2 ms de envio para a GPU
+ *  if (loader.ready(id))
+ *      ... desenha loader.mesh(id)
+ *
+ *  Com as texturas dos materiais em streaming, só com os mipmaps que
+ *  aparecem na tela (ver TextureStreamer.h e Mesh::uvDensity):
+ *  TextureStreamer streamer(64u << 20);
+ *  AsyncMeshLoader loader(1, &streamer);
+ *
+ *  Com meshlets (ver MeshletBuilder.h), descartando grupos fora da tela ou de costas:
+ *  options.meshlets = true;
+ *  ...
+ *  glBindVertexArray(objMesh.VAO);
+ *  drawMeshlets(objMesh, model, projection * view, cameraPos);
+ *
+ *  Atributos de vértice (mesmas localizações do vertex shader do Hello3D):
+ *  layout(location = 0) in vec3 position;
+ *  layout(location = 1) in vec2 texc;
+ *  layout(location = 2) in vec3 normal;
+ *  layout(location = 3) in vec4 packedTangent; // com options.tangents (ver MeshTangents.h)
  *
  */
 
  // Cabeçalhos necessários (para esta função), acrescentar ao seu código 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <deque>
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
  
  
@@ -44,95 +109,1023 @@ using namespace std;
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+// STB_IMAGE (a implementação, STB_IMAGE_IMPLEMENTATION, fica no programa)
+#include <stb_image.h>
+
+// Leitor do .OBJ mapeado em memória, soldagem e otimização de vértices,
+// níveis de detalhe, materiais e cache binário (mesma pasta deste arquivo)
+#include "ObjParser.h"
+#include "MtlParser.h"
+#include "ObjStream.h"
+#include "MeshNormals.h"
+#include "MeshTangents.h"
+#include "MeshBuilder.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "MeshletBuilder.h"
+#include "VertexQuantization.h"
+#include "MeshData.h"
+#include "MeshCache.h"
+#include "MpscQueue.h"
+#include "TextureManager.h"
+#include "AsyncTextureLoader.h"
+#include "TextureStreamer.h"
+
 struct Mesh 
 {
     GLuint VAO; 
+    GLuint VBO;
+    GLuint EBO;
+    GLsizei nVertices;  // vértices distintos no VBO
+    GLsizei nIndices;   // número de índices para glDrawElements (malha original, LOD 0)
+    GLenum indexType;   // GL_UNSIGNED_SHORT ou GL_UNSIGNED_INT
+    std::vector<Submesh> submeshes; // uma por par material/objeto em cada nível de detalhe
+    std::vector<Material> materials; // Submesh::material indexa esta lista
+    std::vector<TextureHandle> textures; // mantêm as texturas dos materiais na GPU (ver TextureManager.h)
+    std::vector<std::string> objectNames; // Submesh::object indexa esta lista (`o`/`g` do .OBJ)
+    std::vector<MeshLod> lods;  // lods[0] é a malha original; os demais vêm depois no EBO
+    std::vector<Meshlet> meshlets; // grupos do LOD 0, se pedidos (ver drawMeshlets)
+    glm::vec3 boundsMin, boundsMax;
+    glm::vec2 uvMin, uvMax;     // usados para decodificar VertexLayout::Quantized
+    float uvDensity;            // unidades de UV por unidade do objeto (ver TextureStreamer.h)
+};
 
+struct OBJLoadOptions
+{
+    VertexLayout layout = VertexLayout::Interleaved; // ver buildMeshData
+    bool useCache = true; // lê/grava o cache binário <arquivo>.obj.meshbin ao lado do .OBJ
+    int lodLevels = 1;    // níveis de detalhe (1 = só a malha original)
+    bool meshlets = false; // divide o LOD 0 em meshlets para descarte por grupo
+    // Normais geradas para os cantos sem `vn` (ver MeshNormals.h): ângulo das
+    // arestas vivas, em graus, e peso das faces
+    float creaseAngle = NORMAL_CREASE_ANGLE;
+    NormalWeighting normalWeighting = NormalWeighting::Angle;
+    // Tangentes semelhantes às do MikkTSpace para mapas de normais, na localização 3 (ver MeshTangents.h)
+    bool tangents = false;
+    // Bytes de memória do carregador na leitura em fluxo (0 = leitura normal).
+    // Nesse modo não há otimização, LODs, meshlets nem cache (ver loadStreamingOBJ)
+    size_t streamBudget = 0;
 };
 
-int loadSimpleOBJ(string filePATH, int &nVertices)
- {
-    std::vector<glm::vec3> vertices;
-    std::vector<glm::vec2> texCoords;
-    std::vector<glm::vec3> normals;
-    std::vector<GLfloat> vBuffer;
-    glm::vec3 color = glm::vec3(1.0, 0.0, 0.0);
-
-    std::ifstream arqEntrada(filePATH.c_str());
-    if (!arqEntrada.is_open()) 
+// Empacota os vértices soldados no formato do VBO, com as localizações do
+// vertex shader do Hello3D (0: posição, 1: coord. de textura, 2: normal):
+//  - VertexLayout::Interleaved: x, y, z, s, t, nx, ny, nz por vértice (32 bytes)
+//  - VertexLayout::Separate: todas as posições, depois todas as coordenadas de
+//    textura e depois todas as normais, no mesmo VBO
+//  - VertexLayout::Quantized: QuantizedVertex (16 bytes), decodificado pelo
+//    quantizedVertexShaderSource (normal em vec2 na localização 2)
+// Com indexed.tangents, cada vértice ganha a tangente compactada (packTangent,
+// 4 bytes) na localização 3: depois dos outros atributos nos formatos
+// intercalados e em um quarto fluxo no Separate.
+// Se `lods` estiver vazio, todos os índices formam um único nível.
+MeshData buildMeshData(const IndexedMesh &indexed, VertexLayout layout, const std::vector<MeshLod> &lods,
+                       const ScratchVector<Meshlet> &meshlets, const ScratchVector<std::string> &materialLibs)
+{
+    MeshData data;
+    size_t n = indexed.vertices.size();
+    const GLuint posSize = 3 * sizeof(GLfloat), uvSize = 2 * sizeof(GLfloat), normalSize = 3 * sizeof(GLfloat);
+    const bool hasTangents = indexed.tangents.size() == n;
+    const GLuint tangentSize = hasTangents ? sizeof(uint32_t) : 0;
+    const GLuint stride = posSize + uvSize + normalSize + tangentSize;
+
+    data.layout = layout;
+    data.vertexCount = (uint32_t)n;
+
+    if (n > 0)
+    {
+        data.boundsMin = data.boundsMax = indexed.vertices[0].position;
+        data.uvMin = data.uvMax = indexed.vertices[0].texCoord;
+    }
+    for (const MeshVertex &v : indexed.vertices)
 	{
-        std::cerr << "Erro ao tentar ler o arquivo " << filePATH << std::endl;
-        return -1;
+        data.boundsMin = glm::min(data.boundsMin, v.position);
+        data.boundsMax = glm::max(data.boundsMax, v.position);
+        data.uvMin = glm::min(data.uvMin, v.texCoord);
+        data.uvMax = glm::max(data.uvMax, v.texCoord);
     }
 
-    std::string line;
-    while (std::getline(arqEntrada, line)) 
-	{
-        std::istringstream ssline(line);
-        std::string word;
-        ssline >> word;
-
-        if (word == "v") 
-		{
-            glm::vec3 vertice;
-            ssline >> vertice.x >> vertice.y >> vertice.z;
-            vertices.push_back(vertice);
-        } 
-        else if (word == "vt") 
-		{
-            glm::vec2 vt;
-            ssline >> vt.s >> vt.t;
-            texCoords.push_back(vt);
-        } 
-        else if (word == "vn") 
-		{
-            glm::vec3 normal;
-            ssline >> normal.x >> normal.y >> normal.z;
-            normals.push_back(normal);
-        } 
-        else if (word == "f")
-		 {
-            while (ssline >> word) 
-			{
-                int vi = 0, ti = 0, ni = 0;
-                std::istringstream ss(word);
-                std::string index;
-
-                if (std::getline(ss, index, '/')) vi = !index.empty() ? std::stoi(index) - 1 : 0;
-                if (std::getline(ss, index, '/')) ti = !index.empty() ? std::stoi(index) - 1 : 0;
-                if (std::getline(ss, index)) ni = !index.empty() ? std::stoi(index) - 1 : 0;
-
-                vBuffer.push_back(vertices[vi].x);
-                vBuffer.push_back(vertices[vi].y);
-                vBuffer.push_back(vertices[vi].z);
-                vBuffer.push_back(color.r);
-                vBuffer.push_back(color.g);
-                vBuffer.push_back(color.b);
+    if (layout == VertexLayout::Quantized)
+    {
+        const GLuint qStride = sizeof(QuantizedVertex) + tangentSize;
+        data.vertexBytes.resize(n * qStride);
+        uint8_t *dst = data.vertexBytes.data();
+        glm::vec3 posExtent = data.boundsMax - data.boundsMin;
+        glm::vec2 uvExtent = data.uvMax - data.uvMin;
+        for (size_t i = 0; i < n; i++)
+        {
+            const MeshVertex &v = indexed.vertices[i];
+            QuantizedVertex q = quantizeVertex(v.position, v.texCoord, v.normal, data.boundsMin, posExtent, data.uvMin, uvExtent);
+            memcpy(dst + i * qStride, &q, sizeof(QuantizedVertex));
+            if (hasTangents)
+            {
+                uint32_t t = packTangent(indexed.tangents[i]);
+                memcpy(dst + i * qStride + sizeof(QuantizedVertex), &t, tangentSize);
             }
         }
+        data.attributes.push_back({0, 3, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(QuantizedVertex, position), qStride});
+        data.attributes.push_back({1, 2, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(QuantizedVertex, texCoord), qStride});
+        data.attributes.push_back({2, 2, GL_SHORT, GL_TRUE, offsetof(QuantizedVertex, normal), qStride});
+        if (hasTangents)
+            data.attributes.push_back({3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(QuantizedVertex), qStride});
+    }
+    else if (layout == VertexLayout::Interleaved)
+    {
+        data.vertexBytes.resize(n * stride);
+        uint8_t *dst = data.vertexBytes.data();
+        for (size_t i = 0; i < n; i++)
+        {
+            const MeshVertex &v = indexed.vertices[i];
+            memcpy(dst + i * stride, &v.position, posSize);
+            memcpy(dst + i * stride + posSize, &v.texCoord, uvSize);
+            memcpy(dst + i * stride + posSize + uvSize, &v.normal, normalSize);
+            if (hasTangents)
+            {
+                uint32_t t = packTangent(indexed.tangents[i]);
+                memcpy(dst + i * stride + posSize + uvSize + normalSize, &t, tangentSize);
+            }
+        }
+        data.attributes.push_back({0, 3, GL_FLOAT, GL_FALSE, 0, stride});
+        data.attributes.push_back({1, 2, GL_FLOAT, GL_FALSE, posSize, stride});
+        data.attributes.push_back({2, 3, GL_FLOAT, GL_FALSE, posSize + uvSize, stride});
+        if (hasTangents)
+            data.attributes.push_back({3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, posSize + uvSize + normalSize, stride});
+    }
+    else
+    {
+        data.vertexBytes.resize(n * stride);
+        uint8_t *dst = data.vertexBytes.data();
+        GLuint uvOffset = (GLuint)(n * posSize);
+        GLuint normalOffset = (GLuint)(n * (posSize + uvSize));
+        GLuint tangentOffset = (GLuint)(n * (posSize + uvSize + normalSize));
+        for (size_t i = 0; i < n; i++)
+        {
+            const MeshVertex &v = indexed.vertices[i];
+            memcpy(dst + i * posSize, &v.position, posSize);
+            memcpy(dst + uvOffset + i * uvSize, &v.texCoord, uvSize);
+            memcpy(dst + normalOffset + i * normalSize, &v.normal, normalSize);
+            if (hasTangents)
+            {
+                uint32_t t = packTangent(indexed.tangents[i]);
+                memcpy(dst + tangentOffset + i * tangentSize, &t, tangentSize);
+            }
+        }
+        data.attributes.push_back({0, 3, GL_FLOAT, GL_FALSE, 0, posSize});
+        data.attributes.push_back({1, 2, GL_FLOAT, GL_FALSE, uvOffset, uvSize});
+        data.attributes.push_back({2, 3, GL_FLOAT, GL_FALSE, normalOffset, normalSize});
+        if (hasTangents)
+            data.attributes.push_back({3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, tangentOffset, tangentSize});
     }
 
-    arqEntrada.close();
+    setMeshIndices(data, indexed.indices, data.vertexCount);
+    data.lods = lods;
+    if (data.lods.empty())
+        data.lods.push_back({0, data.indexCount, 0.0f});
+    UVAreaSum areas;
+    for (uint32_t i = data.lods[0].firstIndex; i + 2 < data.lods[0].firstIndex + data.lods[0].indexCount; i += 3)
+        areas.add(indexed.vertices[indexed.indices[i]], indexed.vertices[indexed.indices[i + 1]],
+                  indexed.vertices[indexed.indices[i + 2]]);
+    data.uvDensity = areas.density();
+    data.submeshes.assign(indexed.submeshes.begin(), indexed.submeshes.end());
+    data.materialNames.assign(indexed.materialNames.begin(), indexed.materialNames.end());
+    if (data.materialNames.empty())
+        data.materialNames.push_back("");
+    data.objectNames.assign(indexed.objectNames.begin(), indexed.objectNames.end());
+    if (data.objectNames.empty())
+        data.objectNames.push_back("");
+    if (data.submeshes.empty())
+        data.submeshes.push_back({data.lods[0].firstIndex, data.lods[0].indexCount, 0, 0, 0, data.boundsMin, data.boundsMax});
+    data.materialLibs.assign(materialLibs.begin(), materialLibs.end());
+    data.meshlets.assign(meshlets.begin(), meshlets.end());
+    return data;
+}
 
+// Cria VAO, VBO e EBO a partir de bytes já no formato final
+GLuint uploadMesh(const std::vector<VertexAttribute> &attributes, const void *vertexBytes, size_t vertexSize,
+                  const void *indexBytes, size_t indexSize, GLenum indexType, Mesh &mesh)
+{
     std::cout << "Gerando o buffer de geometria..." << std::endl;
-    GLuint VBO, VAO;
+    GLuint VBO, EBO, VAO;
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+
     glGenBuffers(1, &VBO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vBuffer.size() * sizeof(GLfloat), vBuffer.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertexSize, vertexBytes, GL_STATIC_DRAW);
+
+    // O EBO fica registrado no VAO, por isso é vinculado com o VAO ativo
+    glGenBuffers(1, &EBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexSize, indexBytes, GL_STATIC_DRAW);
+
+    for (const VertexAttribute &a : attributes)
+    {
+        glVertexAttribPointer(a.location, a.components, a.type, (GLboolean)a.normalized, a.stride, (GLvoid*)(size_t)a.offset);
+        glEnableVertexAttribArray(a.location);
+    }
     
+    // O EBO só pode ser desvinculado depois do VAO
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    mesh.VAO = VAO;
+    mesh.VBO = VBO;
+    mesh.EBO = EBO;
+    mesh.indexType = indexType;
+    mesh.nIndices = (GLsizei)(indexSize / indexTypeSize(indexType));
+
+    return VAO;
+}
+
+// Textura difusa de um material, do gerenciador compartilhado: os materiais
+// e malhas que usam a mesma imagem recebem a mesma textura. O caminho "" dá
+// uma textura de um texel branco (material sem map_Kd). O handle vai para
+// `textures`, que mantém a textura viva enquanto a malha existir.
+void loadMaterialTexture(Material &material, std::vector<TextureHandle> &textures)
+{
+    TextureHandle texture = textureManager().load(material.mapKd);
+    material.diffuseTexture = texture->id;
+    material.diffuseSampler = texture->samplerObject ? texture->samplerObject->id : 0;
+    textures.push_back(std::move(texture));
+}
+
+// Lê os .MTL (relativos à pasta do .OBJ) e monta a lista de materiais na
+// ordem de `names`. Nomes não encontrados ficam com o material padrão. Não
+// cria as texturas (não usa a OpenGL, pode rodar em outra thread).
+void findMaterials(const std::string &filePATH, const std::vector<std::string> &libs,
+                   const std::vector<std::string> &names, std::vector<Material> &materials)
+{
+    std::vector<Material> library;
+    std::string dir = directoryOf(filePATH);
+    for (const std::string &lib : libs)
+        parseMTLFile(dir + lib, library);
+
+    materials.clear();
+    for (const std::string &name : names)
+    {
+        Material material;
+        material.name = name;
+        auto it = std::find_if(library.begin(), library.end(), [&](const Material &m) { return m.name == name; });
+        if (it != library.end())
+            material = *it;
+        else if (!name.empty())
+            std::cerr << "Aviso: material " << name << " nao encontrado para " << filePATH << std::endl;
+        materials.push_back(material);
+    }
+}
+
+// Materiais de `names` (ver findMaterials) com as suas texturas difusas
+void loadMaterials(const std::string &filePATH, const std::vector<std::string> &libs,
+                   const std::vector<std::string> &names, std::vector<Material> &materials,
+                   std::vector<TextureHandle> &textures)
+{
+    findMaterials(filePATH, libs, names, materials);
+    textures.clear();
+    for (Material &material : materials)
+        loadMaterialTexture(material, textures);
+}
+
+// Leitura em fluxo: os lotes de ObjStream vão direto para o VBO e o EBO, que
+// são criados com o tamanho final (o EBO) ou estimado (o VBO, que cresce por
+// cópia na própria GPU se a estimativa não bastar). Cada lote é escrito em um
+// trecho mapeado com glMapBufferRange, sem cópia intermediária na RAM. Só o
+// formato intercalado com índices de 32 bits é gerado.
+int loadStreamingOBJ(const string &filePATH, Mesh &mesh, size_t budgetBytes)
+{
+    ObjStream stream;
+    if (!stream.open(filePATH, budgetBytes))
+        return -1;
+    const ObjStreamCounts &counts = stream.counts();
+    std::cout << filePATH << ": leitura em fluxo, " << counts.triangles << " triangulos em lotes de "
+              << stream.trianglesPerBatch() << " (memoria do leitor: " << (stream.memoryBytes() >> 20) << " MB)" << std::endl;
+
+    const GLuint stride = sizeof(MeshVertex);
+    size_t indexCapacity = counts.triangles * 3;
+    // Vértices distintos: pelo menos o maior número de registros v/vt/vn, mais
+    // as duplicatas das fronteiras entre lotes
+    size_t vertexCapacity = std::max(std::max(counts.vertices, counts.texCoords), counts.normals);
+    vertexCapacity = std::max<size_t>(vertexCapacity + vertexCapacity / 8, 1024);
+
+    GLuint VAO, VBO, EBO;
     glGenVertexArrays(1, &VAO);
     glBindVertexArray(VAO);
-    
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)0);
-    glEnableVertexAttribArray(0);
+    glGenBuffers(1, &VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertexCapacity * stride, nullptr, GL_STATIC_DRAW);
+    glGenBuffers(1, &EBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity * sizeof(GLuint), nullptr, GL_STATIC_DRAW);
+
+    mesh.submeshes.clear();
+    mesh.boundsMin = mesh.boundsMax = glm::vec3(0.0f);
+    mesh.uvMin = mesh.uvMax = glm::vec2(0.0f);
+    UVAreaSum areas;
+    size_t nVertices = 0, nIndices = 0;
+    bool ok = true;
+    ObjStreamBatch batch;
+    while (ok && stream.next(batch))
+    {
+        if (nIndices + batch.indices.size() > indexCapacity)
+        {
+            std::cerr << "Erro: " << filePATH << " mudou durante a leitura" << std::endl;
+            ok = false;
+            break;
+        }
+        if (nVertices + batch.vertices.size() > vertexCapacity)
+        {
+            // Cresce o VBO em 50%, copiando o conteúdo na GPU
+            size_t grown = std::max(vertexCapacity + vertexCapacity / 2, nVertices + batch.vertices.size());
+            GLuint bigger;
+            glGenBuffers(1, &bigger);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, bigger);
+            glBufferData(GL_COPY_WRITE_BUFFER, grown * stride, nullptr, GL_STATIC_DRAW);
+            glBindBuffer(GL_COPY_READ_BUFFER, VBO);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, nVertices * stride);
+            glDeleteBuffers(1, &VBO);
+            VBO = bigger;
+            vertexCapacity = grown;
+            glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        }
+
+        // MeshVertex já está no formato intercalado (x, y, z, s, t, nx, ny, nz)
+        GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+        void *dst = glMapBufferRange(GL_ARRAY_BUFFER, nVertices * stride, batch.vertices.size() * stride, access);
+        if (dst)
+        {
+            memcpy(dst, batch.vertices.data(), batch.vertices.size() * stride);
+            ok = glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+        }
+        GLuint *idx = (GLuint *)glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, nIndices * sizeof(GLuint),
+                                                 batch.indices.size() * sizeof(GLuint), access);
+        if (idx)
+        {
+            for (size_t i = 0; i < batch.indices.size(); i++)
+                idx[i] = batch.indices[i] + (GLuint)nVertices;
+            ok = glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER) == GL_TRUE && ok;
+        }
+        if (!dst || !idx)
+            ok = false;
+
+        if (nVertices == 0)
+        {
+            mesh.boundsMin = mesh.boundsMax = batch.vertices[0].position;
+            mesh.uvMin = mesh.uvMax = batch.vertices[0].texCoord;
+        }
+        for (const MeshVertex &v : batch.vertices)
+        {
+            mesh.boundsMin = glm::min(mesh.boundsMin, v.position);
+            mesh.boundsMax = glm::max(mesh.boundsMax, v.position);
+            mesh.uvMin = glm::min(mesh.uvMin, v.texCoord);
+            mesh.uvMax = glm::max(mesh.uvMax, v.texCoord);
+        }
+        for (size_t i = 0; i + 2 < batch.indices.size(); i += 3)
+            areas.add(batch.vertices[batch.indices[i]], batch.vertices[batch.indices[i + 1]],
+                      batch.vertices[batch.indices[i + 2]]);
+        // Faixas de material/objeto, unidas às do lote anterior quando continuam
+        // o mesmo material e objeto, com a caixa dos seus triângulos
+        for (const Submesh &part : batch.parts)
+        {
+            uint32_t first = (uint32_t)nIndices + part.firstIndex;
+            glm::vec3 lo = batch.vertices[batch.indices[part.firstIndex]].position, hi = lo;
+            for (uint32_t i = part.firstIndex; i < part.firstIndex + part.indexCount; i++)
+            {
+                lo = glm::min(lo, batch.vertices[batch.indices[i]].position);
+                hi = glm::max(hi, batch.vertices[batch.indices[i]].position);
+            }
+            Submesh *last = mesh.submeshes.empty() ? nullptr : &mesh.submeshes.back();
+            if (last && last->material == part.material && last->object == part.object &&
+                last->firstIndex + last->indexCount == first)
+            {
+                last->indexCount += part.indexCount;
+                last->boundsMin = glm::min(last->boundsMin, lo);
+                last->boundsMax = glm::max(last->boundsMax, hi);
+            }
+            else
+                mesh.submeshes.push_back({first, part.indexCount, part.material, 0, part.object, lo, hi});
+        }
+        nVertices += batch.vertices.size();
+        nIndices += batch.indices.size();
+    }
+    if (!ok)
+    {
+        std::cerr << "Erro ao enviar " << filePATH << " para a GPU" << std::endl;
+        glBindVertexArray(0);
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        return -1;
+    }
 
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*)offsetof(MeshVertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*)offsetof(MeshVertex, texCoord));
     glEnableVertexAttribArray(1);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*)offsetof(MeshVertex, normal));
+    glEnableVertexAttribArray(2);
     glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-	nVertices = vBuffer.size() / 6;  // x, y, z, r, g, b (valores atualmente armazenados por vértice)
+    mesh.VAO = VAO;
+    mesh.VBO = VBO;
+    mesh.EBO = EBO;
+    mesh.indexType = GL_UNSIGNED_INT;
+    mesh.nVertices = (GLsizei)nVertices;
+    mesh.nIndices = (GLsizei)nIndices;
+    mesh.lods.assign(1, MeshLod{0, (uint32_t)nIndices, 0.0f});
+    mesh.uvDensity = areas.density();
+    mesh.meshlets.clear();
+    if (mesh.submeshes.empty())
+        mesh.submeshes.push_back({0, (uint32_t)nIndices, 0, 0, 0, mesh.boundsMin, mesh.boundsMax});
+    mesh.objectNames = stream.objectNames();
+    if (mesh.objectNames.empty())
+        mesh.objectNames.push_back("");
+    std::vector<std::string> names = stream.materialNames();
+    if (names.empty())
+        names.push_back("");
+    loadMaterials(filePATH, stream.materialLibs(), names, mesh.materials, mesh.textures);
 
+    std::cout << filePATH << ": " << nVertices << " vertices distintos para " << nIndices << " indices" << std::endl;
     return VAO;
-}
\ No newline at end of file
+}
+
+// Bits de MeshBinHeader::flags para as opções de carregamento
+inline uint32_t meshCacheFlags(const OBJLoadOptions &options)
+{
+    return (options.meshlets ? MESHBIN_MESHLETS : 0) | (options.tangents ? MESHBIN_TANGENTS : 0);
+}
+
+// Abre o cache binário do .OBJ se ele estiver em dia e tiver sido gerado
+// com as mesmas opções
+bool openMatchingMeshCache(const string &filePATH, const OBJLoadOptions &options, MeshCacheView &cache)
+{
+    return openMeshCache(meshCachePath(filePATH), filePATH, cache) && cache.header.layout == (uint32_t)options.layout &&
+           cache.header.lodLevels == (uint32_t)std::max(options.lodLevels, 1) && cache.header.flags == meshCacheFlags(options) &&
+           cache.header.creaseAngle == options.creaseAngle && cache.header.normalWeighting == (uint32_t)options.normalWeighting;
+}
+
+// Cópia do cache para a RAM (para enviar à GPU depois, em outra thread)
+MeshData meshDataFromCache(const MeshCacheView &cache)
+{
+    const MeshBinHeader &h = cache.header;
+    MeshData data;
+    data.layout = (VertexLayout)h.layout;
+    data.attributes = cache.attributes;
+    data.vertexBytes.assign(cache.vertexBytes, cache.vertexBytes + h.vertexSize);
+    data.indexBytes.assign(cache.indexBytes, cache.indexBytes + h.indexSize);
+    data.vertexCount = (uint32_t)h.vertexCount;
+    data.indexCount = (uint32_t)(h.indexSize / indexTypeSize(h.indexType));
+    data.indexType = h.indexType;
+    data.submeshes = cache.submeshes;
+    data.materialNames = cache.materialNames;
+    data.materialLibs = cache.materialLibs;
+    data.objectNames = cache.objectNames;
+    data.lods = cache.lods;
+    data.meshlets = cache.meshlets;
+    data.boundsMin = glm::vec3(h.boundsMin[0], h.boundsMin[1], h.boundsMin[2]);
+    data.boundsMax = glm::vec3(h.boundsMax[0], h.boundsMax[1], h.boundsMax[2]);
+    data.uvMin = glm::vec2(h.uvMin[0], h.uvMin[1]);
+    data.uvMax = glm::vec2(h.uvMax[0], h.uvMax[1]);
+    data.uvDensity = h.uvDensity;
+    return data;
+}
+
+// Toda a parte do carregamento que não usa a OpenGL: leitura, normais,
+// soldagem, otimização, LODs, tangentes, meshlets e gravação do cache. Pode
+// rodar em uma thread de trabalho (ver AsyncMeshLoader). As estruturas
+// temporárias ficam em uma arena (ver ArenaAllocator.h), devolvida de uma vez
+// no fim: só `data` e alguns nomes vão para o heap.
+bool buildOBJMeshData(const string &filePATH, const OBJLoadOptions &options, MeshData &data)
+{
+    // Declarada antes de tudo para ser destruída por último
+    ArenaResource arena;
+    ScratchScope scope(&arena);
+
+    int lodLevels = std::max(options.lodLevels, 1);
+    ObjData obj;
+
+    // 0: usa todos os núcleos (arquivos pequenos são lidos de forma serial)
+    if (!parseOBJFile(filePATH, obj, 0))
+        return false;
+
+    // Sem `vn`, as normais são geradas a partir das faces (grupos `s` e arestas vivas)
+    size_t generatedNormals = generateNormals(obj, options.creaseAngle, options.normalWeighting);
+    if (generatedNormals > 0)
+        std::cout << filePATH << ": " << generatedNormals << " normais geradas" << std::endl;
+
+    IndexedMesh indexed = buildIndexedMesh(obj);
+
+    // Reordena triângulos (cache de vértices e overdraw) e vértices (busca no VBO)
+    MeshOptimizeStats stats;
+    optimizeMesh(indexed, &stats);
+    std::cout << filePATH << ": ACMR " << stats.acmrBefore << " -> " << stats.acmrAfter
+              << ", ATVR " << stats.atvrBefore << " -> " << stats.atvrAfter << std::endl;
+
+    // Níveis simplificados, com os índices acrescentados depois dos da malha original
+    std::vector<MeshLod> lods;
+    if (lodLevels > 1)
+    {
+        lods = buildLodChain(indexed, lodLevels);
+        for (size_t i = 0; i < lods.size(); i++)
+            std::cout << filePATH << ": LOD " << i << " com " << lods[i].indexCount / 3
+                      << " triangulos, erro " << lods[i].error << std::endl;
+    }
+
+    // Tangentes do LOD 0 antes dos meshlets: podem duplicar vértices no fim do
+    // VBO e mudar os vértices que cada meshlet usa
+    if (options.tangents)
+    {
+        size_t copies = generateTangents(indexed, lods.empty() ? indexed.indices.size() : lods[0].indexCount);
+        std::cout << filePATH << ": tangentes geradas (" << copies << " vertices duplicados)" << std::endl;
+    }
+
+    // Meshlets do LOD 0, submalha a submalha (reordena os triângulos de cada
+    // submalha dentro da sua faixa do EBO, para que um meshlet tenha um só material)
+    ScratchVector<Meshlet> meshlets;
+    if (options.meshlets)
+    {
+        MeshletScratch scratch;
+        for (const Submesh &part : indexed.submeshes)
+        {
+            if (part.lod != 0)
+                continue;
+            ScratchVector<Meshlet> partMeshlets = buildMeshlets(indexed, part.firstIndex, part.indexCount,
+                                                              MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES, &scratch);
+            meshlets.insert(meshlets.end(), partMeshlets.begin(), partMeshlets.end());
+        }
+        std::cout << filePATH << ": " << meshlets.size() << " meshlets" << std::endl;
+    }
+
+    computeSubmeshBounds(indexed);
+    data = buildMeshData(indexed, options.layout, lods, meshlets, obj.materialLibs);
+
+    if (options.useCache)
+    {
+        string cachePath = meshCachePath(filePATH);
+        MeshSourceInfo source;
+        if (!readSourceInfo(filePATH, source, true) ||
+            !writeMeshCache(cachePath, data, source, (uint32_t)lodLevels, meshCacheFlags(options), options.creaseAngle,
+                            (uint32_t)options.normalWeighting))
+            std::cerr << "Aviso: nao foi possivel gravar o cache " << cachePath << std::endl;
+    }
+
+    std::cout << filePATH << ": " << data.vertexCount << " vertices distintos para "
+              << data.indexCount << " indices" << std::endl;
+    std::cout << filePATH << ": memoria temporaria de " << (arena.reservedBytes() >> 20) << " MB na arena e ate "
+              << (arena.peakLargeBytes() >> 20) << " MB em vetores grandes, " << arena.heapAllocationCount()
+              << " alocacoes no heap (" << arena.allocationCount() << " pedidos)" << std::endl;
+    return true;
+}
+
+// Preenche os campos de `mesh` que não são objetos da OpenGL (faixas, LODs,
+// meshlets, caixas); o VAO vem de uploadMesh e os materiais de loadMaterials
+void copyMeshInfo(const MeshData &data, Mesh &mesh)
+{
+    mesh.nVertices = (GLsizei)data.vertexCount;
+    mesh.submeshes = data.submeshes;
+    mesh.objectNames = data.objectNames;
+    mesh.lods = data.lods;
+    mesh.meshlets = data.meshlets;
+    if (!mesh.lods.empty())
+        mesh.nIndices = (GLsizei)mesh.lods[0].indexCount;
+    mesh.boundsMin = data.boundsMin;
+    mesh.boundsMax = data.boundsMax;
+    mesh.uvMin = data.uvMin;
+    mesh.uvMax = data.uvMax;
+    mesh.uvDensity = data.uvDensity;
+}
+
+int loadSimpleOBJ(string filePATH, Mesh &mesh, const OBJLoadOptions &options = OBJLoadOptions())
+ {
+    if (options.streamBudget > 0)
+    {
+        if (options.lodLevels > 1 || options.meshlets || options.tangents || options.layout != VertexLayout::Interleaved)
+            std::cerr << "Aviso: a leitura em fluxo ignora layout, lodLevels, meshlets e tangents" << std::endl;
+        return loadStreamingOBJ(filePATH, mesh, options.streamBudget);
+    }
+
+    if (options.useCache)
+    {
+        // O VBO e o EBO vêm direto do arquivo mapeado, sem cópia na RAM
+        MeshCacheView cache;
+        if (openMatchingMeshCache(filePATH, options, cache))
+        {
+            const MeshBinHeader &h = cache.header;
+            GLuint VAO = uploadMesh(cache.attributes, cache.vertexBytes, h.vertexSize, cache.indexBytes, h.indexSize, h.indexType, mesh);
+            mesh.nVertices = (GLsizei)h.vertexCount;
+            mesh.submeshes = cache.submeshes;
+            mesh.objectNames = cache.objectNames;
+            loadMaterials(filePATH, cache.materialLibs, cache.materialNames, mesh.materials, mesh.textures);
+            mesh.lods = cache.lods;
+            mesh.meshlets = cache.meshlets;
+            if (!mesh.lods.empty())
+                mesh.nIndices = (GLsizei)mesh.lods[0].indexCount;
+            mesh.boundsMin = glm::vec3(h.boundsMin[0], h.boundsMin[1], h.boundsMin[2]);
+            mesh.boundsMax = glm::vec3(h.boundsMax[0], h.boundsMax[1], h.boundsMax[2]);
+            mesh.uvMin = glm::vec2(h.uvMin[0], h.uvMin[1]);
+            mesh.uvMax = glm::vec2(h.uvMax[0], h.uvMax[1]);
+            mesh.uvDensity = h.uvDensity;
+            std::cout << filePATH << ": carregado do cache " << meshCachePath(filePATH) << std::endl;
+            return VAO;
+        }
+    }
+
+    MeshData data;
+    if (!buildOBJMeshData(filePATH, options, data))
+        return -1;
+
+    GLuint VAO = uploadMesh(data.attributes, data.vertexBytes.data(), data.vertexBytes.size(),
+                            data.indexBytes.data(), data.indexBytes.size(), data.indexType, mesh);
+    copyMeshInfo(data, mesh);
+    loadMaterials(filePATH, data.materialLibs, data.materialNames, mesh.materials, mesh.textures);
+
+    return VAO;
+}
+
+// Uniforms de Phong do material (ka, kd, ks, q) e a sua textura difusa na
+// unidade 0 (o programa precisa estar em uso). Nos desenhos ordenados por
+// material, chamar uma vez por material, antes das suas submalhas.
+void bindMaterial(GLuint shaderID, const Material &material)
+{
+    glUniform3fv(glGetUniformLocation(shaderID, "ka"), 1, glm::value_ptr(material.ka));
+    glUniform3fv(glGetUniformLocation(shaderID, "kd"), 1, glm::value_ptr(material.kd));
+    glUniform3fv(glGetUniformLocation(shaderID, "ks"), 1, glm::value_ptr(material.ks));
+    glUniform1f(glGetUniformLocation(shaderID, "q"), material.ns);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, material.diffuseTexture);
+    glBindSampler(0, material.diffuseSampler);
+}
+
+// Desenha uma submalha (o VAO da malha precisa estar vinculado)
+void drawSubmesh(const Mesh &mesh, const Submesh &part)
+{
+    glDrawElements(GL_TRIANGLES, (GLsizei)part.indexCount, mesh.indexType,
+                   (GLvoid*)(size_t)(part.firstIndex * indexTypeSize(mesh.indexType)));
+}
+
+// Desenha as submalhas do LOD 0 cuja caixa está dentro do frustum, com um
+// glMultiDrawElements por material: cada material é vinculado uma vez, e
+// milhares de partes (`o`/`g`) custam poucas chamadas. O VAO da malha precisa
+// estar vinculado e o programa em uso. `objectVisible` (opcional) tem um valor
+// por objeto de mesh.objectNames; os objetos com 0 não são desenhados.
+// Retorna o número de triângulos enviados.
+GLsizei drawVisibleSubmeshes(GLuint shaderID, const Mesh &mesh, const glm::mat4 &model, const glm::mat4 &viewProjection,
+                             const std::vector<uint8_t> *objectVisible = nullptr)
+{
+    // Reaproveitados entre quadros para não alocar a cada chamada
+    static std::vector<GLsizei> counts;
+    static std::vector<const GLvoid*> offsets;
+
+    Frustum frustum = frustumFromMatrix(viewProjection * model);
+    GLuint indexSize = indexTypeSize(mesh.indexType);
+    GLsizei triangles = 0;
+    size_t i = 0;
+    while (i < mesh.submeshes.size())
+    {
+        // As submalhas de um nível ficam em ordem de material
+        uint32_t material = mesh.submeshes[i].material;
+        uint32_t lod = mesh.submeshes[i].lod;
+        counts.clear();
+        offsets.clear();
+        uint32_t runEnd = 0;
+        for (; i < mesh.submeshes.size() && mesh.submeshes[i].material == material && mesh.submeshes[i].lod == lod; i++)
+        {
+            const Submesh &part = mesh.submeshes[i];
+            if (part.lod != 0 || (objectVisible && part.object < objectVisible->size() && !(*objectVisible)[part.object]) ||
+                !boxInFrustum(frustum, part.boundsMin, part.boundsMax))
+                continue;
+            // Partes visíveis vizinhas no EBO viram uma só faixa
+            if (!counts.empty() && runEnd == part.firstIndex)
+                counts.back() += (GLsizei)part.indexCount;
+            else
+            {
+                counts.push_back((GLsizei)part.indexCount);
+                offsets.push_back((const GLvoid*)(size_t)(part.firstIndex * indexSize));
+            }
+            runEnd = part.firstIndex + part.indexCount;
+            triangles += (GLsizei)(part.indexCount / 3);
+        }
+        if (counts.empty())
+            continue;
+        bindMaterial(shaderID, mesh.materials[material]);
+        glMultiDrawElements(GL_TRIANGLES, counts.data(), mesh.indexType, offsets.data(), (GLsizei)counts.size());
+    }
+    return triangles;
+}
+
+// Desenha só os meshlets dentro do frustum e não inteiramente de costas para
+// a câmera, com um único glMultiDrawElements (o VAO da malha precisa estar
+// vinculado). Com `part`, só os meshlets dessa submalha do LOD 0. Retorna o
+// número de triângulos enviados.
+GLsizei drawMeshlets(const Mesh &mesh, const glm::mat4 &model, const glm::mat4 &viewProjection, const glm::vec3 &cameraPos,
+                     const Submesh *part = nullptr)
+{
+    // Faixas reaproveitadas entre quadros para não alocar a cada chamada
+    static std::vector<Submesh> ranges;
+    static std::vector<GLsizei> counts;
+    static std::vector<const GLvoid*> offsets;
+
+    // Frustum e câmera levados para o espaço do objeto
+    Frustum frustum = frustumFromMatrix(viewProjection * model);
+    glm::vec3 camera = glm::vec3(glm::inverse(model) * glm::vec4(cameraPos, 1.0f));
+
+    ranges.clear();
+    GLsizei triangles = (GLsizei)cullMeshlets(mesh.meshlets, frustum, camera, ranges);
+    if (part)
+    {
+        // Os meshlets nunca atravessam submalhas, mas faixas vizinhas são
+        // unidas: recorta cada faixa à da submalha
+        size_t kept = 0;
+        uint32_t partEnd = part->firstIndex + part->indexCount;
+        triangles = 0;
+        for (const Submesh &r : ranges)
+        {
+            uint32_t first = std::max(r.firstIndex, part->firstIndex);
+            uint32_t end = std::min(r.firstIndex + r.indexCount, partEnd);
+            if (first >= end)
+                continue;
+            ranges[kept++] = {first, end - first, part->material, 0};
+            triangles += (GLsizei)((end - first) / 3);
+        }
+        ranges.resize(kept);
+    }
+    if (ranges.empty())
+        return 0;
+
+    counts.resize(ranges.size());
+    offsets.resize(ranges.size());
+    GLuint indexSize = indexTypeSize(mesh.indexType);
+    for (size_t i = 0; i < ranges.size(); i++)
+    {
+        counts[i] = (GLsizei)ranges[i].indexCount;
+        offsets[i] = (const GLvoid*)(size_t)(ranges[i].firstIndex * indexSize);
+    }
+    glMultiDrawElements(GL_TRIANGLES, counts.data(), mesh.indexType, offsets.data(), (GLsizei)ranges.size());
+    return triangles;
+}
+
+// Uniforms do quantizedVertexShaderSource (o programa precisa estar em uso)
+void setQuantizationUniforms(GLuint shaderID, const Mesh &mesh)
+{
+    glm::vec3 posExtent = mesh.boundsMax - mesh.boundsMin;
+    glm::vec2 uvExtent = mesh.uvMax - mesh.uvMin;
+    glUniform3fv(glGetUniformLocation(shaderID, "posMin"), 1, glm::value_ptr(mesh.boundsMin));
+    glUniform3fv(glGetUniformLocation(shaderID, "posExtent"), 1, glm::value_ptr(posExtent));
+    glUniform2fv(glGetUniformLocation(shaderID, "uvMin"), 1, glm::value_ptr(mesh.uvMin));
+    glUniform2fv(glGetUniformLocation(shaderID, "uvExtent"), 1, glm::value_ptr(uvExtent));
+}
+
+// Estado de um pedido do AsyncMeshLoader
+enum class AsyncLoadState
+{
+    Loading = 0,   // na fila ou sendo lido em uma thread de trabalho
+    Uploading = 1, // sendo enviado para a GPU, aos poucos, quadro a quadro
+    Ready = 2,     // a malha pode ser desenhada
+    Failed = 3
+};
+
+// Carregamento de .OBJ em segundo plano. As threads de trabalho fazem tudo o
+// que não usa a OpenGL (buildOBJMeshData, ou a cópia do cache, e os .MTL) e
+// entregam o MeshData pronto em uma fila sem travas. A thread da OpenGL
+// chama `update` uma vez por quadro: ela envia os buffers em trechos de
+// UPLOAD_CHUNK_BYTES até esgotar o orçamento de tempo do quadro, então o
+// desenho não trava enquanto os modelos chegam. As texturas dos materiais
+// vêm de um AsyncTextureLoader (decodificadas em outras threads e enviadas
+// por PBOs), ou do TextureStreamer passado ao construtor (que o programa
+// atualiza a cada quadro), e ficam brancas até chegar, mesmo com a malha já
+// pronta. Os pedidos entram por uma fila com mutex, que só as threads de
+// trabalho disputam (o laço de desenho nunca espera por ela).
+// A leitura em fluxo (streamBudget) escreve direto na GPU e não é assíncrona.
+// Destruir o carregador antes de glfwTerminate (o envio em andamento é
+// desfeito); as malhas prontas continuam com quem as usa.
+class AsyncMeshLoader
+{
+public:
+    static constexpr size_t UPLOAD_CHUNK_BYTES = 1 << 20;
+
+    // nThreads = 0 usa todos os núcleos; uma thread costuma bastar, pois a
+    // leitura de cada .OBJ já se divide entre os núcleos (ver ObjParser.h)
+    explicit AsyncMeshLoader(unsigned nThreads = 1, TextureStreamer *streamer = nullptr) : streamer(streamer)
+    {
+        nThreads = resolveThreadCount(nThreads);
+        for (unsigned i = 0; i < nThreads; i++)
+            workers.emplace_back([this]() { work(); });
+    }
+
+    ~AsyncMeshLoader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &w : workers)
+            w.join();
+        if (uploading)
+            discardUpload();
+    }
+
+    AsyncMeshLoader(const AsyncMeshLoader &) = delete;
+    AsyncMeshLoader &operator=(const AsyncMeshLoader &) = delete;
+
+    // Pede o carregamento de um .OBJ. Retorna o identificador do pedido
+    // (para state e mesh), ou -1 se as opções não puderem ser atendidas.
+    int request(const string &filePATH, const OBJLoadOptions &options = OBJLoadOptions())
+    {
+        if (options.streamBudget > 0)
+        {
+            std::cerr << "Erro: a leitura em fluxo de " << filePATH << " nao e assincrona (use loadSimpleOBJ)" << std::endl;
+            return -1;
+        }
+        std::unique_ptr<Job> job(new Job());
+        job->id = (int)states.size();
+        job->path = filePATH;
+        job->options = options;
+        states.push_back(AsyncLoadState::Loading);
+        meshes.emplace_back();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requests.push_back(std::move(job));
+        }
+        wake.notify_one();
+        return (int)states.size() - 1;
+    }
+
+    // Continua os envios para a GPU por até `budgetMs` milissegundos (pelo
+    // menos um trecho por chamada, para sempre avançar). Retorna quantas
+    // malhas ficaram prontas nesta chamada.
+    size_t update(double budgetMs)
+    {
+        auto start = std::chrono::steady_clock::now();
+        size_t completed = 0;
+        do
+        {
+            if (!uploading)
+            {
+                std::unique_ptr<Job> job;
+                if (!finished.pop(job))
+                    break;
+                if (!job->ok)
+                {
+                    states[job->id] = AsyncLoadState::Failed;
+                    continue;
+                }
+                states[job->id] = AsyncLoadState::Uploading;
+                uploading = std::move(job);
+                stage = 0;
+                offset = 0;
+            }
+            if (uploadStep())
+                completed++;
+        } while (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() < budgetMs);
+        // As texturas dos materiais usam o que sobrar do orçamento
+        textures.update(budgetMs - std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        return completed;
+    }
+
+    AsyncLoadState state(int id) const { return states[id]; }
+    bool ready(int id) const { return id >= 0 && states[id] == AsyncLoadState::Ready; }
+
+    // Malha do pedido (só pode ser desenhada depois de ready(id))
+    Mesh &mesh(int id) { return meshes[id]; }
+
+    // Pedidos ainda não prontos nem com erro
+    size_t pending() const
+    {
+        return (size_t)std::count_if(states.begin(), states.end(), [](AsyncLoadState s)
+                                     { return s == AsyncLoadState::Loading || s == AsyncLoadState::Uploading; });
+    }
+
+private:
+    struct Job
+    {
+        int id = 0;
+        string path;
+        OBJLoadOptions options;
+        bool ok = false;
+        MeshData data;
+        std::vector<Material> materials; // sem as texturas (ver findMaterials)
+    };
+
+    // Thread de trabalho: lê os pedidos até o carregador ser destruído
+    void work()
+    {
+        for (;;)
+        {
+            std::unique_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return stopping || !requests.empty(); });
+                if (stopping)
+                    return;
+                job = std::move(requests.front());
+                requests.pop_front();
+            }
+            MeshCacheView cache;
+            if (job->options.useCache && openMatchingMeshCache(job->path, job->options, cache))
+            {
+                job->data = meshDataFromCache(cache);
+                job->ok = true;
+                std::cout << job->path << ": carregado do cache " << meshCachePath(job->path) << std::endl;
+            }
+            else
+                job->ok = buildOBJMeshData(job->path, job->options, job->data);
+            if (job->ok)
+                findMaterials(job->path, job->data.materialLibs, job->data.materialNames, job->materials);
+            finished.push(std::move(job));
+        }
+    }
+
+    // Uma etapa curta do envio atual: criar os buffers, um trecho do VBO ou
+    // do EBO, o pedido de uma textura ou a conclusão. Retorna true quando a malha fica pronta.
+    bool uploadStep()
+    {
+        MeshData &data = uploading->data;
+        Mesh &mesh = meshes[uploading->id];
+        if (stage == 0)
+        {
+            // Buffers no tamanho final, ainda vazios, e os atributos no VAO
+            glGenVertexArrays(1, &mesh.VAO);
+            glBindVertexArray(mesh.VAO);
+            glGenBuffers(1, &mesh.VBO);
+            glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+            glBufferData(GL_ARRAY_BUFFER, data.vertexBytes.size(), nullptr, GL_STATIC_DRAW);
+            glGenBuffers(1, &mesh.EBO);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.indexBytes.size(), nullptr, GL_STATIC_DRAW);
+            for (const VertexAttribute &a : data.attributes)
+            {
+                glVertexAttribPointer(a.location, a.components, a.type, (GLboolean)a.normalized, a.stride, (GLvoid*)(size_t)a.offset);
+                glEnableVertexAttribArray(a.location);
+            }
+            glBindVertexArray(0);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+            stage = 1;
+        }
+        else if (stage == 1 || stage == 2)
+        {
+            // Trechos pelo alvo de cópia, sem mexer no VAO vinculado
+            const std::vector<uint8_t> &bytes = stage == 1 ? data.vertexBytes : data.indexBytes;
+            size_t size = std::min(UPLOAD_CHUNK_BYTES, bytes.size() - offset);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, stage == 1 ? mesh.VBO : mesh.EBO);
+            if (size > 0)
+                glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, bytes.data() + offset);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            offset += size;
+            if (offset == bytes.size())
+            {
+                stage++;
+                offset = 0;
+            }
+        }
+        else if (offset < uploading->materials.size())
+        {
+            Material &material = uploading->materials[offset++];
+            TextureHandle texture = streamer ? streamer->request(material.mapKd) : textures.request(material.mapKd);
+            material.diffuseTexture = texture->id;
+            material.diffuseSampler = texture->samplerObject ? texture->samplerObject->id : 0;
+            mesh.textures.push_back(std::move(texture));
+        }
+        else
+        {
+            mesh.indexType = data.indexType;
+            copyMeshInfo(data, mesh);
+            mesh.materials = std::move(uploading->materials);
+            states[uploading->id] = AsyncLoadState::Ready;
+            uploading.reset();
+            return true;
+        }
+        return false;
+    }
+
+    void discardUpload()
+    {
+        Mesh &mesh = meshes[uploading->id];
+        if (stage > 0)
+        {
+            glDeleteVertexArrays(1, &mesh.VAO);
+            glDeleteBuffers(1, &mesh.VBO);
+            glDeleteBuffers(1, &mesh.EBO);
+        }
+        mesh.textures.clear();
+        states[uploading->id] = AsyncLoadState::Failed;
+        uploading.reset();
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::unique_ptr<Job>> requests; // protegidos por `mutex`
+    bool stopping = false;
+    MpscQueue<std::unique_ptr<Job>> finished;   // das threads de trabalho para update
+    AsyncTextureLoader textures;                // texturas dos materiais
+    TextureStreamer *streamer;                  // no lugar de `textures`, se houver
+
+    // Só na thread da OpenGL
+    std::vector<AsyncLoadState> states;
+    std::deque<Mesh> meshes; // deque: as referências de mesh(id) não mudam com novos pedidos
+    std::unique_ptr<Job> uploading;
+    int stage = 0;      // 0: buffers, 1: VBO, 2: EBO, 3: texturas e conclusão
+    size_t offset = 0;  // bytes enviados do buffer atual, ou texturas carregadas
+};
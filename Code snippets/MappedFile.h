@@ -0,0 +1,142 @@
+/*
+ *  MappedFile - mapeamento de um arquivo inteiro em memória (somente leitura)
+ *
+ *  Usado pelos leitores de .OBJ para tokenizar o arquivo diretamente sobre os
+ *  bytes do disco, sem copiar linha a linha para std::string/istringstream.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  MappedFile file;
+ *  if (file.open("../assets/Modelos3D/Suzanne.obj"))
+ *  {
+ *      const char *begin = file.data();
+ *      const char *end = file.data() + file.size();
+ *      ...
+ *  }
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class MappedFile
+{
+public:
+    MappedFile() {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // Retorna false se o arquivo não puder ser aberto ou mapeado.
+    // Um arquivo vazio é aberto com sucesso, com data() nulo e size() zero.
+    bool open(const std::string &filePath)
+    {
+        close();
+#ifdef _WIN32
+        fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                 OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (fileHandle == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(fileHandle, &fileSize))
+        {
+            close();
+            return false;
+        }
+        length = (size_t)fileSize.QuadPart;
+        if (length == 0)
+            return true;
+
+        mapHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapHandle == NULL)
+        {
+            close();
+            return false;
+        }
+        ptr = (const char *)MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0);
+        if (ptr == nullptr)
+        {
+            close();
+            return false;
+        }
+#else
+        fd = ::open(filePath.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            close();
+            return false;
+        }
+        length = (size_t)st.st_size;
+        if (length == 0)
+            return true;
+
+        void *addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED)
+        {
+            close();
+            return false;
+        }
+        // O arquivo é lido do início ao fim uma única vez
+        madvise(addr, length, MADV_SEQUENTIAL);
+        ptr = (const char *)addr;
+#endif
+        return true;
+    }
+
+    void close()
+    {
+#ifdef _WIN32
+        if (ptr)
+            UnmapViewOfFile(ptr);
+        if (mapHandle)
+            CloseHandle(mapHandle);
+        if (fileHandle != INVALID_HANDLE_VALUE)
+            CloseHandle(fileHandle);
+        mapHandle = NULL;
+        fileHandle = INVALID_HANDLE_VALUE;
+#else
+        if (ptr)
+            munmap((void *)ptr, length);
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+#endif
+        ptr = nullptr;
+        length = 0;
+    }
+
+    const char *data() const { return ptr; }
+    size_t size() const { return length; }
+
+private:
+    const char *ptr = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mapHandle = NULL;
+#else
+    int fd = -1;
+#endif
+};
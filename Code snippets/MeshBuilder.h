@@ -0,0 +1,279 @@
+/*
+ *  MeshBuilder - malha indexada a partir de um ObjData
+ *
+ *  No .OBJ cada canto de face referencia uma tripla (v, vt, vn). Cantos com a
+ *  mesma tripla geram exatamente o mesmo vértice, então eles são soldados
+ *  (deduplicados) através de uma tabela hash: cada tripla distinta vira um
+ *  único MeshVertex e os triângulos passam a ser descritos por índices.
+ *
+ *  Em uma malha fechada como a Suzanne, cada vértice é compartilhado por ~6
+ *  triângulos: o buffer de vértices fica várias vezes menor e o cache de
+ *  vértices pós-transformação da GPU passa a ser aproveitado (glDrawElements).
+ *
+ *  Os triângulos são agrupados por material (`usemtl`) e por objeto (`o`/`g`):
+ *  cada par material/objeto vira uma submalha, uma faixa contínua de índices
+ *  dentro do mesmo buffer. As submalhas ficam em ordem de material e, dentro
+ *  de um material, de objeto: os objetos podem ser escondidos ou descartados
+ *  um a um sem trocar de buffer, e cada material é vinculado uma só vez.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  ObjData obj;
+ *  parseOBJFile("../assets/Modelos3D/Suzanne.obj", obj);
+ *  IndexedMesh mesh = buildIndexedMesh(obj);
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "ObjParser.h"
+
+struct MeshVertex
+{
+    glm::vec3 position;
+    glm::vec2 texCoord;
+    glm::vec3 normal;
+};
+
+// Faixa de índices desenhada com uma única chamada glDrawElements
+struct Submesh
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t material;   // posição em materialNames
+    uint32_t lod;        // nível de detalhe (0 = malha original)
+    uint32_t object = 0; // posição em objectNames
+    glm::vec3 boundsMin = glm::vec3(0.0f); // caixa dos triângulos da faixa (ver computeSubmeshBounds)
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+};
+
+struct IndexedMesh
+{
+    ScratchVector<MeshVertex> vertices;
+    ScratchVector<uint32_t> indices; // 3 por triângulo
+    ScratchVector<Submesh> submeshes;
+    ScratchVector<std::string> materialNames; // na ordem do primeiro `usemtl` ("" = sem material)
+    ScratchVector<std::string> objectNames;   // na ordem do primeiro `o`/`g` ("" = faces antes deles)
+    ScratchVector<glm::vec4> tangents;        // vazio ou um por vértice (ver MeshTangents.h)
+};
+
+struct ObjCornerHash
+{
+    size_t operator()(const ObjCorner &c) const
+    {
+        size_t h = std::hash<int>()(c.v);
+        h ^= std::hash<int>()(c.t) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        h ^= std::hash<int>()(c.n) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+
+struct ObjCornerEqual
+{
+    bool operator()(const ObjCorner &a, const ObjCorner &b) const
+    {
+        return a.v == b.v && a.t == b.t && a.n == b.n;
+    }
+};
+
+struct PositionHash
+{
+    size_t operator()(const glm::vec3 &p) const
+    {
+        uint32_t b[3];
+        std::memcpy(b, &p, sizeof(b));
+        return ((size_t)b[0] * 73856093u) ^ ((size_t)b[1] * 19349663u) ^ ((size_t)b[2] * 83492791u);
+    }
+};
+
+struct PositionEqual
+{
+    bool operator()(const glm::vec3 &a, const glm::vec3 &b) const
+    {
+        return std::memcmp(&a, &b, sizeof(glm::vec3)) == 0;
+    }
+};
+
+// Agrupa os vértices soldados que diferem só em UV/normal (costuras): em
+// `posClass[v]` fica a classe de cada vértice e em `classPos` a posição de
+// cada classe.
+inline void buildPositionClasses(const ScratchVector<MeshVertex> &vertices, ScratchVector<uint32_t> &posClass,
+                                 ScratchVector<glm::vec3> &classPos)
+{
+    posClass.resize(vertices.size());
+    classPos.clear();
+    // Nós da tabela em uma arena própria, devolvida ao fim da função
+    ArenaResource nodes(ARENA_FIRST_BLOCK_BYTES, scratchResource());
+    ScratchHashMap<glm::vec3, uint32_t, PositionHash, PositionEqual> classes(vertices.size(), PositionHash(),
+                                                                             PositionEqual(), &nodes);
+    for (size_t v = 0; v < vertices.size(); v++)
+    {
+        auto it = classes.emplace(vertices[v].position, (uint32_t)classPos.size());
+        if (it.second)
+            classPos.push_back(vertices[v].position);
+        posClass[v] = it.first->second;
+    }
+}
+
+// Busca segura: índice ausente ou fora do intervalo resulta em zero
+template <typename T>
+inline T objAttribute(const ScratchVector<T> &list, int index)
+{
+    return (index >= 0 && index < (int)list.size()) ? list[index] : T(0.0f);
+}
+
+// Reagrupa os triângulos `indices` (em ordem estável) pela etiqueta de cada
+// triângulo, com etiquetas de 0 a nTags - 1. Em `counts` retorna o número de
+// índices de cada etiqueta.
+inline void groupTriangles(ScratchVector<uint32_t> &indices, const ScratchVector<uint32_t> &tags, size_t nTags,
+                           ScratchVector<uint32_t> &counts)
+{
+    counts.assign(nTags, 0);
+    for (uint32_t tag : tags)
+        counts[tag] += 3;
+    ScratchVector<uint32_t> offsets(nTags, 0);
+    for (size_t g = 1; g < nTags; g++)
+        offsets[g] = offsets[g - 1] + counts[g - 1];
+    if (nTags <= 1)
+        return;
+    ScratchVector<uint32_t> grouped(indices.size());
+    for (size_t t = 0; t < tags.size(); t++)
+    {
+        uint32_t &o = offsets[tags[t]];
+        grouped[o] = indices[t * 3];
+        grouped[o + 1] = indices[t * 3 + 1];
+        grouped[o + 2] = indices[t * 3 + 2];
+        o += 3;
+    }
+    indices = std::move(grouped); // move, e não swap: os dois vetores podem usar recursos diferentes
+}
+
+inline IndexedMesh buildIndexedMesh(const ObjData &obj)
+{
+    IndexedMesh mesh;
+    // Nós da tabela em uma arena própria, devolvida ao fim da soldagem
+    ArenaResource nodes(ARENA_FIRST_BLOCK_BYTES, scratchResource());
+    ScratchHashMap<ObjCorner, uint32_t, ObjCornerHash, ObjCornerEqual> welded(obj.corners.size() / 2, ObjCornerHash(),
+                                                                              ObjCornerEqual(), &nodes);
+    mesh.indices.reserve(obj.corners.size());
+
+    for (const ObjCorner &c : obj.corners)
+    {
+        auto it = welded.emplace(c, (uint32_t)mesh.vertices.size());
+        if (it.second)
+        {
+            MeshVertex vertex;
+            vertex.position = objAttribute(obj.vertices, c.v);
+            vertex.texCoord = objAttribute(obj.texCoords, c.t);
+            vertex.normal = objAttribute(obj.normals, c.n);
+            mesh.vertices.push_back(vertex);
+        }
+        mesh.indices.push_back(it.first->second);
+    }
+
+    // Material e objeto de cada triângulo, numerados na ordem do primeiro
+    // `usemtl` e do primeiro `o`/`g`; cada par distinto é uma submalha
+    size_t nTriangles = mesh.indices.size() / 3;
+    ScratchVector<uint32_t> tags(nTriangles, 0);
+    ScratchHashMap<std::string, uint32_t> materialIds, objectIds;
+    ScratchHashMap<uint64_t, uint32_t> pairIds;
+    ScratchVector<uint64_t> pairs; // material << 32 | objeto, por etiqueta
+    size_t range = 0, objectRange = 0;
+    uint32_t material = 0, object = 0, tag = 0;
+    bool changed = true;
+    ObjPartName part;
+    if (obj.materialRanges.empty() || obj.materialRanges[0].firstCorner > 0)
+    {
+        materialIds.emplace("", 0);
+        mesh.materialNames.push_back("");
+    }
+    if (obj.objectRanges.empty() || obj.objectRanges[0].firstCorner > 0)
+    {
+        objectIds.emplace("", 0);
+        mesh.objectNames.push_back("");
+    }
+    for (size_t t = 0; t < nTriangles; t++)
+    {
+        while (range < obj.materialRanges.size() && obj.materialRanges[range].firstCorner <= t * 3)
+        {
+            const std::string &name = obj.materialRanges[range++].name;
+            auto it = materialIds.emplace(name, (uint32_t)mesh.materialNames.size());
+            if (it.second)
+                mesh.materialNames.push_back(name);
+            material = it.first->second;
+            changed = true;
+        }
+        if (objectRange < obj.objectRanges.size() && obj.objectRanges[objectRange].firstCorner <= t * 3)
+        {
+            while (objectRange < obj.objectRanges.size() && obj.objectRanges[objectRange].firstCorner <= t * 3)
+                part.apply(obj.objectRanges[objectRange++]);
+            std::string name = part.name();
+            auto it = objectIds.emplace(name, (uint32_t)mesh.objectNames.size());
+            if (it.second)
+                mesh.objectNames.push_back(name);
+            object = it.first->second;
+            changed = true;
+        }
+        if (changed)
+        {
+            uint64_t key = (uint64_t)material << 32 | object;
+            auto it = pairIds.emplace(key, (uint32_t)pairs.size());
+            if (it.second)
+                pairs.push_back(key);
+            tag = it.first->second;
+            changed = false;
+        }
+        tags[t] = tag;
+    }
+
+    // Etiquetas renumeradas em ordem de material e, dentro dele, de objeto
+    ScratchVector<uint32_t> order(pairs.size()), rank(pairs.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = (uint32_t)i;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return pairs[a] < pairs[b]; });
+    for (size_t i = 0; i < order.size(); i++)
+        rank[order[i]] = (uint32_t)i;
+    for (uint32_t &t : tags)
+        t = rank[t];
+
+    ScratchVector<uint32_t> counts;
+    groupTriangles(mesh.indices, tags, pairs.size(), counts);
+    uint32_t first = 0;
+    for (size_t g = 0; g < counts.size(); g++)
+    {
+        if (counts[g] > 0)
+            mesh.submeshes.push_back({first, counts[g], (uint32_t)(pairs[order[g]] >> 32), 0, (uint32_t)pairs[order[g]]});
+        first += counts[g];
+    }
+    return mesh;
+}
+
+// Caixa envolvente dos triângulos de cada submalha, para o descarte por
+// submalha (chamar depois de qualquer etapa que mude as faixas de índices)
+inline void computeSubmeshBounds(IndexedMesh &mesh)
+{
+    for (Submesh &part : mesh.submeshes)
+    {
+        if (part.indexCount == 0)
+            continue;
+        glm::vec3 lo = mesh.vertices[mesh.indices[part.firstIndex]].position, hi = lo;
+        for (uint32_t i = part.firstIndex; i < part.firstIndex + part.indexCount; i++)
+        {
+            const glm::vec3 &p = mesh.vertices[mesh.indices[i]].position;
+            lo = glm::min(lo, p);
+            hi = glm::max(hi, p);
+        }
+        part.boundsMin = lo;
+        part.boundsMax = hi;
+    }
+}
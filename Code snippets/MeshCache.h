@@ -0,0 +1,464 @@
+/*
+ *  MeshCache - cache binário (.meshbin) das malhas carregadas de .OBJ
+ *
+ *  Na primeira carga, `loadSimpleOBJ` grava ao lado do .OBJ um arquivo
+ *  <nome>.obj.meshbin com os bytes do VBO e do EBO exatamente como foram para
+ *  a GPU. Nas cargas seguintes o .meshbin é mapeado em memória e os bytes vão
+ *  direto para o glBufferData, sem ler texto nem processar vértice a vértice.
+ *
+ *  Layout do arquivo (little-endian, seções alinhadas em 16 bytes)
+ *  -----------------
+ *  MeshBinHeader                           cabeçalho de tamanho fixo
+ *  VertexAttribute[attributeCount]         descrição dos atributos (glVertexAttribPointer)
+ *  bytes do VBO       (vertexSize bytes)   vértices intercalados ou em fluxos separados
+ *  bytes do EBO       (indexSize bytes)    índices de 16 ou 32 bits (indexType)
+ *  Submesh[submeshCount]                   faixas de índices de cada submalha (com material, objeto e AABB)
+ *  MeshLod[lodCount]                       níveis de detalhe (faixas de índices e erro)
+ *  Meshlet[meshletCount]                   grupos do LOD 0 com esfera e cone (se MESHBIN_MESHLETS)
+ *  tabela de textos   (stringSize bytes)   mtllibs, nomes de materiais e de objetos, terminados em '\0'
+ *
+ *  O cache é válido enquanto o .OBJ tiver o mesmo tamanho e a mesma data de
+ *  modificação gravados no cabeçalho. Se só a data mudou (arquivo copiado ou
+ *  "tocado"), o conteúdo é comparado pelo hash gravado e, se for igual, a data
+ *  no cabeçalho é atualizada. Qualquer mudança no formato, ou no processamento
+ *  que gera os dados gravados, incrementa MESHBIN_VERSION, o que invalida os
+ *  caches antigos.
+ *
+ *  Um arquivo corrompido não chega à GPU: além de cada seção caber no
+ *  arquivo, os atributos precisam caber nos bytes do VBO, os índices devem
+ *  ser menores que vertexCount e as faixas das submalhas, dos LODs e dos
+ *  meshlets devem ficar dentro do EBO. Se algo falhar, o cache é ignorado e o
+ *  .OBJ é lido de novo.
+ *
+ *  Os .MTL não entram no cache: só os seus nomes. Eles são lidos de novo a
+ *  cada carga (são pequenos), então editar um material não exige refazer o
+ *  .meshbin.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "MappedFile.h"
+#include "MeshData.h"
+
+const char MESHBIN_MAGIC[8] = {'M', 'E', 'S', 'H', 'B', 'I', 'N', '\0'};
+const uint32_t MESHBIN_VERSION = 10;
+
+// Opções de processamento gravadas em MeshBinHeader::flags
+const uint32_t MESHBIN_MESHLETS = 1;
+const uint32_t MESHBIN_TANGENTS = 2;
+
+struct MeshBinHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+
+    // Identificação do .OBJ de origem
+    uint64_t sourceSize;
+    int64_t sourceMTime;
+    uint64_t sourceHash;
+
+    uint32_t attributeCount;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexType;
+    uint32_t submeshCount;
+    uint32_t layout;     // VertexLayout
+    uint32_t lodCount;
+    uint32_t lodLevels;  // níveis pedidos na geração (podem ter saído menos)
+    uint32_t meshletCount;
+    uint32_t flags;      // MESHBIN_MESHLETS, MESHBIN_TANGENTS
+    uint32_t materialLibCount;
+    uint32_t materialNameCount;
+    uint32_t objectNameCount;
+    float creaseAngle;        // opções da geração de normais (MeshNormals.h)
+    uint32_t normalWeighting;
+    float boundsMin[3];
+    float boundsMax[3];
+    float uvMin[2];
+    float uvMax[2];
+    float uvDensity;
+
+    uint64_t attributesOffset;
+    uint64_t vertexOffset;
+    uint64_t vertexSize;
+    uint64_t indexOffset;
+    uint64_t indexSize;
+    uint64_t submeshOffset;
+    uint64_t lodOffset;
+    uint64_t meshletOffset;
+    uint64_t stringOffset;
+    uint64_t stringSize;
+};
+
+// Tamanho, data de modificação e hash do conteúdo do arquivo de origem
+struct MeshSourceInfo
+{
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t hash = 0;
+};
+
+// Cache aberto: os ponteiros apontam para dentro do arquivo mapeado
+struct MeshCacheView
+{
+    MappedFile file;
+    MeshBinHeader header;
+    std::vector<VertexAttribute> attributes;
+    std::vector<Submesh> submeshes;
+    std::vector<MeshLod> lods;
+    std::vector<Meshlet> meshlets;
+    std::vector<std::string> materialLibs;
+    std::vector<std::string> materialNames;
+    std::vector<std::string> objectNames;
+    const uint8_t *vertexBytes = nullptr;
+    const uint8_t *indexBytes = nullptr;
+};
+
+inline std::string meshCachePath(const std::string &sourcePath)
+{
+    return sourcePath + ".meshbin";
+}
+
+// Hash de 64 bits (FNV-1a aplicado a palavras de 8 bytes)
+inline uint64_t hashBytes(const void *data, size_t size)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint64_t h = 1469598103934665603ull ^ (uint64_t)size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t w;
+        std::memcpy(&w, p + i, 8);
+        h = (h ^ w) * 1099511628211ull;
+        h ^= h >> 29;
+    }
+    for (; i < size; i++)
+        h = (h ^ p[i]) * 1099511628211ull;
+    return h;
+}
+
+inline int64_t fileMTime(const std::string &path)
+{
+    std::error_code ec;
+    std::filesystem::file_time_type t = std::filesystem::last_write_time(path, ec);
+    return ec ? 0 : (int64_t)t.time_since_epoch().count();
+}
+
+inline bool readSourceInfo(const std::string &sourcePath, MeshSourceInfo &info, bool withHash)
+{
+    std::error_code ec;
+    info.size = (uint64_t)std::filesystem::file_size(sourcePath, ec);
+    if (ec)
+        return false;
+    info.mtime = fileMTime(sourcePath);
+    info.hash = 0;
+    if (withHash)
+    {
+        MappedFile source;
+        if (!source.open(sourcePath))
+            return false;
+        info.hash = hashBytes(source.data(), source.size());
+    }
+    return true;
+}
+
+inline uint64_t meshBinAlign(uint64_t offset)
+{
+    return (offset + 15) & ~(uint64_t)15;
+}
+
+template <typename T>
+inline bool meshBinSectionFits(uint64_t offset, uint64_t count, uint64_t fileSize)
+{
+    return offset <= fileSize && count <= (fileSize - offset) / sizeof(T);
+}
+
+// Faixa [first, first + count) dentro de [0, total)
+inline bool meshBinRangeFits(uint64_t first, uint64_t count, uint64_t total)
+{
+    return first <= total && count <= total - first;
+}
+
+// Bytes de um atributo de um vértice (0 para um tipo desconhecido)
+inline uint32_t vertexAttributeBytes(const VertexAttribute &attribute)
+{
+    switch (attribute.type)
+    {
+    case GL_BYTE:
+    case GL_UNSIGNED_BYTE:
+        return attribute.components;
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:
+    case GL_HALF_FLOAT:
+        return 2 * attribute.components;
+    case GL_INT:
+    case GL_UNSIGNED_INT:
+    case GL_FLOAT:
+        return 4 * attribute.components;
+    case GL_INT_2_10_10_10_REV:
+    case GL_UNSIGNED_INT_2_10_10_10_REV:
+        return attribute.components == 4 ? 4 : 0;
+    default:
+        return 0;
+    }
+}
+
+// Maior índice do EBO menor que vertexCount
+template <typename Index>
+inline bool meshBinIndicesFit(const uint8_t *bytes, uint64_t count, uint32_t vertexCount)
+{
+    Index largest = 0;
+    for (uint64_t i = 0; i < count; i++)
+    {
+        Index index;
+        std::memcpy(&index, bytes + i * sizeof(Index), sizeof(Index));
+        largest = std::max(largest, index);
+    }
+    return count == 0 || largest < vertexCount;
+}
+
+// Confere os dados de um cache aberto contra as contagens do cabeçalho
+inline bool meshCacheRangesValid(const MeshCacheView &view)
+{
+    const MeshBinHeader &h = view.header;
+    if ((h.indexType != GL_UNSIGNED_SHORT && h.indexType != GL_UNSIGNED_INT) || h.layout > (uint32_t)VertexLayout::Quantized)
+        return false;
+    for (const VertexAttribute &attribute : view.attributes)
+    {
+        uint32_t bytes = vertexAttributeBytes(attribute);
+        uint64_t stride = attribute.stride != 0 ? attribute.stride : bytes;
+        if (bytes == 0 || attribute.components < 1 || attribute.components > 4 ||
+            (h.vertexCount > 0 && !meshBinRangeFits(attribute.offset, (h.vertexCount - 1) * stride + bytes, h.vertexSize)))
+            return false;
+    }
+    if (!(h.indexType == GL_UNSIGNED_SHORT ? meshBinIndicesFit<uint16_t>(view.indexBytes, h.indexCount, h.vertexCount)
+                                           : meshBinIndicesFit<uint32_t>(view.indexBytes, h.indexCount, h.vertexCount)))
+        return false;
+    for (const Submesh &part : view.submeshes)
+        if (!meshBinRangeFits(part.firstIndex, part.indexCount, h.indexCount) || part.material >= view.materialNames.size() ||
+            part.object >= view.objectNames.size() || part.lod >= h.lodCount)
+            return false;
+    for (const MeshLod &lod : view.lods)
+        if (!meshBinRangeFits(lod.firstIndex, lod.indexCount, h.indexCount))
+            return false;
+    // Os meshlets são do LOD 0
+    uint64_t lod0First = view.lods.empty() ? 0 : view.lods[0].firstIndex;
+    uint64_t lod0Count = view.lods.empty() ? h.indexCount : view.lods[0].indexCount;
+    for (const Meshlet &meshlet : view.meshlets)
+        if (meshlet.firstIndex < lod0First || !meshBinRangeFits(meshlet.firstIndex - lod0First, meshlet.indexCount, lod0Count))
+            return false;
+    return true;
+}
+
+template <typename T>
+inline void meshBinReadSection(const uint8_t *base, uint64_t offset, uint64_t count, std::vector<T> &out)
+{
+    out.resize((size_t)count);
+    if (count > 0)
+        std::memcpy(out.data(), base + offset, (size_t)count * sizeof(T));
+}
+
+// Grava primeiro em um arquivo temporário e só então o renomeia, para que
+// uma gravação interrompida nunca deixe um cache truncado no lugar. O nome
+// temporário é único por gravação: duas threads (ou dois programas) que
+// gravam o cache do mesmo .OBJ não escrevem no mesmo arquivo, e a última a
+// renomear fica no lugar (as duas gravam o mesmo conteúdo).
+// `lodLevels`, `flags`, `creaseAngle` e `normalWeighting` são as opções
+// usadas ao gerar `data`.
+inline bool writeMeshCache(const std::string &cachePath, const MeshData &data, const MeshSourceInfo &source,
+                           uint32_t lodLevels, uint32_t flags, float creaseAngle, uint32_t normalWeighting)
+{
+    MeshBinHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MESHBIN_MAGIC, sizeof(header.magic));
+    header.version = MESHBIN_VERSION;
+    header.headerSize = sizeof(MeshBinHeader);
+    header.sourceSize = source.size;
+    header.sourceMTime = source.mtime;
+    header.sourceHash = source.hash;
+    header.attributeCount = (uint32_t)data.attributes.size();
+    header.vertexCount = data.vertexCount;
+    header.indexCount = data.indexCount;
+    header.indexType = data.indexType;
+    header.submeshCount = (uint32_t)data.submeshes.size();
+    header.layout = (uint32_t)data.layout;
+    header.lodCount = (uint32_t)data.lods.size();
+    header.lodLevels = lodLevels;
+    header.meshletCount = (uint32_t)data.meshlets.size();
+    header.flags = flags;
+    header.creaseAngle = creaseAngle;
+    header.normalWeighting = normalWeighting;
+    for (int i = 0; i < 3; i++)
+    {
+        header.boundsMin[i] = data.boundsMin[i];
+        header.boundsMax[i] = data.boundsMax[i];
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        header.uvMin[i] = data.uvMin[i];
+        header.uvMax[i] = data.uvMax[i];
+    }
+    header.uvDensity = data.uvDensity;
+    header.attributesOffset = meshBinAlign(sizeof(MeshBinHeader));
+    header.vertexOffset = meshBinAlign(header.attributesOffset + data.attributes.size() * sizeof(VertexAttribute));
+    header.vertexSize = data.vertexBytes.size();
+    header.indexOffset = meshBinAlign(header.vertexOffset + header.vertexSize);
+    header.indexSize = data.indexBytes.size();
+    header.submeshOffset = meshBinAlign(header.indexOffset + header.indexSize);
+    header.lodOffset = meshBinAlign(header.submeshOffset + data.submeshes.size() * sizeof(Submesh));
+    header.meshletOffset = meshBinAlign(header.lodOffset + data.lods.size() * sizeof(MeshLod));
+
+    std::string strings;
+    for (const std::string &lib : data.materialLibs)
+        strings.append(lib).push_back('\0');
+    for (const std::string &name : data.materialNames)
+        strings.append(name).push_back('\0');
+    for (const std::string &name : data.objectNames)
+        strings.append(name).push_back('\0');
+    header.materialLibCount = (uint32_t)data.materialLibs.size();
+    header.materialNameCount = (uint32_t)data.materialNames.size();
+    header.objectNameCount = (uint32_t)data.objectNames.size();
+    header.stringOffset = meshBinAlign(header.meshletOffset + data.meshlets.size() * sizeof(Meshlet));
+    header.stringSize = strings.size();
+
+    static std::atomic<uint64_t> writes(0);
+    uint64_t unique = (uint64_t)std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+                      (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+    std::string tmpPath = cachePath + "." + std::to_string(unique) + "-" + std::to_string(writes++) + ".tmp";
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+        return false;
+
+    const char padding[16] = {};
+    auto writeAt = [&](uint64_t offset, const void *bytes, size_t size)
+    {
+        uint64_t pos = (uint64_t)out.tellp();
+        out.write(padding, (std::streamsize)(offset - pos));
+        if (size > 0)
+            out.write((const char *)bytes, (std::streamsize)size);
+    };
+    writeAt(0, &header, sizeof(header));
+    writeAt(header.attributesOffset, data.attributes.data(), data.attributes.size() * sizeof(VertexAttribute));
+    writeAt(header.vertexOffset, data.vertexBytes.data(), data.vertexBytes.size());
+    writeAt(header.indexOffset, data.indexBytes.data(), data.indexBytes.size());
+    writeAt(header.submeshOffset, data.submeshes.data(), data.submeshes.size() * sizeof(Submesh));
+    writeAt(header.lodOffset, data.lods.data(), data.lods.size() * sizeof(MeshLod));
+    writeAt(header.meshletOffset, data.meshlets.data(), data.meshlets.size() * sizeof(Meshlet));
+    writeAt(header.stringOffset, strings.data(), strings.size());
+    out.close();
+    if (!out)
+    {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, cachePath, ec);
+    if (ec)
+    {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Abre o cache de `sourcePath`, se existir e ainda corresponder ao arquivo de
+// origem. Em caso de falha o chamador deve ler o .OBJ normalmente.
+inline bool openMeshCache(const std::string &cachePath, const std::string &sourcePath, MeshCacheView &view)
+{
+    if (!view.file.open(cachePath) || view.file.size() < sizeof(MeshBinHeader))
+        return false;
+
+    MeshBinHeader &h = view.header;
+    std::memcpy(&h, view.file.data(), sizeof(MeshBinHeader));
+    if (std::memcmp(h.magic, MESHBIN_MAGIC, sizeof(h.magic)) != 0 || h.version != MESHBIN_VERSION ||
+        h.headerSize != sizeof(MeshBinHeader))
+        return false;
+
+    // Todas as seções precisam estar dentro do arquivo
+    uint64_t fileSize = view.file.size();
+    if (!meshBinSectionFits<VertexAttribute>(h.attributesOffset, h.attributeCount, fileSize) ||
+        !meshBinSectionFits<uint8_t>(h.vertexOffset, h.vertexSize, fileSize) ||
+        !meshBinSectionFits<uint8_t>(h.indexOffset, h.indexSize, fileSize) ||
+        !meshBinSectionFits<Submesh>(h.submeshOffset, h.submeshCount, fileSize) ||
+        !meshBinSectionFits<MeshLod>(h.lodOffset, h.lodCount, fileSize) ||
+        !meshBinSectionFits<Meshlet>(h.meshletOffset, h.meshletCount, fileSize) ||
+        !meshBinSectionFits<char>(h.stringOffset, h.stringSize, fileSize) ||
+        h.indexSize != (uint64_t)h.indexCount * indexTypeSize(h.indexType))
+        return false;
+
+    MeshSourceInfo source;
+    if (!readSourceInfo(sourcePath, source, false) || source.size != h.sourceSize)
+        return false;
+    if (source.mtime != h.sourceMTime)
+    {
+        if (!readSourceInfo(sourcePath, source, true) || source.hash != h.sourceHash)
+            return false;
+
+        // Mesmo conteúdo com outra data: atualiza só o campo da data no
+        // cabeçalho. O mapeamento (somente leitura) é fechado antes da escrita,
+        // que no Windows ele bloquearia, e refeito depois; se o cabeçalho
+        // mudou nesse intervalo (outro processo gravou o cache), desiste.
+        view.file.close();
+        {
+            std::fstream patch(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+            if (patch.is_open())
+            {
+                patch.seekp(offsetof(MeshBinHeader, sourceMTime));
+                patch.write((const char *)&source.mtime, sizeof(source.mtime));
+            }
+        }
+        if (!view.file.open(cachePath) || view.file.size() != fileSize)
+            return false;
+        MeshBinHeader reopened;
+        std::memcpy(&reopened, view.file.data(), sizeof(MeshBinHeader));
+        reopened.sourceMTime = h.sourceMTime;
+        if (std::memcmp(&reopened, &h, sizeof(MeshBinHeader)) != 0)
+            return false;
+    }
+
+    const uint8_t *base = (const uint8_t *)view.file.data();
+    meshBinReadSection(base, h.attributesOffset, h.attributeCount, view.attributes);
+    meshBinReadSection(base, h.submeshOffset, h.submeshCount, view.submeshes);
+    meshBinReadSection(base, h.lodOffset, h.lodCount, view.lods);
+    meshBinReadSection(base, h.meshletOffset, h.meshletCount, view.meshlets);
+
+    // Tabela de textos: materialLibCount + materialNameCount + objectNameCount textos
+    const char *str = (const char *)base + h.stringOffset, *strEnd = str + h.stringSize;
+    view.materialLibs.clear();
+    view.materialNames.clear();
+    view.objectNames.clear();
+    uint64_t nameEnd = (uint64_t)h.materialLibCount + h.materialNameCount;
+    for (uint64_t i = 0; i < nameEnd + h.objectNameCount; i++)
+    {
+        const char *zero = (const char *)std::memchr(str, '\0', strEnd - str);
+        if (!zero)
+            return false;
+        (i < h.materialLibCount ? view.materialLibs : i < nameEnd ? view.materialNames : view.objectNames).emplace_back(str, zero);
+        str = zero + 1;
+    }
+    view.vertexBytes = base + h.vertexOffset;
+    view.indexBytes = base + h.indexOffset;
+    if (!meshCacheRangesValid(view))
+    {
+        std::cerr << "Aviso: cache " << cachePath << " com faixas invalidas, ignorado" << std::endl;
+        return false;
+    }
+    return true;
+}
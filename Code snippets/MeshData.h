@@ -0,0 +1,138 @@
+/*
+ *  MeshData - malha já no formato que vai para a GPU
+ *
+ *  Guarda os bytes do VBO e do EBO prontos para o glBufferData, junto com a
+ *  descrição dos atributos (o que cada glVertexAttribPointer precisa), as
+ *  faixas de índices de cada submalha (com o seu material, objeto e caixa
+ *  envolvente) e a caixa envolvente (AABB) da malha.
+ *
+ *  É o que `loadSimpleOBJ` envia para a OpenGL e o que o cache binário
+ *  (MeshCache.h) grava em disco.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// GLAD
+#include <glad/glad.h>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "MeshBuilder.h" // Submesh
+
+// Um atributo de vértice, na forma de uma chamada a glVertexAttribPointer.
+// Os campos têm tamanho fixo porque também são gravados no cache binário.
+struct VertexAttribute
+{
+    uint32_t location;   // layout (location = ...) no vertex shader
+    uint32_t components; // 1 a 4
+    uint32_t type;       // GL_FLOAT, GL_HALF_FLOAT, GL_SHORT, ...
+    uint32_t normalized; // GL_TRUE / GL_FALSE
+    uint32_t offset;     // em bytes, a partir do início do VBO
+    uint32_t stride;     // em bytes, entre dois vértices consecutivos
+};
+
+// Nível de detalhe: faixa de índices da malha inteira simplificada e o erro
+// geométrico (em unidades do objeto) em relação ao nível 0
+struct MeshLod
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float error;
+};
+
+// Grupo de até ~64 vértices e ~124 triângulos vizinhos (faixa contínua do EBO)
+// com esfera envolvente e cone de normais, para descarte por grupo na CPU.
+// O cone é "desligado" com coneCutoff > 1 (ver MeshletBuilder.h).
+struct Meshlet
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t vertexCount;
+    float radius;
+    glm::vec3 center;
+    float coneCutoff;
+    glm::vec3 coneAxis;
+    glm::vec3 coneApex;
+};
+
+// Organização dos atributos dentro do VBO
+enum class VertexLayout : uint32_t
+{
+    Interleaved = 0, // todos os atributos de um vértice lado a lado (AoS)
+    Separate = 1,    // um fluxo contínuo por atributo (SoA)
+    Quantized = 2    // intercalado e compactado em 16 bytes (ver VertexQuantization.h)
+};
+
+struct MeshData
+{
+    VertexLayout layout = VertexLayout::Interleaved;
+    std::vector<VertexAttribute> attributes;
+    std::vector<uint8_t> vertexBytes;
+    std::vector<uint8_t> indexBytes;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    uint32_t indexType = GL_UNSIGNED_INT; // GL_UNSIGNED_SHORT ou GL_UNSIGNED_INT
+    std::vector<Submesh> submeshes; // de todos os níveis de detalhe, nível a nível
+    std::vector<std::string> materialNames; // Submesh::material indexa esta lista
+    std::vector<std::string> materialLibs;  // arquivos .MTL, relativos à pasta do .OBJ
+    std::vector<std::string> objectNames;   // Submesh::object indexa esta lista
+    std::vector<MeshLod> lods;
+    std::vector<Meshlet> meshlets; // só do LOD 0, sem atravessar submalhas
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    glm::vec2 uvMin = glm::vec2(0.0f); // retângulo das coordenadas de textura
+    glm::vec2 uvMax = glm::vec2(0.0f);
+    float uvDensity = 0.0f; // unidades de UV por unidade do objeto, no LOD 0 (ver UVAreaSum)
+};
+
+// Soma das áreas dos triângulos no espaço do objeto e no espaço das
+// coordenadas de textura. A raiz da razão é a densidade de UV da malha: com
+// ela e o tamanho da textura, os texels por unidade do objeto (usados pelo
+// TextureStreamer.h para escolher os mipmaps necessários).
+struct UVAreaSum
+{
+    double object = 0.0, uv = 0.0;
+
+    void add(const MeshVertex &a, const MeshVertex &b, const MeshVertex &c)
+    {
+        object += 0.5 * glm::length(glm::cross(b.position - a.position, c.position - a.position));
+        glm::vec2 e1 = b.texCoord - a.texCoord, e2 = c.texCoord - a.texCoord;
+        uv += 0.5 * std::fabs(e1.x * e2.y - e1.y * e2.x);
+    }
+
+    // 0 sem coordenadas de textura
+    float density() const { return object > 0.0 ? (float)std::sqrt(uv / object) : 0.0f; }
+};
+
+// Copia os índices, com 16 bits sempre que os vértices couberem, senão 32 bits
+inline void setMeshIndices(MeshData &data, const ScratchVector<uint32_t> &indices, uint32_t vertexCount)
+{
+    data.indexCount = (uint32_t)indices.size();
+    if (vertexCount <= 65536)
+    {
+        data.indexType = GL_UNSIGNED_SHORT;
+        data.indexBytes.resize(indices.size() * sizeof(uint16_t));
+        uint16_t *dst = (uint16_t *)data.indexBytes.data();
+        for (size_t i = 0; i < indices.size(); i++)
+            dst[i] = (uint16_t)indices[i];
+    }
+    else
+    {
+        data.indexType = GL_UNSIGNED_INT;
+        data.indexBytes.resize(indices.size() * sizeof(uint32_t));
+        if (!indices.empty())
+            std::memcpy(data.indexBytes.data(), indices.data(), data.indexBytes.size());
+    }
+}
+
+inline uint32_t indexTypeSize(uint32_t indexType)
+{
+    return indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+}
@@ -0,0 +1,469 @@
+/*
+ *  MeshNormals - geração de normais para .OBJ sem registros `vn`
+ *
+ *  Sem `vn`, os cantos das faces ficam sem normal (índice -1) e os shaders de
+ *  Phong recebem o vetor nulo. `generateNormals` calcula, para cada canto sem
+ *  normal, a média das normais das faces vizinhas que compartilham o mesmo
+ *  registro `v`:
+ *
+ *  - peso por ângulo do canto (Thürmer e Wüthrich, padrão) ou por área;
+ *  - só entram as faces do mesmo grupo de suavização (`s N`), que é
+ *    suavizado por inteiro, como o modelador definiu; no grupo 0 (`s off`)
+ *    cada face fica com a sua própria normal (facetada);
+ *  - as faces antes de qualquer `s` (arquivos sem grupos, comuns em
+ *    varreduras e CAD) formam um grupo em que as faces cujo ângulo com a face
+ *    do canto passa de `creaseAngle` graus não entram (arestas vivas, como as
+ *    de um cubo).
+ *
+ *  Etapas:
+ *  1. Normal e pesos de cada triângulo, 4 triângulos por vez com SSE2
+ *     (com uma versão escalar equivalente nas outras arquiteturas);
+ *  2. Lista de cantos de cada `v` (formato CSR), montada com contadores
+ *     atômicos e ordenada em seguida;
+ *  3. Para cada `v`, cada canto soma (gather) as faces da lista que passam nos
+ *     testes; nenhuma thread escreve fora dos cantos do seu `v`. Cantos do
+ *     mesmo `v` com normais idênticas passam a compartilhar a mesma normal;
+ *  4. As normais distintas são acrescentadas a obj.normals e os cantos passam
+ *     a apontar para elas, então a soldagem segue sem mudanças.
+ *
+ *  Todas as etapas, e também os grupos de suavização de cada triângulo, rodam
+ *  em paralelo (parallelFor); o resultado não depende do número de threads.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  ObjData obj;
+ *  parseOBJFile("../assets/Modelos3D/Cube.obj", obj, 0);
+ *  size_t generated = generateNormals(obj, 60.0f);  // 0 se todos os cantos já têm normal
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MESH_NORMALS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "ObjParser.h"
+#include "ParallelFor.h"
+
+enum class NormalWeighting
+{
+    Angle = 0, // ângulo do canto: independe de como a face foi triangulada
+    Area = 1   // área do triângulo: faces grandes dominam
+};
+
+// Ângulo padrão acima do qual uma aresta é considerada viva
+const float NORMAL_CREASE_ANGLE = 60.0f;
+// Grupo das faces antes de qualquer registro `s`
+const uint32_t NORMAL_IMPLICIT_GROUP = 0xFFFFFFFFu;
+
+// acos com erro de até 7e-5 rad (Abramowitz e Stegun 4.4.45), mesma conta da
+// versão SSE2
+inline float normalAcos(float x)
+{
+    float a = std::min(std::fabs(x), 1.0f);
+    float r = std::sqrt(1.0f - a) * (1.5707288f + a * (-0.2121144f + a * (0.0742610f + a * -0.0187293f)));
+    return x < 0.0f ? 3.14159265f - r : r;
+}
+
+// Normal unitária e pesos dos 3 cantos de um triângulo
+inline void triangleNormalWeights(const glm::vec3 &p0, const glm::vec3 &p1, const glm::vec3 &p2, NormalWeighting weighting,
+                                  glm::vec3 &normal, float weights[3])
+{
+    glm::vec3 e01 = p1 - p0, e02 = p2 - p0, e12 = p2 - p1;
+    glm::vec3 n = glm::cross(e01, e02);
+    float len = std::sqrt(glm::dot(n, n));
+    if (len <= 0.0f)
+    {
+        normal = glm::vec3(0.0f);
+        weights[0] = weights[1] = weights[2] = 0.0f;
+        return;
+    }
+    normal = n / len;
+    if (weighting == NormalWeighting::Area)
+    {
+        weights[0] = weights[1] = weights[2] = 0.5f * len;
+        return;
+    }
+    float l01 = std::sqrt(glm::dot(e01, e01)), l02 = std::sqrt(glm::dot(e02, e02)), l12 = std::sqrt(glm::dot(e12, e12));
+    weights[0] = normalAcos(glm::dot(e01, e02) / (l01 * l02));
+    weights[1] = normalAcos(-glm::dot(e01, e12) / (l01 * l12));
+    weights[2] = normalAcos(glm::dot(e02, e12) / (l02 * l12));
+}
+
+#ifdef MESH_NORMALS_SSE2
+inline __m128 normalAcos4(__m128 x)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 sign = _mm_cmplt_ps(x, _mm_setzero_ps());
+    __m128 a = _mm_min_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), x), one);
+    __m128 poly = _mm_add_ps(_mm_set1_ps(0.0742610f), _mm_mul_ps(a, _mm_set1_ps(-0.0187293f)));
+    poly = _mm_add_ps(_mm_set1_ps(-0.2121144f), _mm_mul_ps(a, poly));
+    poly = _mm_add_ps(_mm_set1_ps(1.5707288f), _mm_mul_ps(a, poly));
+    __m128 r = _mm_mul_ps(_mm_sqrt_ps(_mm_sub_ps(one, a)), poly);
+    __m128 flipped = _mm_sub_ps(_mm_set1_ps(3.14159265f), r);
+    return _mm_or_ps(_mm_and_ps(sign, flipped), _mm_andnot_ps(sign, r));
+}
+
+inline __m128 dot4(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+}
+#endif
+
+// Normais e pesos dos triângulos [begin, end) de `corners`. Saída em SoA:
+// faceNormals[t] e weights[3 * t + k].
+inline void computeFaceNormals(const ObjData &obj, size_t begin, size_t end, NormalWeighting weighting,
+                               ScratchVector<glm::vec3> &faceNormals, ScratchVector<float> &weights)
+{
+    auto position = [&](const ObjCorner &c)
+    {
+        return c.v >= 0 && (size_t)c.v < obj.vertices.size() ? obj.vertices[c.v] : glm::vec3(0.0f);
+    };
+    size_t t = begin;
+#ifdef MESH_NORMALS_SSE2
+    const bool area = weighting == NormalWeighting::Area;
+    for (; t + 4 <= end; t += 4)
+    {
+        // Posições dos 4 triângulos transpostas para registros x, y e z
+        alignas(16) float px[3][4], py[3][4], pz[3][4];
+        for (int i = 0; i < 4; i++)
+            for (int k = 0; k < 3; k++)
+            {
+                glm::vec3 p = position(obj.corners[(t + i) * 3 + k]);
+                px[k][i] = p.x;
+                py[k][i] = p.y;
+                pz[k][i] = p.z;
+            }
+        __m128 x0 = _mm_load_ps(px[0]), y0 = _mm_load_ps(py[0]), z0 = _mm_load_ps(pz[0]);
+        __m128 e01x = _mm_sub_ps(_mm_load_ps(px[1]), x0), e01y = _mm_sub_ps(_mm_load_ps(py[1]), y0), e01z = _mm_sub_ps(_mm_load_ps(pz[1]), z0);
+        __m128 e02x = _mm_sub_ps(_mm_load_ps(px[2]), x0), e02y = _mm_sub_ps(_mm_load_ps(py[2]), y0), e02z = _mm_sub_ps(_mm_load_ps(pz[2]), z0);
+        __m128 e12x = _mm_sub_ps(e02x, e01x), e12y = _mm_sub_ps(e02y, e01y), e12z = _mm_sub_ps(e02z, e01z);
+
+        __m128 nx = _mm_sub_ps(_mm_mul_ps(e01y, e02z), _mm_mul_ps(e01z, e02y));
+        __m128 ny = _mm_sub_ps(_mm_mul_ps(e01z, e02x), _mm_mul_ps(e01x, e02z));
+        __m128 nz = _mm_sub_ps(_mm_mul_ps(e01x, e02y), _mm_mul_ps(e01y, e02x));
+        __m128 len = _mm_sqrt_ps(dot4(nx, ny, nz, nx, ny, nz));
+        __m128 valid = _mm_cmpgt_ps(len, _mm_setzero_ps());
+        __m128 inv = _mm_and_ps(valid, _mm_div_ps(_mm_set1_ps(1.0f), len));
+
+        __m128 w0, w1, w2;
+        if (area)
+            w0 = w1 = w2 = _mm_mul_ps(_mm_set1_ps(0.5f), len);
+        else
+        {
+            __m128 l01 = _mm_sqrt_ps(dot4(e01x, e01y, e01z, e01x, e01y, e01z));
+            __m128 l02 = _mm_sqrt_ps(dot4(e02x, e02y, e02z, e02x, e02y, e02z));
+            __m128 l12 = _mm_sqrt_ps(dot4(e12x, e12y, e12z, e12x, e12y, e12z));
+            __m128 d0102 = dot4(e01x, e01y, e01z, e02x, e02y, e02z);
+            __m128 d0112 = dot4(e01x, e01y, e01z, e12x, e12y, e12z);
+            __m128 d0212 = dot4(e02x, e02y, e02z, e12x, e12y, e12z);
+            w0 = normalAcos4(_mm_div_ps(d0102, _mm_mul_ps(l01, l02)));
+            w1 = normalAcos4(_mm_div_ps(_mm_sub_ps(_mm_setzero_ps(), d0112), _mm_mul_ps(l01, l12)));
+            w2 = normalAcos4(_mm_div_ps(d0212, _mm_mul_ps(l02, l12)));
+        }
+        w0 = _mm_and_ps(valid, w0);
+        w1 = _mm_and_ps(valid, w1);
+        w2 = _mm_and_ps(valid, w2);
+
+        alignas(16) float ox[4], oy[4], oz[4], ow[3][4];
+        _mm_store_ps(ox, _mm_mul_ps(nx, inv));
+        _mm_store_ps(oy, _mm_mul_ps(ny, inv));
+        _mm_store_ps(oz, _mm_mul_ps(nz, inv));
+        _mm_store_ps(ow[0], w0);
+        _mm_store_ps(ow[1], w1);
+        _mm_store_ps(ow[2], w2);
+        for (int i = 0; i < 4; i++)
+        {
+            faceNormals[t + i] = glm::vec3(ox[i], oy[i], oz[i]);
+            for (int k = 0; k < 3; k++)
+                weights[(t + i) * 3 + k] = ow[k][i];
+        }
+    }
+#endif
+    for (; t < end; t++)
+    {
+        const ObjCorner *c = &obj.corners[t * 3];
+        triangleNormalWeights(position(c[0]), position(c[1]), position(c[2]), weighting, faceNormals[t], &weights[t * 3]);
+    }
+}
+
+// Vetores de trabalho de gatherVertexNormals, reaproveitados entre registros
+struct NormalGatherScratch
+{
+    ScratchVector<glm::vec3> faceN, weighted, normals;
+    ScratchVector<uint32_t> group, slot;
+};
+
+// Normais dos cantos sem normal de um registro `v`, cujos cantos são
+// list[0..k). As normais distintas ficam em scratch.normals e o canto list[a]
+// usa scratch.normals[scratch.slot[a]].
+inline void gatherVertexNormals(const ObjData &obj, const uint32_t *list, size_t k, const ScratchVector<glm::vec3> &faceNormals,
+                                const ScratchVector<float> &weights, const ScratchVector<uint32_t> &groups, float cosCrease,
+                                NormalGatherScratch &scratch)
+{
+    // Dados das faces copiados para perto: a soma de cada canto percorre a lista
+    scratch.faceN.resize(k);
+    scratch.weighted.resize(k);
+    scratch.group.resize(k);
+    scratch.slot.resize(k);
+    scratch.normals.clear();
+    for (size_t a = 0; a < k; a++)
+    {
+        scratch.faceN[a] = faceNormals[list[a] / 3];
+        scratch.weighted[a] = weights[list[a]] * scratch.faceN[a];
+        scratch.group[a] = groups[list[a] / 3];
+    }
+
+    // Caso comum: todas as faces no mesmo grupo e sem aresta viva entre elas,
+    // então todos os cantos têm a mesma soma
+    bool uniform = k > 0 && scratch.group[0] != 0;
+    for (size_t a = 1; a < k && uniform; a++)
+        uniform = scratch.group[a] == scratch.group[0];
+    for (size_t a = 0; a < k && uniform && scratch.group[0] == NORMAL_IMPLICIT_GROUP; a++)
+        for (size_t b = a + 1; b < k && uniform; b++)
+            uniform = glm::dot(scratch.faceN[a], scratch.faceN[b]) >= cosCrease;
+    glm::vec3 shared(0.0f);
+    if (uniform)
+        for (size_t b = 0; b < k; b++)
+            shared += scratch.weighted[b];
+
+    for (size_t a = 0; a < k; a++)
+    {
+        if (obj.corners[list[a]].n >= 0)
+            continue;
+        glm::vec3 sum = shared;
+        if (!uniform && scratch.group[a] == 0)
+            sum = scratch.faceN[a];
+        else if (!uniform)
+            for (size_t b = 0; b < k; b++)
+                if (scratch.group[b] == scratch.group[a] &&
+                    (scratch.group[a] != NORMAL_IMPLICIT_GROUP || glm::dot(scratch.faceN[a], scratch.faceN[b]) >= cosCrease))
+                    sum += scratch.weighted[b];
+        // Soma nula (faces opostas ou degeneradas): fica a normal da face
+        float len = glm::length(sum);
+        glm::vec3 normal = len > 0.0f ? sum / len : scratch.faceN[a];
+
+        uint32_t s = 0;
+        while (s < scratch.normals.size() && scratch.normals[s] != normal)
+            s++;
+        if (s == scratch.normals.size())
+            scratch.normals.push_back(normal);
+        scratch.slot[a] = s;
+    }
+}
+
+// Gera normais para os cantos sem `vn`. Retorna o número de normais
+// acrescentadas a obj.normals (0 se nenhum canto precisava).
+inline size_t generateNormals(ObjData &obj, float creaseAngle = NORMAL_CREASE_ANGLE,
+                              NormalWeighting weighting = NormalWeighting::Angle, unsigned nThreads = 0)
+{
+    size_t nCorners = obj.corners.size() / 3 * 3, nTriangles = nCorners / 3;
+    bool missing = false;
+    for (size_t i = 0; i < nCorners && !missing; i++)
+        missing = obj.corners[i].n < 0;
+    if (!missing)
+        return 0;
+
+    // 1. Normais e pesos das faces
+    ScratchVector<glm::vec3> faceNormals(nTriangles);
+    ScratchVector<float> weights(nCorners);
+    parallelFor(nTriangles, nThreads, [&](size_t begin, size_t end)
+    {
+        computeFaceNormals(obj, begin, end, weighting, faceNormals, weights);
+    });
+
+    // Grupo de suavização de cada triângulo. Cada bloco acha por busca binária
+    // a faixa do seu primeiro triângulo e segue pelas faixas seguintes.
+    const ScratchVector<ObjSmoothingRange> &ranges = obj.smoothingRanges;
+    auto firstTriangle = [&](size_t r) { return std::min((ranges[r].firstCorner + 2) / 3, nTriangles); };
+    ScratchVector<uint32_t> groups(nTriangles);
+    parallelFor(nTriangles, nThreads, [&](size_t begin, size_t end)
+    {
+        size_t r = 0, count = ranges.size();
+        while (count > 0)
+        {
+            size_t half = count / 2;
+            if (firstTriangle(r + half) <= begin)
+            {
+                r += half + 1;
+                count -= half + 1;
+            }
+            else
+                count = half;
+        }
+        // ranges[r - 1] é a última faixa que começa até `begin`
+        for (size_t t = begin; t < end; r++)
+        {
+            size_t next = r < ranges.size() ? std::min(firstTriangle(r), end) : end;
+            std::fill(groups.begin() + t, groups.begin() + next, r > 0 ? ranges[r - 1].group : NORMAL_IMPLICIT_GROUP);
+            t = next;
+        }
+    });
+
+    // 2. Cantos de cada registro `v` (CSR); cantos com `v` inválido ficam de
+    // fora. A contagem e o preenchimento usam contadores atômicos por `v`, e
+    // cada lista é depois ordenada para os cantos ficarem em ordem crescente
+    // qualquer que seja o número de threads.
+    size_t nVertices = obj.vertices.size();
+    ScratchVector<uint32_t> start(nVertices + 1), adjacent(nCorners);
+    // Com um bloco só não há concorrência: load + store custam bem menos que
+    // fetch_add e as listas já saem em ordem
+    const bool concurrent = parallelChunkCount(nCorners, nThreads) > 1;
+    {
+        auto bump = [concurrent](std::atomic<uint32_t> &counter)
+        {
+            if (concurrent)
+                return counter.fetch_add(1, std::memory_order_relaxed);
+            uint32_t value = counter.load(std::memory_order_relaxed);
+            counter.store(value + 1, std::memory_order_relaxed);
+            return value;
+        };
+        ScratchVector<std::atomic<uint32_t>> cursor(nVertices);
+        parallelFor(nCorners, nThreads, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                int v = obj.corners[i].v;
+                if (v >= 0 && (size_t)v < nVertices)
+                    bump(cursor[v]);
+            }
+        });
+
+        // Soma prefixada em dois passos sobre blocos fixos de registros: o
+        // total de cada bloco e depois os inícios dentro de cada bloco
+        const size_t blockSize = 65536;
+        size_t nBlocks = (nVertices + blockSize - 1) / blockSize;
+        ScratchVector<uint32_t> blockStart(nBlocks + 1);
+        parallelFor(nBlocks, nThreads, [&](size_t begin, size_t end)
+        {
+            for (size_t b = begin; b < end; b++)
+            {
+                uint32_t sum = 0;
+                for (size_t v = b * blockSize; v < std::min((b + 1) * blockSize, nVertices); v++)
+                    sum += cursor[v].load(std::memory_order_relaxed);
+                blockStart[b + 1] = sum;
+            }
+        }, 1);
+        for (size_t b = 0; b < nBlocks; b++)
+            blockStart[b + 1] += blockStart[b];
+        parallelFor(nBlocks, nThreads, [&](size_t begin, size_t end)
+        {
+            for (size_t b = begin; b < end; b++)
+            {
+                uint32_t sum = blockStart[b];
+                for (size_t v = b * blockSize; v < std::min((b + 1) * blockSize, nVertices); v++)
+                {
+                    start[v] = sum;
+                    sum += cursor[v].load(std::memory_order_relaxed);
+                    cursor[v].store(0, std::memory_order_relaxed);
+                }
+            }
+        }, 1);
+        start[nVertices] = blockStart[nBlocks];
+
+        parallelFor(nCorners, nThreads, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                int v = obj.corners[i].v;
+                if (v >= 0 && (size_t)v < nVertices)
+                    adjacent[start[v] + bump(cursor[v])] = (uint32_t)i;
+            }
+        });
+    }
+    if (concurrent)
+        parallelFor(nVertices, nThreads, [&](size_t begin, size_t end)
+        {
+            // Listas curtas (a valência do vértice) e quase sempre já em ordem
+            for (size_t v = begin; v < end; v++)
+                for (uint32_t a = start[v] + 1; a < start[v + 1]; a++)
+                    for (uint32_t b = a; b > start[v] && adjacent[b - 1] > adjacent[b]; b--)
+                        std::swap(adjacent[b - 1], adjacent[b]);
+        });
+
+    // 3. Gather por registro `v`. Só a primeira normal distinta de cada `v` é
+    // guardada; os cantos recebem -2 - slot (continuam negativos até a etapa 4).
+    const float cosCrease = std::cos(glm::radians(std::min(std::max(creaseAngle, 0.0f), 180.0f)));
+    ScratchVector<glm::vec3> firstNormal(nVertices);
+    ScratchVector<uint32_t> distinctCount(nVertices + 1, 0);
+    parallelFor(nVertices, nThreads, [&](size_t begin, size_t end)
+    {
+        NormalGatherScratch scratch;
+        for (size_t v = begin; v < end; v++)
+        {
+            const uint32_t *list = adjacent.data() + start[v];
+            gatherVertexNormals(obj, list, start[v + 1] - start[v], faceNormals, weights, groups, cosCrease, scratch);
+            for (size_t a = 0; a < scratch.slot.size(); a++)
+                if (obj.corners[list[a]].n < 0)
+                    obj.corners[list[a]].n = -2 - (int)scratch.slot[a];
+            if (!scratch.normals.empty())
+                firstNormal[v] = scratch.normals[0];
+            distinctCount[v + 1] = (uint32_t)scratch.normals.size();
+        }
+    });
+
+    // 4. Normais distintas no fim de obj.normals, na ordem dos registros `v`.
+    // Os raros `v` com mais de uma normal (arestas vivas, grupos) são refeitos.
+    size_t before = obj.normals.size();
+    for (size_t v = 0; v < nVertices; v++)
+        distinctCount[v + 1] += distinctCount[v];
+    obj.normals.resize(before + distinctCount[nVertices]);
+    parallelFor(nVertices, nThreads, [&](size_t begin, size_t end)
+    {
+        NormalGatherScratch scratch;
+        for (size_t v = begin; v < end; v++)
+        {
+            size_t base = before + distinctCount[v], count = distinctCount[v + 1] - distinctCount[v];
+            if (count == 0)
+                continue;
+            const uint32_t *list = adjacent.data() + start[v];
+            size_t k = start[v + 1] - start[v];
+            if (count == 1)
+                obj.normals[base] = firstNormal[v];
+            else
+            {
+                // Os cantos já marcados contam como sem normal, como na etapa 3
+                gatherVertexNormals(obj, list, k, faceNormals, weights, groups, cosCrease, scratch);
+                std::copy(scratch.normals.begin(), scratch.normals.end(), obj.normals.begin() + base);
+            }
+            for (size_t a = 0; a < k; a++)
+            {
+                ObjCorner &c = obj.corners[list[a]];
+                if (c.n <= -2)
+                    c.n = (int)(base + (size_t)(-2 - c.n));
+            }
+        }
+    });
+
+    // Cantos sem posição válida ficam com a normal da face. São raros: a busca
+    // roda em paralelo e só o acréscimo das normais é serial.
+    std::atomic<bool> invalid(false);
+    parallelFor(nCorners, nThreads, [&](size_t begin, size_t end)
+    {
+        bool found = false;
+        for (size_t i = begin; i < end && !found; i++)
+            found = obj.corners[i].n < 0;
+        if (found)
+            invalid.store(true, std::memory_order_relaxed);
+    });
+    for (size_t i = 0; i < nCorners && invalid.load(); i++)
+    {
+        ObjCorner &c = obj.corners[i];
+        if (c.n < 0)
+        {
+            c.n = (int)obj.normals.size();
+            obj.normals.push_back(faceNormals[i / 3]);
+        }
+    }
+    return obj.normals.size() - before;
+}
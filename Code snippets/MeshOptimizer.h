@@ -0,0 +1,397 @@
+/*
+ *  MeshOptimizer - reordenação de triângulos e vértices de uma IndexedMesh
+ *
+ *  A ordem das faces de um .OBJ exportado é a que o modelador deixou. Depois
+ *  da soldagem, `optimizeMesh` aplica três passos, nesta ordem:
+ *
+ *  1. Cache de vértices: reordena os triângulos com o algoritmo Tipsify
+ *     (Sander, Nehab e Barczak, "Fast Triangle Reordering for Vertex Locality
+ *     and Reduced Overdraw", 2007), para que os vértices recém-transformados
+ *     sejam reaproveitados pelo cache pós-transformação da GPU.
+ *  2. Overdraw: agrupa os triângulos em clusters (nos pontos em que o Tipsify
+ *     precisou "saltar" ou em que o cache é reiniciado sem grande perda) e
+ *     desenha primeiro os clusters mais voltados para fora do objeto, que
+ *     tendem a ocultar os demais e aproveitar melhor o early-z.
+ *  Os passos 1 e 2 são aplicados a cada submalha (material/objeto)
+ *  separadamente, com os vértices da submalha renumerados localmente
+ *  (LocalVertexMap): o custo de cada uma é proporcional ao seu tamanho, e não
+ *  ao da malha inteira, mesmo com milhares de submalhas.
+ *
+ *  3. Busca de vértices: renumera os vértices na ordem em que aparecem no
+ *     buffer de índices, para que a leitura do VBO seja quase sequencial.
+ *
+ *  As métricas usadas são calculadas simulando um cache FIFO:
+ *  ACMR = vértices transformados / triângulos (ideal ~0.5, pior caso 3)
+ *  ATVR = vértices transformados / vértices distintos (ideal 1.0)
+ *
+ *  Forma de uso
+ *  -----------------
+ *  IndexedMesh mesh = buildIndexedMesh(obj);
+ *  MeshOptimizeStats stats;
+ *  optimizeMesh(mesh, &stats);
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "MeshBuilder.h"
+
+// Tamanho do cache pós-transformação simulado (FIFO)
+const int VERTEX_CACHE_SIZE = 16;
+
+struct MeshOptimizeStats
+{
+    float acmrBefore = 0.0f, atvrBefore = 0.0f;
+    float acmrAfter = 0.0f, atvrAfter = 0.0f;
+};
+
+// Numeração local (0, 1, 2, ... na ordem do primeiro uso) dos vértices de
+// uma faixa de índices. Os algoritmos que indexam tabelas pelo vértice rodam
+// sobre a faixa renumerada e custam O(faixa), não O(vértices da malha).
+class LocalVertexMap
+{
+public:
+    explicit LocalVertexMap(size_t vertexCount) : toLocal(vertexCount, ~0u) {}
+
+    // Renumera `indices` no lugar e retorna o número de vértices locais
+    size_t localize(ScratchVector<uint32_t> &indices)
+    {
+        toGlobal.clear();
+        for (uint32_t &v : indices)
+        {
+            uint32_t &local = toLocal[v];
+            if (local == ~0u)
+            {
+                local = (uint32_t)toGlobal.size();
+                toGlobal.push_back(v);
+            }
+            v = local;
+        }
+        for (uint32_t v : toGlobal)
+            toLocal[v] = ~0u;
+        return toGlobal.size();
+    }
+
+    // Volta à numeração da malha (índices da última chamada de localize)
+    void globalize(ScratchVector<uint32_t> &indices) const
+    {
+        for (uint32_t &v : indices)
+            v = toGlobal[v];
+    }
+
+    const ScratchVector<uint32_t> &globalIds() const { return toGlobal; }
+
+private:
+    ScratchVector<uint32_t> toLocal, toGlobal;
+};
+
+// Número de vértices transformados ao desenhar `indices` com um cache FIFO
+inline size_t simulateVertexCache(const ScratchVector<uint32_t> &indices, size_t vertexCount, int cacheSize = VERTEX_CACHE_SIZE)
+{
+    // Guarda o "instante" em que cada vértice entrou no cache
+    ScratchVector<size_t> cachedAt(vertexCount, 0);
+    size_t misses = 0, time = (size_t)cacheSize + 1;
+    for (uint32_t v : indices)
+    {
+        if (time - cachedAt[v] > (size_t)cacheSize)
+        {
+            cachedAt[v] = time++;
+            misses++;
+        }
+    }
+    return misses;
+}
+
+inline float computeACMR(const ScratchVector<uint32_t> &indices, size_t vertexCount, int cacheSize = VERTEX_CACHE_SIZE)
+{
+    if (indices.empty())
+        return 0.0f;
+    return (float)simulateVertexCache(indices, vertexCount, cacheSize) / (float)(indices.size() / 3);
+}
+
+inline float computeATVR(const ScratchVector<uint32_t> &indices, size_t vertexCount, int cacheSize = VERTEX_CACHE_SIZE)
+{
+    ScratchVector<bool> used(vertexCount, false);
+    size_t unique = 0;
+    for (uint32_t v : indices)
+        if (!used[v])
+        {
+            used[v] = true;
+            unique++;
+        }
+    if (unique == 0)
+        return 0.0f;
+    return (float)simulateVertexCache(indices, vertexCount, cacheSize) / (float)unique;
+}
+
+// Tipsify: devolve os triângulos reordenados e, em `clusterStarts`, o primeiro
+// triângulo de cada trecho contínuo (trechos terminam quando o algoritmo
+// chega a um beco sem saída e precisa recomeçar em outro ponto da malha).
+inline ScratchVector<uint32_t> tipsify(const ScratchVector<uint32_t> &indices, size_t vertexCount, int cacheSize,
+                                     ScratchVector<uint32_t> &clusterStarts)
+{
+    size_t nTriangles = indices.size() / 3;
+    ScratchVector<uint32_t> result;
+    result.reserve(indices.size());
+    clusterStarts.clear();
+
+    // Lista de triângulos de cada vértice (formato CSR)
+    ScratchVector<uint32_t> live(vertexCount, 0), adjStart(vertexCount + 1, 0), adjacency(indices.size());
+    for (uint32_t v : indices)
+        live[v]++;
+    for (size_t v = 0; v < vertexCount; v++)
+        adjStart[v + 1] = adjStart[v] + live[v];
+    ScratchVector<uint32_t> fill(adjStart.begin(), adjStart.end() - 1);
+    for (size_t i = 0; i < indices.size(); i++)
+        adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+
+    ScratchVector<size_t> cachedAt(vertexCount, 0);
+    ScratchVector<bool> emitted(nTriangles, false);
+    ScratchVector<uint32_t> deadEnd, candidates;
+    size_t time = (size_t)cacheSize + 1;
+    size_t cursor = 0;
+    int fanning = vertexCount > 0 ? 0 : -1;
+    bool newCluster = true;
+
+    while (fanning >= 0)
+    {
+        candidates.clear();
+        for (uint32_t a = adjStart[fanning]; a < adjStart[fanning + 1]; a++)
+        {
+            uint32_t t = adjacency[a];
+            if (emitted[t])
+                continue;
+            if (newCluster)
+            {
+                clusterStarts.push_back((uint32_t)(result.size() / 3));
+                newCluster = false;
+            }
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t v = indices[t * 3 + k];
+                result.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if (time - cachedAt[v] > (size_t)cacheSize)
+                    cachedAt[v] = time++;
+            }
+            emitted[t] = true;
+        }
+
+        // Próximo vértice: o candidato que ainda terá seus triângulos no cache
+        // quando for usado, preferindo o que está no cache há mais tempo
+        int next = -1, best = -1;
+        for (uint32_t v : candidates)
+        {
+            if (live[v] == 0)
+                continue;
+            int priority = 0;
+            if (time - cachedAt[v] + 2 * live[v] <= (size_t)cacheSize)
+                priority = (int)(time - cachedAt[v]);
+            if (priority > best)
+            {
+                best = priority;
+                next = (int)v;
+            }
+        }
+
+        if (next < 0)
+        {
+            // Beco sem saída: tenta os vértices recentes e depois a ordem original
+            while (!deadEnd.empty() && next < 0)
+            {
+                uint32_t d = deadEnd.back();
+                deadEnd.pop_back();
+                if (live[d] > 0)
+                    next = (int)d;
+            }
+            while (next < 0 && cursor < vertexCount)
+            {
+                if (live[cursor] > 0)
+                    next = (int)cursor;
+                cursor++;
+            }
+            newCluster = true;
+        }
+        fanning = next;
+    }
+    return result;
+}
+
+// Divide cada trecho do Tipsify em clusters menores sempre que o ACMR local
+// (com o cache "zerado" no início do cluster) já está abaixo de
+// threshold * ACMR global: cortar ali quase não custa transformações extras.
+inline ScratchVector<uint32_t> splitClusters(const ScratchVector<uint32_t> &indices, size_t vertexCount,
+                                           const ScratchVector<uint32_t> &hardStarts, int cacheSize, float threshold)
+{
+    size_t nTriangles = indices.size() / 3;
+    float globalACMR = computeACMR(indices, vertexCount, cacheSize);
+    ScratchVector<uint32_t> starts;
+    ScratchVector<size_t> cachedAt(vertexCount, 0);
+    size_t time = (size_t)cacheSize + 1;
+
+    for (size_t c = 0; c < hardStarts.size(); c++)
+    {
+        size_t end = c + 1 < hardStarts.size() ? hardStarts[c + 1] : nTriangles;
+        size_t start = hardStarts[c], misses = 0;
+        starts.push_back((uint32_t)start);
+        time += cacheSize + 1; // esvazia o cache simulado
+        for (size_t t = start; t < end; t++)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t v = indices[t * 3 + k];
+                if (time - cachedAt[v] > (size_t)cacheSize)
+                {
+                    cachedAt[v] = time++;
+                    misses++;
+                }
+            }
+            size_t count = t + 1 - start;
+            if (t + 1 < end && (float)misses / (float)count <= threshold * globalACMR)
+            {
+                start = t + 1;
+                misses = 0;
+                starts.push_back((uint32_t)start);
+                time += cacheSize + 1;
+            }
+        }
+    }
+    return starts;
+}
+
+// Ordena os clusters pelo "potencial de oclusão" (Sander et al.): o produto
+// escalar entre (centroide do cluster - centroide da malha) e a normal média
+// do cluster. Clusters voltados para fora são desenhados primeiro.
+inline ScratchVector<uint32_t> sortClustersForOverdraw(const ScratchVector<uint32_t> &indices, const ScratchVector<MeshVertex> &vertices,
+                                                     const ScratchVector<uint32_t> &clusterStarts)
+{
+    size_t nTriangles = indices.size() / 3, nClusters = clusterStarts.size();
+    ScratchVector<glm::vec3> clusterCenter(nClusters, glm::vec3(0.0f)), clusterNormal(nClusters, glm::vec3(0.0f));
+    ScratchVector<float> clusterArea(nClusters, 0.0f);
+    glm::vec3 meshCenter(0.0f);
+    float meshArea = 0.0f;
+
+    for (size_t c = 0; c < nClusters; c++)
+    {
+        size_t end = c + 1 < nClusters ? clusterStarts[c + 1] : nTriangles;
+        for (size_t t = clusterStarts[c]; t < end; t++)
+        {
+            glm::vec3 p0 = vertices[indices[t * 3]].position;
+            glm::vec3 p1 = vertices[indices[t * 3 + 1]].position;
+            glm::vec3 p2 = vertices[indices[t * 3 + 2]].position;
+            glm::vec3 n = glm::cross(p1 - p0, p2 - p0); // |n| = 2 * área
+            float area = glm::length(n);
+            glm::vec3 center = (p0 + p1 + p2) / 3.0f;
+            clusterCenter[c] += center * area;
+            clusterNormal[c] += n;
+            clusterArea[c] += area;
+            meshCenter += center * area;
+            meshArea += area;
+        }
+    }
+    if (meshArea > 0.0f)
+        meshCenter /= meshArea;
+
+    ScratchVector<float> potential(nClusters, 0.0f);
+    for (size_t c = 0; c < nClusters; c++)
+    {
+        if (clusterArea[c] > 0.0f)
+            clusterCenter[c] /= clusterArea[c];
+        float len = glm::length(clusterNormal[c]);
+        if (len > 0.0f)
+            potential[c] = glm::dot(clusterCenter[c] - meshCenter, clusterNormal[c] / len);
+    }
+
+    ScratchVector<uint32_t> order(nClusters);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return potential[a] > potential[b]; });
+
+    ScratchVector<uint32_t> result;
+    result.reserve(indices.size());
+    for (uint32_t c : order)
+    {
+        size_t end = c + 1 < nClusters ? clusterStarts[c + 1] : nTriangles;
+        result.insert(result.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + end * 3);
+    }
+    return result;
+}
+
+// Renumera os vértices na ordem do primeiro uso; vértices não referenciados
+// por nenhum triângulo são descartados
+inline void optimizeVertexFetch(IndexedMesh &mesh)
+{
+    const uint32_t unused = ~0u;
+    ScratchVector<uint32_t> remap(mesh.vertices.size(), unused);
+    ScratchVector<MeshVertex> vertices;
+    vertices.reserve(mesh.vertices.size());
+    for (uint32_t &v : mesh.indices)
+    {
+        if (remap[v] == unused)
+        {
+            remap[v] = (uint32_t)vertices.size();
+            vertices.push_back(mesh.vertices[v]);
+        }
+        v = remap[v];
+    }
+    mesh.vertices = std::move(vertices);
+}
+
+// overdrawThreshold: quanto o ACMR pode piorar (ex.: 1.05 = 5%) para permitir
+// clusters menores, que dão mais liberdade à ordenação contra overdraw
+inline void optimizeMesh(IndexedMesh &mesh, MeshOptimizeStats *stats = nullptr, float overdrawThreshold = 1.05f)
+{
+    size_t vertexCount = mesh.vertices.size();
+    float acmrBefore = computeACMR(mesh.indices, vertexCount);
+    if (stats)
+    {
+        stats->acmrBefore = acmrBefore;
+        stats->atvrBefore = computeATVR(mesh.indices, vertexCount);
+    }
+
+    // Cada submalha é reordenada separadamente, sem misturar faixas
+    ScratchVector<Submesh> parts = mesh.submeshes;
+    if (parts.empty())
+        parts.push_back({0, (uint32_t)mesh.indices.size(), 0, 0});
+    LocalVertexMap local(vertexCount);
+    ScratchVector<MeshVertex> partVertices;
+    for (const Submesh &part : parts)
+    {
+        if (part.lod != 0)
+            continue;
+        auto first = mesh.indices.begin() + part.firstIndex;
+        ScratchVector<uint32_t> original(first, first + part.indexCount);
+        size_t partVertexCount = local.localize(original);
+        partVertices.clear();
+        for (uint32_t v : local.globalIds())
+            partVertices.push_back(mesh.vertices[v]);
+
+        ScratchVector<uint32_t> hardStarts;
+        ScratchVector<uint32_t> ordered = tipsify(original, partVertexCount, VERTEX_CACHE_SIZE, hardStarts);
+        ScratchVector<uint32_t> clusters = splitClusters(ordered, partVertexCount, hardStarts, VERTEX_CACHE_SIZE, overdrawThreshold);
+        ScratchVector<uint32_t> sorted = sortClustersForOverdraw(ordered, partVertices, clusters);
+
+        // Em malhas sem coerência espacial (muitos clusters minúsculos) a ordenação
+        // contra overdraw poderia deixar o cache pior que o original: nesse caso
+        // fica apenas a ordem do Tipsify
+        if (computeACMR(sorted, partVertexCount) <= computeACMR(original, partVertexCount))
+            ordered.swap(sorted);
+        local.globalize(ordered);
+        std::copy(ordered.begin(), ordered.end(), first);
+    }
+    optimizeVertexFetch(mesh);
+
+    if (stats)
+    {
+        stats->acmrAfter = computeACMR(mesh.indices, mesh.vertices.size());
+        stats->atvrAfter = computeATVR(mesh.indices, mesh.vertices.size());
+    }
+}
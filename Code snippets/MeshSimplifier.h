@@ -0,0 +1,394 @@
+/*
+ *  MeshSimplifier - simplificação por métrica de erro quádrico e níveis de detalhe
+ *
+ *  `simplifyMesh` reduz o número de triângulos de uma IndexedMesh colapsando
+ *  arestas (Garland e Heckbert, "Surface Simplification Using Quadric Error
+ *  Metrics", 1997). Cada posição acumula a quádrica dos planos dos triângulos
+ *  vizinhos (ponderados pela área) e cada colapso move uma posição para a
+ *  outra ponta da aresta, escolhendo sempre o de menor erro. Como o destino é
+ *  sempre um vértice já existente, o VBO não muda: cada nível é apenas uma
+ *  nova lista de índices.
+ *
+ *  `buildLodChain` gera a cadeia de níveis (LOD 0 = malha original), cada um
+ *  com um limite de erro em unidades do objeto. `selectLod` escolhe, para um
+ *  objeto na tela, o nível mais simples cujo erro projetado fica abaixo de
+ *  um limite em pixels.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  std::vector<MeshLod> lods = buildLodChain(mesh, 5);   // acrescenta os índices em mesh.indices
+ *  ...
+ *  int level = selectLod(lods, scale, distance, projScale, 1.0f);
+ *  glDrawElements(GL_TRIANGLES, lods[level].indexCount, indexType, offset de lods[level].firstIndex);
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "MeshBuilder.h"
+#include "MeshData.h"
+#include "MeshOptimizer.h"
+
+// Peso dos planos que prendem as arestas de borda (evita que buracos e
+// contornos abertos "encolham" durante a simplificação)
+const double SIMPLIFY_BORDER_WEIGHT = 10.0;
+
+// Quádrica simétrica 4x4 (10 coeficientes) e a soma dos pesos acumulados
+struct Quadric
+{
+    double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0, w = 0;
+
+    void addPlane(const glm::vec3 &n, double d, double weight)
+    {
+        double a = n.x, b = n.y, c = n.z;
+        a2 += weight * a * a; ab += weight * a * b; ac += weight * a * c; ad += weight * a * d;
+        b2 += weight * b * b; bc += weight * b * c; bd += weight * b * d;
+        c2 += weight * c * c; cd += weight * c * d; d2 += weight * d * d;
+        w += weight;
+    }
+
+    void add(const Quadric &q)
+    {
+        a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad; b2 += q.b2;
+        bc += q.bc; bd += q.bd; c2 += q.c2; cd += q.cd; d2 += q.d2; w += q.w;
+    }
+
+    // Soma ponderada das distâncias ao quadrado de p até os planos
+    double eval(const glm::vec3 &p) const
+    {
+        double x = p.x, y = p.y, z = p.z;
+        double e = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x + b2 * y * y + 2 * bc * y * z +
+                   2 * bd * y + c2 * z * z + 2 * cd * z + d2;
+        return e > 0 ? e : 0;
+    }
+};
+
+// Simplifica os triângulos `indices` (que referenciam mesh.vertices) até no
+// máximo `targetIndexCount` índices ou até o erro atingir `maxError`. Vértices
+// com a mesma posição (costuras de UV/normal) colapsam juntos. Em `outError`
+// retorna o erro do nível gerado, em unidades do objeto. `triangleTags`
+// (opcional) tem uma etiqueta por triângulo, como o material: é filtrada junto
+// com os triângulos e as fronteiras entre etiquetas são preservadas como bordas.
+inline ScratchVector<uint32_t> simplifyMesh(const IndexedMesh &mesh, const ScratchVector<uint32_t> &indices,
+                                          size_t targetIndexCount, float maxError = 1e30f, float *outError = nullptr,
+                                          ScratchVector<uint32_t> *triangleTags = nullptr)
+{
+    const ScratchVector<MeshVertex> &vertices = mesh.vertices;
+    size_t nVertices = vertices.size();
+
+    // Classes de posição: vértices soldados que diferem só em UV/normal
+    ScratchVector<uint32_t> posClass;
+    ScratchVector<glm::vec3> classPos;
+    buildPositionClasses(vertices, posClass, classPos);
+    size_t nClasses = classPos.size();
+
+    // Vértices de cada classe (formato CSR)
+    ScratchVector<uint32_t> classStart(nClasses + 1, 0), classVertices(nVertices);
+    for (size_t v = 0; v < nVertices; v++)
+        classStart[posClass[v] + 1]++;
+    for (size_t c = 0; c < nClasses; c++)
+        classStart[c + 1] += classStart[c];
+    {
+        ScratchVector<uint32_t> fill(classStart.begin(), classStart.end() - 1);
+        for (size_t v = 0; v < nVertices; v++)
+            classVertices[fill[posClass[v]]++] = (uint32_t)v;
+    }
+
+    // Quádricas dos planos dos triângulos
+    ScratchVector<Quadric> quadrics(nClasses);
+    for (size_t t = 0; t + 2 < indices.size(); t += 3)
+    {
+        glm::vec3 p0 = vertices[indices[t]].position, p1 = vertices[indices[t + 1]].position, p2 = vertices[indices[t + 2]].position;
+        glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+        float len = glm::length(n);
+        if (len <= 0.0f)
+            continue;
+        n = n / len;
+        double d = -glm::dot(n, p0);
+        for (int k = 0; k < 3; k++)
+            quadrics[posClass[indices[t + k]]].addPlane(n, d, 0.5 * len);
+    }
+
+    // Arestas de borda (usadas por um único triângulo ou entre etiquetas
+    // diferentes): plano perpendicular ao triângulo passando pela aresta
+    {
+        struct Edge { uint32_t a, b, tri; };
+        ScratchVector<Edge> edges;
+        edges.reserve(indices.size());
+        for (size_t t = 0; t + 2 < indices.size(); t += 3)
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t a = posClass[indices[t + k]], b = posClass[indices[t + (k + 1) % 3]];
+                if (a != b)
+                    edges.push_back({std::min(a, b), std::max(a, b), (uint32_t)(t / 3)});
+            }
+        std::sort(edges.begin(), edges.end(), [](const Edge &x, const Edge &y) { return x.a != y.a ? x.a < y.a : x.b < y.b; });
+        for (size_t i = 0; i < edges.size();)
+        {
+            size_t j = i;
+            bool border = false;
+            while (j < edges.size() && edges[j].a == edges[i].a && edges[j].b == edges[i].b)
+            {
+                if (triangleTags && (*triangleTags)[edges[j].tri] != (*triangleTags)[edges[i].tri])
+                    border = true;
+                j++;
+            }
+            if (j - i == 1 || border)
+            {
+                uint32_t t = edges[i].tri * 3;
+                glm::vec3 p0 = vertices[indices[t]].position, p1 = vertices[indices[t + 1]].position, p2 = vertices[indices[t + 2]].position;
+                glm::vec3 faceN = glm::cross(p1 - p0, p2 - p0);
+                glm::vec3 e = classPos[edges[i].b] - classPos[edges[i].a];
+                glm::vec3 n = glm::cross(e, faceN);
+                float len = glm::length(n);
+                if (len > 0.0f)
+                {
+                    n = n / len;
+                    double d = -glm::dot(n, classPos[edges[i].a]);
+                    double weight = SIMPLIFY_BORDER_WEIGHT * glm::dot(e, e);
+                    quadrics[edges[i].a].addPlane(n, d, weight);
+                    quadrics[edges[i].b].addPlane(n, d, weight);
+                }
+            }
+            i = j;
+        }
+    }
+
+    ScratchVector<uint32_t> result = indices;
+    ScratchVector<uint32_t> classRemap(nClasses);
+    ScratchVector<uint32_t> vertexRemap(nVertices);
+    ScratchVector<uint32_t> triStart(nClasses + 1), triList;
+    ScratchVector<bool> touched(nClasses);
+    double maxCost = 0.0, maxAllowed = (double)maxError * (double)maxError;
+
+    struct Collapse { uint32_t from, to; double cost; };
+    ScratchVector<Collapse> candidates;
+
+    while (result.size() > targetIndexCount)
+    {
+        size_t nTris = result.size() / 3;
+
+        // Triângulos de cada classe (formato CSR)
+        std::fill(triStart.begin(), triStart.end(), 0);
+        for (uint32_t v : result)
+            triStart[posClass[v] + 1]++;
+        for (size_t c = 0; c < nClasses; c++)
+            triStart[c + 1] += triStart[c];
+        triList.resize(result.size());
+        {
+            ScratchVector<uint32_t> fill(triStart.begin(), triStart.end() - 1);
+            for (size_t i = 0; i < result.size(); i++)
+                triList[fill[posClass[result[i]]]++] = (uint32_t)(i / 3);
+        }
+
+        // Melhor sentido de colapso de cada aresta
+        candidates.clear();
+        for (size_t t = 0; t < nTris; t++)
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t a = posClass[result[t * 3 + k]], b = posClass[result[t * 3 + (k + 1) % 3]];
+                if (a >= b)
+                    continue; // cada aresta é avaliada a partir da menor classe
+                Quadric q = quadrics[a];
+                q.add(quadrics[b]);
+                double w = q.w > 0 ? q.w : 1.0;
+                double costAB = q.eval(classPos[b]) / w, costBA = q.eval(classPos[a]) / w;
+                if (costAB <= costBA)
+                    candidates.push_back({a, b, costAB});
+                else
+                    candidates.push_back({b, a, costBA});
+            }
+        std::sort(candidates.begin(), candidates.end(), [](const Collapse &x, const Collapse &y) { return x.cost < y.cost; });
+
+        size_t trisToRemove = nTris - targetIndexCount / 3;
+        size_t removed = 0;
+        bool any = false;
+        std::fill(touched.begin(), touched.end(), false);
+        for (size_t c = 0; c < nClasses; c++)
+            classRemap[c] = (uint32_t)c;
+
+        for (const Collapse &col : candidates)
+        {
+            if (removed >= trisToRemove || col.cost > maxAllowed)
+                break;
+            if (touched[col.from] || touched[col.to])
+                continue;
+
+            // Rejeita colapsos que invertem algum triângulo vizinho
+            bool flips = false;
+            size_t collapsing = 0;
+            for (uint32_t i = triStart[col.from]; i < triStart[col.from + 1] && !flips; i++)
+            {
+                uint32_t t = triList[i] * 3;
+                uint32_t c0 = posClass[result[t]], c1 = posClass[result[t + 1]], c2 = posClass[result[t + 2]];
+                if (c0 == col.to || c1 == col.to || c2 == col.to)
+                {
+                    collapsing++;
+                    continue;
+                }
+                glm::vec3 p0 = classPos[c0], p1 = classPos[c1], p2 = classPos[c2];
+                glm::vec3 before = glm::cross(p1 - p0, p2 - p0);
+                if (c0 == col.from) p0 = classPos[col.to];
+                if (c1 == col.from) p1 = classPos[col.to];
+                if (c2 == col.from) p2 = classPos[col.to];
+                glm::vec3 after = glm::cross(p1 - p0, p2 - p0);
+                if (glm::dot(before, after) <= 0.0f)
+                    flips = true;
+            }
+            if (flips)
+                continue;
+
+            // Trava o anel de vizinhos: as verificações acima valem só para as
+            // posições atuais deles
+            for (uint32_t i = triStart[col.from]; i < triStart[col.from + 1]; i++)
+                for (int k = 0; k < 3; k++)
+                    touched[posClass[result[triList[i] * 3 + k]]] = true;
+            touched[col.to] = true;
+
+            classRemap[col.from] = col.to;
+            quadrics[col.to].add(quadrics[col.from]);
+            maxCost = std::max(maxCost, col.cost);
+            removed += collapsing;
+            any = true;
+        }
+        if (!any)
+            break;
+
+        // Cada vértice de uma classe colapsada vai para o vértice da classe de
+        // destino com atributos (UV e normal) mais parecidos
+        for (size_t v = 0; v < nVertices; v++)
+        {
+            vertexRemap[v] = (uint32_t)v;
+            uint32_t from = posClass[v], to = classRemap[from];
+            if (to == from)
+                continue;
+            float best = 1e30f;
+            for (uint32_t i = classStart[to]; i < classStart[to + 1]; i++)
+            {
+                const MeshVertex &cand = vertices[classVertices[i]];
+                glm::vec2 duv = cand.texCoord - vertices[v].texCoord;
+                glm::vec3 dn = cand.normal - vertices[v].normal;
+                float dist = glm::dot(duv, duv) + glm::dot(dn, dn);
+                if (dist < best)
+                {
+                    best = dist;
+                    vertexRemap[v] = classVertices[i];
+                }
+            }
+        }
+
+        // Aplica os colapsos e descarta os triângulos degenerados
+        size_t out = 0;
+        for (size_t t = 0; t < nTris; t++)
+        {
+            uint32_t i0 = vertexRemap[result[t * 3]], i1 = vertexRemap[result[t * 3 + 1]], i2 = vertexRemap[result[t * 3 + 2]];
+            uint32_t c0 = posClass[i0], c1 = posClass[i1], c2 = posClass[i2];
+            if (c0 == c1 || c1 == c2 || c0 == c2)
+                continue;
+            if (triangleTags)
+                (*triangleTags)[out / 3] = (*triangleTags)[t];
+            result[out++] = i0;
+            result[out++] = i1;
+            result[out++] = i2;
+        }
+        result.resize(out);
+        if (triangleTags)
+            triangleTags->resize(out / 3);
+    }
+
+    if (outError)
+        *outError = (float)std::sqrt(maxCost);
+    return result;
+}
+
+// Gera até `maxLevels` níveis de detalhe, cada um com ~`ratio` dos triângulos
+// do anterior, e acrescenta os índices de cada nível ao fim de mesh.indices.
+// O nível 0 é a malha original. Cada nível é simplificado a partir do anterior
+// e o seu erro é acumulado (limite conservador em relação à original). Os
+// triângulos de cada nível ficam agrupados nas submalhas (material/objeto) do
+// nível 0, com as submalhas do nível acrescentadas a mesh.submeshes.
+inline std::vector<MeshLod> buildLodChain(IndexedMesh &mesh, int maxLevels, float ratio = 0.5f, size_t minTriangles = 64)
+{
+    std::vector<MeshLod> lods;
+    lods.push_back({0, (uint32_t)mesh.indices.size(), 0.0f});
+
+    // Submalha (material/objeto) de cada triângulo do nível 0
+    ScratchVector<Submesh> baseParts;
+    for (const Submesh &part : mesh.submeshes)
+        if (part.lod == 0)
+            baseParts.push_back(part);
+    if (baseParts.empty())
+        baseParts.push_back({0, (uint32_t)mesh.indices.size(), 0, 0});
+    size_t nParts = baseParts.size();
+    ScratchVector<uint32_t> tags(mesh.indices.size() / 3, 0);
+    for (size_t p = 0; p < nParts; p++)
+        std::fill(tags.begin() + baseParts[p].firstIndex / 3,
+                  tags.begin() + (baseParts[p].firstIndex + baseParts[p].indexCount) / 3, (uint32_t)p);
+
+    LocalVertexMap local(mesh.vertices.size());
+    ScratchVector<uint32_t> current = mesh.indices;
+    float error = 0.0f;
+    for (int level = 1; level < maxLevels; level++)
+    {
+        size_t target = (size_t)(current.size() / 3 * ratio) * 3;
+        if (target / 3 < minTriangles)
+            break;
+
+        float levelError = 0.0f;
+        ScratchVector<uint32_t> levelTags = tags;
+        ScratchVector<uint32_t> simplified = simplifyMesh(mesh, current, target, 1e30f, &levelError, &levelTags);
+        // Sem progresso significativo: não vale um nível a mais
+        if (simplified.size() > current.size() * 9 / 10)
+            break;
+
+        ScratchVector<uint32_t> counts;
+        groupTriangles(simplified, levelTags, nParts, counts);
+        uint32_t levelFirst = (uint32_t)mesh.indices.size(), first = 0;
+        for (size_t p = 0; p < nParts; p++)
+        {
+            if (counts[p] == 0)
+                continue;
+            ScratchVector<uint32_t> group(simplified.begin() + first, simplified.begin() + first + counts[p]);
+            ScratchVector<uint32_t> clusterStarts;
+            size_t groupVertexCount = local.localize(group);
+            group = tipsify(group, groupVertexCount, VERTEX_CACHE_SIZE, clusterStarts);
+            local.globalize(group);
+            mesh.submeshes.push_back({(uint32_t)mesh.indices.size(), counts[p], baseParts[p].material, (uint32_t)level,
+                                      baseParts[p].object});
+            mesh.indices.insert(mesh.indices.end(), group.begin(), group.end());
+            first += counts[p];
+        }
+
+        error += levelError;
+        lods.push_back({levelFirst, (uint32_t)simplified.size(), error});
+        current.assign(mesh.indices.begin() + levelFirst, mesh.indices.end());
+        tags.clear();
+        for (size_t p = 0; p < nParts; p++)
+            tags.insert(tags.end(), counts[p] / 3, (uint32_t)p);
+    }
+    return lods;
+}
+
+// projScale = altura da viewport em pixels / (2 * tan(fovy / 2)).
+// Escolhe o nível mais simples cujo erro, projetado a `distance` da câmera,
+// não passa de `maxPixels`.
+inline int selectLod(const std::vector<MeshLod> &lods, float objectScale, float distance, float projScale, float maxPixels)
+{
+    distance = std::max(distance, 1e-4f);
+    for (int i = (int)lods.size() - 1; i > 0; i--)
+    {
+        float pixels = lods[i].error * objectScale / distance * projScale;
+        if (pixels <= maxPixels)
+            return i;
+    }
+    return 0;
+}
@@ -0,0 +1,468 @@
+/*
+ *  MeshTangents - espaço tangente para mapas de normais (semelhante ao MikkTSpace)
+ *
+ *  Um mapa de normais guarda as normais no espaço tangente de cada texel: o
+ *  eixo T acompanha a coordenada s da textura, B acompanha t e N é a normal
+ *  do vértice. Para que o relevo "assado" em outro programa (Blender,
+ *  Substance, xNormal) apareça igual aqui, a tangente tem de ser calculada
+ *  pelas mesmas regras do programa que gerou o mapa. Esses programas usam o
+ *  MikkTSpace (Morten Mikkelsen), e `generateTangents` reimplementa as suas
+ *  regras. A saída ainda não foi comparada com a implementação de referência
+ *  (mikktspace.c): os grupos, as duplicações de vértices e o sinal em w podem
+ *  diferir dela em casos que não foram testados.
+ *
+ *  1. Os vértices com mesma posição, normal e UV são tratados como um só;
+ *  2. Cada triângulo tem as direções de s e t calculadas das derivadas das
+ *     UVs e a orientação (UVs no sentido horário ou anti-horário). Triângulos
+ *     com dois cantos na mesma posição são degenerados e triângulos sem área
+ *     em UV entram em qualquer grupo;
+ *  3. Em cada vértice, os triângulos ligados por arestas e com a mesma
+ *     orientação formam um grupo (UVs espelhadas ficam em grupos separados);
+ *  4. A tangente do grupo é a média das direções de s projetadas no plano da
+ *     normal, com peso pelo ângulo do canto, somadas em ordem crescente de
+ *     triângulo. O sinal da bitangente é a orientação do grupo:
+ *     B = sinal * cross(N, T).
+ *
+ *  Os passos 2 e 4 rodam em paralelo (por triângulo e por vértice) e o
+ *  resultado não depende do número de threads. Só os vértices cujos
+ *  triângulos sem área em UV dependem da ordem global (a mesma do MikkTSpace)
+ *  são processados na thread atual. Quando os cantos de um mesmo vértice
+ *  recebem tangentes diferentes, o vértice é duplicado.
+ *
+ *  No VBO, a tangente vai na localização 3 em GL_INT_2_10_10_10_REV (4
+ *  bytes): x e y com a tangente em codificação octaédrica (snorm10) e w com o
+ *  sinal da bitangente. No vertex shader, a tangente é decodificada como a
+ *  normal do formato quantizado (octDecode, ver VertexQuantization.h) e a
+ *  bitangente é sinal * cross(N, T).
+ *
+ *  Forma de uso
+ *  -----------------
+ *  OBJLoadOptions options;
+ *  options.tangents = true;
+ *  loadSimpleOBJ("../assets/Modelos3D/Suzanne.obj", mesh, options);
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "MeshBuilder.h"
+#include "ParallelFor.h"
+#include "VertexQuantization.h" // octEncode / quantizeOctahedral
+
+// Estados de um triângulo (as mesmas marcas do MikkTSpace)
+const uint32_t TANGENT_DEGENERATE = 1;        // dois cantos na mesma posição
+const uint32_t TANGENT_GROUP_WITH_ANY = 2;    // UVs sem área: entra no primeiro grupo que o alcança
+const uint32_t TANGENT_ORIENT_PRESERVING = 4; // UVs no mesmo sentido das posições
+
+// Ângulo entre as direções de s acima do qual os triângulos de um grupo não
+// são somados juntos (180 = sempre somados, o padrão do MikkTSpace)
+const float TANGENT_ANGULAR_THRESHOLD = 180.0f;
+
+// Tangente dos cantos que nenhum grupo alcança
+const glm::vec4 TANGENT_DEFAULT = glm::vec4(1.0f, 0.0f, 0.0f, -1.0f);
+
+struct TangentTriangle
+{
+    uint32_t vertex[3]; // vértices soldados por valor
+    int neighbor[3];    // triângulo do outro lado da aresta (vertex[i], vertex[i + 1]) ou -1
+    glm::vec3 os, ot;   // direções de s e t (unitárias se a área em UV não for nula)
+    uint32_t flags;
+};
+
+// Aritmética na mesma ordem do MikkTSpace (sem reordenar somas), para tentar
+// reproduzir o resultado dele bit a bit
+inline float mikkDot(const glm::vec3 &a, const glm::vec3 &b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+inline glm::vec3 mikkScale(float s, const glm::vec3 &v)
+{
+    return glm::vec3(s * v.x, s * v.y, s * v.z);
+}
+
+inline bool mikkNotZero(float x)
+{
+    return std::fabs(x) > FLT_MIN;
+}
+
+inline bool mikkNotZero(const glm::vec3 &v)
+{
+    return mikkNotZero(v.x) || mikkNotZero(v.y) || mikkNotZero(v.z);
+}
+
+inline glm::vec3 mikkNormalize(const glm::vec3 &v)
+{
+    return mikkScale(1.0f / std::sqrt(mikkDot(v, v)), v);
+}
+
+// Componente de v perpendicular a n, unitária se não for nula
+inline glm::vec3 mikkProject(const glm::vec3 &n, const glm::vec3 &v)
+{
+    glm::vec3 p = v - mikkScale(mikkDot(n, v), n);
+    return mikkNotZero(p) ? mikkNormalize(p) : p;
+}
+
+// Igualdade por valor de posição, normal e UV (0 e -0 são iguais; FNV-1a
+// sobre os bits)
+struct TangentVertexHash
+{
+    size_t operator()(const MeshVertex &v) const
+    {
+        const float f[8] = {v.position.x, v.position.y, v.position.z, v.texCoord.x, v.texCoord.y,
+                            v.normal.x, v.normal.y, v.normal.z};
+        uint64_t h = 0;
+        for (float x : f)
+        {
+            uint32_t bits;
+            x += 0.0f;
+            std::memcpy(&bits, &x, sizeof(bits));
+            h = (h ^ bits) * 0x100000001B3ull;
+        }
+        return (size_t)(h ^ (h >> 29));
+    }
+};
+
+struct TangentVertexEqual
+{
+    bool operator()(const MeshVertex &a, const MeshVertex &b) const
+    {
+        return a.position == b.position && a.texCoord == b.texCoord && a.normal == b.normal;
+    }
+};
+
+// Direções de s e t, orientação e degeneração de um triângulo
+inline void initTangentTriangle(const ScratchVector<MeshVertex> &vertices, TangentTriangle &tri)
+{
+    const MeshVertex &a = vertices[tri.vertex[0]], &b = vertices[tri.vertex[1]], &c = vertices[tri.vertex[2]];
+    tri.os = tri.ot = glm::vec3(0.0f);
+    tri.neighbor[0] = tri.neighbor[1] = tri.neighbor[2] = -1;
+    tri.flags = TANGENT_GROUP_WITH_ANY;
+    if (a.position == b.position || a.position == c.position || b.position == c.position)
+    {
+        tri.flags |= TANGENT_DEGENERATE;
+        return;
+    }
+
+    float t21x = b.texCoord.x - a.texCoord.x, t21y = b.texCoord.y - a.texCoord.y;
+    float t31x = c.texCoord.x - a.texCoord.x, t31y = c.texCoord.y - a.texCoord.y;
+    glm::vec3 d1 = b.position - a.position, d2 = c.position - a.position;
+    float signedArea = t21x * t31y - t21y * t31x;
+    glm::vec3 os = mikkScale(t31y, d1) - mikkScale(t21y, d2);
+    glm::vec3 ot = mikkScale(-t31x, d1) + mikkScale(t21x, d2);
+
+    if (signedArea > 0.0f)
+        tri.flags |= TANGENT_ORIENT_PRESERVING;
+    if (mikkNotZero(signedArea))
+    {
+        float absArea = std::fabs(signedArea);
+        float lenOs = std::sqrt(mikkDot(os, os)), lenOt = std::sqrt(mikkDot(ot, ot));
+        float sign = signedArea > 0.0f ? 1.0f : -1.0f;
+        if (mikkNotZero(lenOs))
+            tri.os = mikkScale(sign / lenOs, os);
+        if (mikkNotZero(lenOt))
+            tri.ot = mikkScale(sign / lenOt, ot);
+        if (mikkNotZero(lenOs / absArea) && mikkNotZero(lenOt / absArea))
+            tri.flags &= ~TANGENT_GROUP_WITH_ANY;
+    }
+}
+
+// Vetores de trabalho da montagem de grupos, reaproveitados entre vértices
+struct TangentGroupScratch
+{
+    ScratchVector<uint32_t> stack, members, subgroup;
+    ScratchVector<glm::vec3> os, ot;
+    ScratchVector<uint32_t> subgroupMembers, subgroupStart; // subgrupos já calculados, em sequência
+    ScratchVector<glm::vec3> subgroupTangents;
+};
+
+// Tangente de um subgrupo (EvalTspace do MikkTSpace): média das direções de s
+// projetadas, com peso pelo ângulo do canto em `vertex`
+inline glm::vec3 evalGroupTangent(const ScratchVector<MeshVertex> &vertices, const ScratchVector<TangentTriangle> &tris,
+                                  const ScratchVector<uint32_t> &members, uint32_t vertex)
+{
+    glm::vec3 sum(0.0f);
+    for (uint32_t f : members)
+    {
+        const TangentTriangle &tri = tris[f];
+        if (tri.flags & TANGENT_GROUP_WITH_ANY)
+            continue;
+        int i = tri.vertex[0] == vertex ? 0 : tri.vertex[1] == vertex ? 1 : 2;
+        const glm::vec3 &n = vertices[vertex].normal;
+        glm::vec3 os = mikkProject(n, tri.os);
+
+        const glm::vec3 &p0 = vertices[tri.vertex[i > 0 ? i - 1 : 2]].position;
+        const glm::vec3 &p1 = vertices[tri.vertex[i]].position;
+        const glm::vec3 &p2 = vertices[tri.vertex[i < 2 ? i + 1 : 0]].position;
+        glm::vec3 v1 = mikkProject(n, p0 - p1), v2 = mikkProject(n, p2 - p1);
+        float cosAngle = std::min(std::max(mikkDot(v1, v2), -1.0f), 1.0f);
+        float angle = (float)std::acos((double)cosAngle);
+        sum = sum + mikkScale(angle, os);
+    }
+    return mikkNotZero(sum) ? mikkNormalize(sum) : sum;
+}
+
+// Monta o grupo que começa no canto `seed` (Build4RuleGroups/AssignRecur do
+// MikkTSpace) e grava a tangente de cada canto do grupo. `cornerGroup` marca
+// os cantos já agrupados com o canto semente do seu grupo.
+inline void buildTangentGroup(const ScratchVector<MeshVertex> &vertices, ScratchVector<TangentTriangle> &tris, uint32_t seed,
+                              float thresholdCos, ScratchVector<int64_t> &cornerGroup, ScratchVector<glm::vec4> &cornerTangent,
+                              TangentGroupScratch &scratch)
+{
+    uint32_t vertex = tris[seed / 3].vertex[seed % 3];
+    bool orient = (tris[seed / 3].flags & TANGENT_ORIENT_PRESERVING) != 0;
+
+    // Triângulos ligados ao canto semente por arestas que tocam o vértice
+    scratch.members.clear();
+    scratch.stack.assign(1, seed / 3);
+    while (!scratch.stack.empty())
+    {
+        uint32_t f = scratch.stack.back();
+        scratch.stack.pop_back();
+        TangentTriangle &tri = tris[f];
+        int i = tri.vertex[0] == vertex ? 0 : tri.vertex[1] == vertex ? 1 : 2;
+        if (cornerGroup[f * 3 + i] >= 0)
+            continue;
+        if ((tri.flags & TANGENT_GROUP_WITH_ANY) && cornerGroup[f * 3] < 0 && cornerGroup[f * 3 + 1] < 0 &&
+            cornerGroup[f * 3 + 2] < 0)
+        {
+            // O primeiro grupo a alcançar um triângulo sem área em UV define a sua orientação
+            tri.flags = orient ? tri.flags | TANGENT_ORIENT_PRESERVING : tri.flags & ~TANGENT_ORIENT_PRESERVING;
+        }
+        if (((tri.flags & TANGENT_ORIENT_PRESERVING) != 0) != orient)
+            continue;
+        cornerGroup[f * 3 + i] = seed;
+        scratch.members.push_back(f);
+        if (tri.neighbor[i] >= 0)
+            scratch.stack.push_back((uint32_t)tri.neighbor[i]);
+        if (tri.neighbor[i > 0 ? i - 1 : 2] >= 0)
+            scratch.stack.push_back((uint32_t)tri.neighbor[i > 0 ? i - 1 : 2]);
+    }
+    std::sort(scratch.members.begin(), scratch.members.end());
+
+    // Direções de s e t de cada triângulo projetadas no plano da normal
+    const glm::vec3 &n = vertices[vertex].normal;
+    size_t k = scratch.members.size();
+    scratch.os.resize(k);
+    scratch.ot.resize(k);
+    for (size_t a = 0; a < k; a++)
+    {
+        scratch.os[a] = mikkProject(n, tris[scratch.members[a]].os);
+        scratch.ot[a] = mikkProject(n, tris[scratch.members[a]].ot);
+    }
+
+    // Cada triângulo soma os do grupo com direções próximas às suas (todos,
+    // com o limite de 180°); subgrupos iguais são calculados uma vez só
+    scratch.subgroupMembers.clear();
+    scratch.subgroupStart.assign(1, 0);
+    scratch.subgroupTangents.clear();
+    float sign = orient ? 1.0f : -1.0f;
+    for (size_t a = 0; a < k; a++)
+    {
+        uint32_t f = scratch.members[a];
+        scratch.subgroup.clear();
+        for (size_t b = 0; b < k; b++)
+        {
+            uint32_t t = scratch.members[b];
+            bool any = ((tris[f].flags | tris[t].flags) & TANGENT_GROUP_WITH_ANY) != 0;
+            if (any || f == t ||
+                (mikkDot(scratch.os[a], scratch.os[b]) > thresholdCos && mikkDot(scratch.ot[a], scratch.ot[b]) > thresholdCos))
+                scratch.subgroup.push_back(t);
+        }
+        size_t s = 0, nSubgroups = scratch.subgroupTangents.size();
+        for (; s < nSubgroups; s++)
+        {
+            const uint32_t *first = scratch.subgroupMembers.data() + scratch.subgroupStart[s];
+            size_t count = scratch.subgroupStart[s + 1] - scratch.subgroupStart[s];
+            if (count == scratch.subgroup.size() && std::equal(scratch.subgroup.begin(), scratch.subgroup.end(), first))
+                break;
+        }
+        if (s == nSubgroups)
+        {
+            scratch.subgroupMembers.insert(scratch.subgroupMembers.end(), scratch.subgroup.begin(), scratch.subgroup.end());
+            scratch.subgroupStart.push_back((uint32_t)scratch.subgroupMembers.size());
+            scratch.subgroupTangents.push_back(evalGroupTangent(vertices, tris, scratch.subgroup, vertex));
+        }
+        const TangentTriangle &tri = tris[f];
+        int i = tri.vertex[0] == vertex ? 0 : tri.vertex[1] == vertex ? 1 : 2;
+        cornerTangent[f * 3 + i] = glm::vec4(scratch.subgroupTangents[s], sign);
+    }
+}
+
+// Gera mesh.tangents (xyz = tangente, w = sinal da bitangente) para os
+// triângulos dos primeiros `baseIndexCount` índices (o LOD 0). Vértices cujos
+// cantos recebem tangentes diferentes são duplicados e os índices do LOD 0
+// passam a apontar para as cópias; os demais níveis usam a tangente do
+// vértice original. Retorna o número de vértices duplicados.
+inline size_t generateTangents(IndexedMesh &mesh, size_t baseIndexCount, unsigned nThreads = 0)
+{
+    const ScratchVector<MeshVertex> &vertices = mesh.vertices;
+    size_t nVertices = vertices.size();
+    size_t nTriangles = std::min(baseIndexCount, mesh.indices.size()) / 3, nCorners = nTriangles * 3;
+
+    // 1. Soldagem por valor: vertex[] dos triângulos usa o primeiro vértice
+    // igual (tabela hash com endereçamento aberto; quase todos os vértices já
+    // são distintos, então a tabela guarda só índices)
+    const uint32_t NONE = 0xFFFFFFFFu;
+    ScratchVector<uint32_t> weld(nVertices);
+    {
+        size_t tableSize = 16;
+        while (tableSize < nVertices * 2)
+            tableSize *= 2;
+        ScratchVector<uint32_t> table(tableSize, NONE);
+        TangentVertexHash hash;
+        TangentVertexEqual equal;
+        for (size_t v = 0; v < nVertices; v++)
+        {
+            size_t slot = hash(vertices[v]) & (tableSize - 1);
+            while (table[slot] != NONE && !equal(vertices[table[slot]], vertices[v]))
+                slot = (slot + 1) & (tableSize - 1);
+            if (table[slot] == NONE)
+                table[slot] = (uint32_t)v;
+            weld[v] = table[slot];
+        }
+    }
+
+    // 2. Direções de s e t de cada triângulo
+    ScratchVector<TangentTriangle> tris(nTriangles);
+    parallelFor(nTriangles, nThreads, [&](size_t begin, size_t end)
+    {
+        for (size_t f = begin; f < end; f++)
+        {
+            for (int i = 0; i < 3; i++)
+                tris[f].vertex[i] = weld[mesh.indices[f * 3 + i]];
+            initTangentTriangle(vertices, tris[f]);
+        }
+    });
+
+    // Cantos não degenerados de cada vértice soldado (CSR, em ordem crescente)
+    ScratchVector<uint32_t> start(nVertices + 1, 0), adjacent;
+    for (size_t c = 0; c < nCorners; c++)
+        if (!(tris[c / 3].flags & TANGENT_DEGENERATE))
+            start[tris[c / 3].vertex[c % 3] + 1]++;
+    for (size_t v = 0; v < nVertices; v++)
+        start[v + 1] += start[v];
+    adjacent.resize(start[nVertices]);
+    {
+        ScratchVector<uint32_t> fill(start.begin(), start.end() - 1);
+        for (size_t c = 0; c < nCorners; c++)
+            if (!(tris[c / 3].flags & TANGENT_DEGENERATE))
+                adjacent[fill[tris[c / 3].vertex[c % 3]]++] = (uint32_t)c;
+    }
+
+    // Vizinhos: o triângulo de menor índice com a mesma aresta no sentido contrário
+    parallelFor(nTriangles, nThreads, [&](size_t begin, size_t end)
+    {
+        for (size_t f = begin; f < end; f++)
+        {
+            if (tris[f].flags & TANGENT_DEGENERATE)
+                continue;
+            for (int i = 0; i < 3; i++)
+            {
+                uint32_t a = tris[f].vertex[i], b = tris[f].vertex[i < 2 ? i + 1 : 0];
+                for (uint32_t j = start[b]; j < start[b + 1] && tris[f].neighbor[i] < 0; j++)
+                {
+                    uint32_t c = adjacent[j], u = c / 3;
+                    if (u != f && tris[u].vertex[c % 3 < 2 ? c % 3 + 1 : 0] == a)
+                        tris[f].neighbor[i] = (int)u;
+                }
+            }
+        }
+    });
+
+    // 3. e 4. Grupos e tangentes por vértice soldado. Os vértices com triângulos
+    // sem área em UV ficam para o fim, na ordem global de cantos.
+    const float thresholdCos = (float)std::cos((TANGENT_ANGULAR_THRESHOLD * 3.14159265f) / 180.0f);
+    ScratchVector<int64_t> cornerGroup(nCorners, -1);
+    ScratchVector<glm::vec4> cornerTangent(nCorners, TANGENT_DEFAULT);
+    ScratchVector<uint8_t> deferred(nVertices, 0);
+    parallelFor(nVertices, nThreads, [&](size_t begin, size_t end)
+    {
+        TangentGroupScratch scratch;
+        for (size_t v = begin; v < end; v++)
+        {
+            bool any = false;
+            for (uint32_t j = start[v]; j < start[v + 1] && !any; j++)
+                any = (tris[adjacent[j] / 3].flags & TANGENT_GROUP_WITH_ANY) != 0;
+            if (any)
+            {
+                deferred[v] = 1;
+                continue;
+            }
+            for (uint32_t j = start[v]; j < start[v + 1]; j++)
+                if (cornerGroup[adjacent[j]] < 0)
+                    buildTangentGroup(vertices, tris, adjacent[j], thresholdCos, cornerGroup, cornerTangent, scratch);
+        }
+    });
+    {
+        TangentGroupScratch scratch;
+        for (size_t c = 0; c < nCorners; c++)
+        {
+            const TangentTriangle &tri = tris[c / 3];
+            if (!(tri.flags & (TANGENT_DEGENERATE | TANGENT_GROUP_WITH_ANY)) && deferred[tri.vertex[c % 3]] &&
+                cornerGroup[c] < 0)
+                buildTangentGroup(vertices, tris, (uint32_t)c, thresholdCos, cornerGroup, cornerTangent, scratch);
+        }
+    }
+
+    // Triângulos degenerados copiam a tangente do primeiro canto válido do mesmo vértice
+    for (size_t c = 0; c < nCorners; c++)
+    {
+        uint32_t v = tris[c / 3].vertex[c % 3];
+        if ((tris[c / 3].flags & TANGENT_DEGENERATE) && start[v] < start[v + 1])
+            cornerTangent[c] = cornerTangent[adjacent[start[v]]];
+    }
+
+    // Uma tangente por vértice: cantos com tangentes diferentes ganham cópias
+    // do vértice (encadeadas por nextCopy)
+    mesh.tangents.assign(nVertices, TANGENT_DEFAULT);
+    ScratchVector<uint8_t> assigned(nVertices, 0);
+    ScratchVector<uint32_t> nextCopy(nVertices, NONE);
+    for (size_t c = 0; c < nCorners; c++)
+    {
+        uint32_t v = mesh.indices[c];
+        const glm::vec4 &t = cornerTangent[c];
+        if (!assigned[v])
+        {
+            assigned[v] = 1;
+            mesh.tangents[v] = t;
+            continue;
+        }
+        uint32_t u = v;
+        while (mesh.tangents[u] != t && nextCopy[u] != NONE)
+            u = nextCopy[u];
+        if (mesh.tangents[u] != t)
+        {
+            uint32_t copy = (uint32_t)mesh.vertices.size();
+            MeshVertex vertex = mesh.vertices[v];
+            mesh.vertices.push_back(vertex);
+            mesh.tangents.push_back(t);
+            nextCopy.push_back(NONE);
+            nextCopy[u] = copy;
+            u = copy;
+        }
+        mesh.indices[c] = u;
+    }
+    return mesh.vertices.size() - nVertices;
+}
+
+// Tangente e sinal -> GL_INT_2_10_10_10_REV: x e y com a tangente
+// octaédrica em snorm10, z sem uso e w com o sinal da bitangente (-1 ou 1)
+inline uint32_t packTangent(const glm::vec4 &tangent)
+{
+    glm::vec3 t(tangent);
+    float len = glm::length(t);
+    int q[2];
+    quantizeOctahedral(len > 0.0f ? t / len : glm::vec3(1.0f, 0.0f, 0.0f), 511.0f, q);
+    uint32_t w = tangent.w < 0.0f ? 3u : 1u;
+    return ((uint32_t)q[0] & 0x3FFu) | (((uint32_t)q[1] & 0x3FFu) << 10) | (w << 30);
+}
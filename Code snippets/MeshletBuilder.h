@@ -0,0 +1,363 @@
+/*
+ *  MeshletBuilder - divisão da malha em grupos (meshlets) e descarte por grupo
+ *
+ *  `buildMeshlets` reagrupa os triângulos de uma faixa do EBO em meshlets de
+ *  até MESHLET_MAX_VERTICES vértices e MESHLET_MAX_TRIANGLES triângulos. Cada
+ *  meshlet cresce a partir de um triângulo, sempre pelo vizinho que traz menos
+ *  vértices novos e cuja normal mais se aproxima da média do grupo. Os
+ *  triângulos de um meshlet ficam contíguos no EBO, então cada meshlet é
+ *  desenhado como uma faixa de índices.
+ *
+ *  Cada meshlet guarda uma esfera envolvente e um cone com as normais de todos
+ *  os seus triângulos. `cullMeshlets` descarta, antes de desenhar, os meshlets
+ *  fora do frustum (teste da esfera contra os 6 planos) e os que estão
+ *  inteiramente de costas para a câmera (teste do cone). Em uma malha fechada
+ *  cerca de metade dos triângulos está de costas em qualquer ponto de vista.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  ScratchVector<Meshlet> meshlets = buildMeshlets(mesh, 0, (uint32_t)mesh.indices.size());
+ *  ...
+ *  Frustum frustum = frustumFromMatrix(projection * view * model);  // planos no espaço do objeto
+ *  glm::vec3 camera = glm::vec3(glm::inverse(model) * glm::vec4(cameraPos, 1.0f));
+ *  cullMeshlets(meshlets, frustum, camera, ranges);                  // faixas visíveis do EBO
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "MeshBuilder.h"
+#include "MeshData.h"
+
+const uint32_t MESHLET_MAX_VERTICES = 64;
+const uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+// Peso do desvio da normal na escolha do próximo triângulo: cones mais
+// estreitos são descartados com mais frequência
+const float MESHLET_CONE_WEIGHT = 0.5f;
+
+// Esfera envolvente (centro da AABB) e cone de normais dos triângulos
+// `tris` (índices de triângulo em `indices`)
+inline void computeMeshletBounds(const ScratchVector<MeshVertex> &vertices, const ScratchVector<uint32_t> &indices,
+                                 const ScratchVector<uint32_t> &tris, Meshlet &meshlet)
+{
+    glm::vec3 lo = vertices[indices[tris[0] * 3]].position, hi = lo;
+    for (uint32_t t : tris)
+        for (int k = 0; k < 3; k++)
+        {
+            lo = glm::min(lo, vertices[indices[t * 3 + k]].position);
+            hi = glm::max(hi, vertices[indices[t * 3 + k]].position);
+        }
+    meshlet.center = (lo + hi) * 0.5f;
+    float radius2 = 0.0f;
+    for (uint32_t t : tris)
+        for (int k = 0; k < 3; k++)
+        {
+            glm::vec3 d = vertices[indices[t * 3 + k]].position - meshlet.center;
+            radius2 = std::max(radius2, glm::dot(d, d));
+        }
+    meshlet.radius = std::sqrt(radius2);
+
+    ScratchVector<glm::vec3> normals;
+    normals.reserve(tris.size());
+    glm::vec3 axis(0.0f);
+    for (uint32_t t : tris)
+    {
+        glm::vec3 p0 = vertices[indices[t * 3]].position;
+        glm::vec3 n = glm::cross(vertices[indices[t * 3 + 1]].position - p0, vertices[indices[t * 3 + 2]].position - p0);
+        float len = glm::length(n);
+        if (len <= 0.0f)
+            continue; // triângulo degenerado não tem lado visível
+        axis += n;     // soma ponderada pela área
+        normals.push_back(n / len);
+    }
+
+    // Cone desligado: nenhum teste de costas pode descartar o meshlet
+    meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+    meshlet.coneApex = meshlet.center;
+    meshlet.coneCutoff = 2.0f;
+    float axisLen = glm::length(axis);
+    if (normals.empty() || axisLen <= 0.0f)
+        return;
+    axis /= axisLen;
+    float minDot = 1.0f;
+    for (const glm::vec3 &n : normals)
+        minDot = std::min(minDot, glm::dot(axis, n));
+    if (minDot <= 0.0f)
+        return; // normais espalhadas por mais de um hemisfério
+
+    // Ângulo de abertura a das normais: o meshlet está de costas quando a
+    // direção câmera -> vértice do cone faz menos de 90° - a com o eixo,
+    // isto é, cos(ângulo) >= sin(a) = sqrt(1 - cos²(a))
+    meshlet.coneAxis = axis;
+    meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+
+    // Vértice do cone: recuado ao longo do eixo até ficar atrás dos planos de
+    // todos os triângulos
+    float maxT = 0.0f;
+    for (uint32_t t : tris)
+    {
+        glm::vec3 p0 = vertices[indices[t * 3]].position;
+        glm::vec3 n = glm::cross(vertices[indices[t * 3 + 1]].position - p0, vertices[indices[t * 3 + 2]].position - p0);
+        float len = glm::length(n);
+        if (len <= 0.0f)
+            continue;
+        n /= len;
+        maxT = std::max(maxT, glm::dot(meshlet.center - p0, n) / glm::dot(axis, n));
+    }
+    meshlet.coneApex = meshlet.center - axis * maxT;
+}
+
+// Dados da malha inteira reaproveitados quando buildMeshlets é chamado para
+// várias faixas da mesma malha (uma por submalha). Sem eles, cada chamada
+// percorre todos os vértices, o que domina com milhares de submalhas.
+struct MeshletScratch
+{
+    ScratchVector<uint32_t> posClass;
+    ScratchVector<glm::vec3> classPos;
+    ScratchVector<uint32_t> localClass; // classe da malha -> classe da faixa (~0u fora dela)
+    ScratchVector<uint32_t> vertexStamp;
+    uint32_t stamp = 0;
+};
+
+// Reagrupa os triângulos de mesh.indices[firstIndex, firstIndex + indexCount)
+// em meshlets (a faixa é reescrita no lugar, meshlet a meshlet)
+inline ScratchVector<Meshlet> buildMeshlets(IndexedMesh &mesh, uint32_t firstIndex, uint32_t indexCount,
+                                          uint32_t maxVertices = MESHLET_MAX_VERTICES,
+                                          uint32_t maxTriangles = MESHLET_MAX_TRIANGLES,
+                                          MeshletScratch *scratch = nullptr)
+{
+    ScratchVector<Meshlet> meshlets;
+    const ScratchVector<MeshVertex> &vertices = mesh.vertices;
+    ScratchVector<uint32_t> indices(mesh.indices.begin() + firstIndex, mesh.indices.begin() + firstIndex + indexCount);
+    size_t nTriangles = indices.size() / 3;
+    if (nTriangles == 0)
+        return meshlets;
+
+    // A vizinhança usa classes de posição, para que os meshlets atravessem
+    // as costuras de UV/normal
+    MeshletScratch ownScratch;
+    MeshletScratch &s = scratch ? *scratch : ownScratch;
+    if (s.posClass.size() != vertices.size())
+    {
+        buildPositionClasses(vertices, s.posClass, s.classPos);
+        s.localClass.assign(s.classPos.size(), ~0u);
+        s.vertexStamp.assign(vertices.size(), 0);
+        s.stamp = 0;
+    }
+
+    // Classe de cada índice da faixa, renumerada só entre as classes usadas
+    ScratchVector<uint32_t> cornerClass(indices.size()), usedClasses;
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        uint32_t &local = s.localClass[s.posClass[indices[i]]];
+        if (local == ~0u)
+        {
+            local = (uint32_t)usedClasses.size();
+            usedClasses.push_back(s.posClass[indices[i]]);
+        }
+        cornerClass[i] = local;
+    }
+    for (uint32_t c : usedClasses)
+        s.localClass[c] = ~0u;
+    size_t nClasses = usedClasses.size();
+
+    // Triângulos de cada classe (formato CSR)
+    ScratchVector<uint32_t> adjStart(nClasses + 1, 0), adjTris(nTriangles * 3);
+    for (uint32_t c : cornerClass)
+        adjStart[c + 1]++;
+    for (size_t c = 0; c < nClasses; c++)
+        adjStart[c + 1] += adjStart[c];
+    {
+        ScratchVector<uint32_t> fill(adjStart.begin(), adjStart.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++)
+            adjTris[fill[cornerClass[i]]++] = (uint32_t)(i / 3);
+    }
+
+    ScratchVector<glm::vec3> triNormals(nTriangles);
+    for (size_t t = 0; t < nTriangles; t++)
+    {
+        glm::vec3 p0 = vertices[indices[t * 3]].position;
+        glm::vec3 n = glm::cross(vertices[indices[t * 3 + 1]].position - p0, vertices[indices[t * 3 + 2]].position - p0);
+        float len = glm::length(n);
+        triNormals[t] = len > 0.0f ? n / len : glm::vec3(0.0f);
+    }
+
+    ScratchVector<uint8_t> used(nTriangles, 0);
+    // vertexStamp[v] == stamp quando v já está no meshlet atual e
+    // candidateStamp[t] == stamp quando t já está na lista de candidatos
+    ScratchVector<uint32_t> &vertexStamp = s.vertexStamp;
+    ScratchVector<uint32_t> candidateStamp(nTriangles, 0);
+    ScratchVector<uint32_t> result;
+    result.reserve(indices.size());
+
+    ScratchVector<uint32_t> tris, candidates;
+    size_t nextSeed = 0;
+    uint32_t stamp = s.stamp;
+
+    while (true)
+    {
+        while (nextSeed < nTriangles && used[nextSeed])
+            nextSeed++;
+        if (nextSeed == nTriangles)
+            break;
+
+        stamp++;
+        tris.clear();
+        candidates.clear();
+        uint32_t meshletVertices = 0;
+        glm::vec3 normalSum(0.0f);
+        uint32_t tri = (uint32_t)nextSeed;
+
+        while (true)
+        {
+            // Acrescenta o triângulo e os seus vizinhos à lista de candidatos
+            used[tri] = 1;
+            tris.push_back(tri);
+            normalSum += triNormals[tri];
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t v = indices[tri * 3 + k];
+                if (vertexStamp[v] != stamp)
+                {
+                    vertexStamp[v] = stamp;
+                    meshletVertices++;
+                }
+                uint32_t c = cornerClass[tri * 3 + k];
+                for (uint32_t a = adjStart[c]; a < adjStart[c + 1]; a++)
+                {
+                    uint32_t t = adjTris[a];
+                    if (!used[t] && candidateStamp[t] != stamp)
+                    {
+                        candidateStamp[t] = stamp;
+                        candidates.push_back(t);
+                    }
+                }
+            }
+            if (tris.size() >= maxTriangles)
+                break;
+
+            // Melhor vizinho: menos vértices novos, depois normal mais próxima da média
+            glm::vec3 axis = glm::length(normalSum) > 0.0f ? glm::normalize(normalSum) : glm::vec3(0.0f);
+            int best = -1;
+            float bestScore = 0.0f;
+            size_t kept = 0;
+            for (size_t i = 0; i < candidates.size(); i++)
+            {
+                uint32_t t = candidates[i];
+                if (used[t])
+                    continue;
+                candidates[kept++] = t;
+                uint32_t newVertices = 0;
+                for (int k = 0; k < 3; k++)
+                    newVertices += vertexStamp[indices[t * 3 + k]] != stamp;
+                if (meshletVertices + newVertices > maxVertices)
+                    continue;
+                float score = newVertices + MESHLET_CONE_WEIGHT * (1.0f - glm::dot(axis, triNormals[t]));
+                if (best < 0 || score < bestScore)
+                {
+                    best = (int)t;
+                    bestScore = score;
+                }
+            }
+            candidates.resize(kept);
+            if (best < 0)
+                break;
+            tri = (uint32_t)best;
+        }
+
+        Meshlet meshlet;
+        meshlet.firstIndex = firstIndex + (uint32_t)result.size();
+        meshlet.indexCount = (uint32_t)tris.size() * 3;
+        meshlet.vertexCount = meshletVertices;
+        computeMeshletBounds(vertices, indices, tris, meshlet);
+        meshlets.push_back(meshlet);
+        for (uint32_t t : tris)
+            result.insert(result.end(), indices.begin() + t * 3, indices.begin() + t * 3 + 3);
+    }
+
+    s.stamp = stamp;
+    std::copy(result.begin(), result.end(), mesh.indices.begin() + firstIndex);
+    return meshlets;
+}
+
+// Planos do frustum (normal para dentro, normalizados) no espaço de entrada
+// da matriz `m`: com m = projection * view * model, ficam no espaço do objeto
+// (Gribb e Hartmann, "Fast Extraction of Viewing Frustum Planes")
+struct Frustum
+{
+    glm::vec4 planes[6];
+};
+
+inline Frustum frustumFromMatrix(const glm::mat4 &m)
+{
+    Frustum f;
+    for (int i = 0; i < 3; i++)
+    {
+        glm::vec4 row(m[0][i], m[1][i], m[2][i], m[3][i]);
+        glm::vec4 w(m[0][3], m[1][3], m[2][3], m[3][3]);
+        f.planes[i * 2] = w + row;
+        f.planes[i * 2 + 1] = w - row;
+    }
+    for (glm::vec4 &p : f.planes)
+        p /= glm::length(glm::vec3(p));
+    return f;
+}
+
+inline bool sphereInFrustum(const Frustum &f, const glm::vec3 &center, float radius)
+{
+    for (const glm::vec4 &p : f.planes)
+        if (glm::dot(glm::vec3(p), center) + p.w < -radius)
+            return false;
+    return true;
+}
+
+// Caixa alinhada aos eixos (AABB de uma submalha): para cada plano basta
+// testar o canto da caixa mais avançado na direção da normal
+inline bool boxInFrustum(const Frustum &f, const glm::vec3 &boxMin, const glm::vec3 &boxMax)
+{
+    for (const glm::vec4 &p : f.planes)
+    {
+        glm::vec3 corner(p.x >= 0.0f ? boxMax.x : boxMin.x, p.y >= 0.0f ? boxMax.y : boxMin.y,
+                         p.z >= 0.0f ? boxMax.z : boxMin.z);
+        if (glm::dot(glm::vec3(p), corner) + p.w < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+// Todos os triângulos do meshlet de costas para `camera` (mesmo espaço do
+// meshlet): a câmera está fora do cone de normais aberto a partir do vértice
+// coneApex
+inline bool meshletBackfacing(const Meshlet &m, const glm::vec3 &camera)
+{
+    glm::vec3 d = m.coneApex - camera;
+    return glm::dot(d, m.coneAxis) >= m.coneCutoff * glm::length(d);
+}
+
+// Acrescenta a `ranges` as faixas do EBO dos meshlets visíveis (meshlets
+// vizinhos no EBO viram uma única faixa) e retorna o número de triângulos.
+// `frustum` e `camera` precisam estar no espaço do objeto.
+inline size_t cullMeshlets(const std::vector<Meshlet> &meshlets, const Frustum &frustum, const glm::vec3 &camera,
+                           std::vector<Submesh> &ranges)
+{
+    size_t triangles = 0;
+    for (const Meshlet &m : meshlets)
+    {
+        if (!sphereInFrustum(frustum, m.center, m.radius) || meshletBackfacing(m, camera))
+            continue;
+        if (!ranges.empty() && ranges.back().firstIndex + ranges.back().indexCount == m.firstIndex)
+            ranges.back().indexCount += m.indexCount;
+        else
+            ranges.push_back({m.firstIndex, m.indexCount, 0, 0});
+        triangles += m.indexCount / 3;
+    }
+    return triangles;
+}
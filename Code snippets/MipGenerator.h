@@ -0,0 +1,457 @@
+/*
+ *  MipGenerator - cadeia de mipmaps calculada na CPU
+ *
+ *  Cada nível é a imagem anterior reduzida à metade por um filtro separável
+ *  (MipFilter): a média de blocos de 2x2 (Box, o mesmo do glGenerateMipmap)
+ *  ou um sinc janelado de 12 taps (Kaiser ou Lanczos), que preserva os
+ *  detalhes sem o serrilhado da média. As cores de texturas sRGB (as imagens
+ *  comuns, como pixelWall.png) são convertidas para o espaço linear antes
+ *  do filtro e de volta para sRGB depois: a média direta dos bytes sRGB
+ *  escurece os níveis menores (o glGenerateMipmap de uma textura GL_RGBA8
+ *  faz assim). O alfa e as texturas de dados (mapas de normais,
+ *  `srgb = false`) são filtrados direto.
+ *
+ *  As imagens podem ter de 1 a 4 canais de 8 bits (cinza, cinza e alfa, RGB,
+ *  RGBA). O filtro roda em float: primeiro na vertical, sobre as linhas de
+ *  origem convertidas (uma vez cada) para o espaço linear, depois na
+ *  horizontal, com os texels pares e ímpares separados. Os dois passos são
+ *  somas ponderadas de vetores contíguos, em AVX2/FMA (compilado com
+ *  -mavx2 -mfma, ver ENABLE_AVX2 no CMakelists.txt) ou SSE2, 8 ou 4 floats
+ *  por instrução. As linhas de cada nível são divididas em faixas entre as
+ *  threads (ParallelFor.h).
+ *
+ *  Os níveis ficam um depois do outro na memória, do maior (nível 0) até
+ *  1x1, com os deslocamentos dados por `mipLevels`.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  std::vector<MipLevel> levels = mipLevels(width, height);
+ *  std::vector<uint8_t> chain(mipChainBytes(levels));
+ *  std::memcpy(chain.data(), pixels, (size_t)width * height * 4);
+ *  generateMipChain(chain.data(), chain.data() + levels[1].offset, levels, true, MipFilter::Kaiser);
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#define MIP_GENERATOR_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIP_GENERATOR_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#include "ParallelFor.h"
+
+// Passos da tabela linear -> sRGB: com 16384, o erro fica abaixo de 1/4 do
+// passo de 8 bits mesmo nos tons escuros, onde a curva sRGB é mais inclinada
+const int SRGB_ENCODE_STEPS = 16384;
+
+struct SrgbTables
+{
+    float toLinear[512]; // [0, 256): sRGB -> linear; [256, 512): byte / 255 (alfa e dados)
+    uint8_t fromLinear[SRGB_ENCODE_STEPS + 3]; // +3: leituras de 4 bytes do AVX2
+
+    SrgbTables()
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            float c = (float)i / 255.0f;
+            toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            toLinear[256 + i] = c;
+        }
+        for (int i = 0; i < SRGB_ENCODE_STEPS; i++)
+        {
+            float l = (float)i / (float)(SRGB_ENCODE_STEPS - 1);
+            float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            fromLinear[i] = (uint8_t)std::min(255.0f, c * 255.0f + 0.5f);
+        }
+        fromLinear[SRGB_ENCODE_STEPS] = fromLinear[SRGB_ENCODE_STEPS + 1] = fromLinear[SRGB_ENCODE_STEPS + 2] = 255;
+    }
+};
+
+inline const SrgbTables &srgbTables()
+{
+    static const SrgbTables tables;
+    return tables;
+}
+
+inline uint8_t linearToSrgb8(float linear)
+{
+    int i = (int)(std::min(std::max(linear, 0.0f), 1.0f) * (float)(SRGB_ENCODE_STEPS - 1) + 0.5f);
+    return srgbTables().fromLinear[i];
+}
+
+enum class MipFilter
+{
+    Box,    // média de 2x2: a mais rápida, mas borra e serrilha
+    Kaiser, // sinc com janela de Kaiser (alfa 4), raio de 3 texels do nível menor
+    Lanczos // Lanczos-3: a mais nítida, com um pouco de halo nas bordas fortes
+};
+
+inline const char *mipFilterName(MipFilter filter)
+{
+    switch (filter)
+    {
+    case MipFilter::Kaiser:
+        return "kaiser";
+    case MipFilter::Lanczos:
+        return "lanczos";
+    default:
+        return "box";
+    }
+}
+
+// Pesos da redução à metade: o texel x da saída fica entre os texels 2x e
+// 2x+1 da origem, e o texel 2x+k pesa o núcleo na distância (k - 0.5) / 2
+// (em texels da saída), para k de `first` a `first + weights.size() - 1`
+struct MipKernel
+{
+    int first;
+    std::vector<float> weights;
+};
+
+// Função de Bessel modificada I0 (para a janela de Kaiser), pela série
+inline double besselI0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; k++)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+inline MipKernel makeMipKernel(MipFilter filter)
+{
+    const double pi = 3.14159265358979323846;
+    const double radius = filter == MipFilter::Box ? 0.5 : 3.0, alpha = 4.0;
+    auto sinc = [pi](double t) { return t == 0.0 ? 1.0 : std::sin(pi * t) / (pi * t); };
+    MipKernel kernel;
+    kernel.first = 1 - (int)(2.0 * radius);
+    double sum = 0.0;
+    for (int k = kernel.first; k <= (int)(2.0 * radius); k++)
+    {
+        double t = (k - 0.5) / 2.0, weight = 1.0;
+        if (filter == MipFilter::Lanczos)
+            weight = sinc(t) * sinc(t / radius);
+        else if (filter == MipFilter::Kaiser)
+            weight = sinc(t) * besselI0(alpha * std::sqrt(std::max(0.0, 1.0 - (t / radius) * (t / radius)))) / besselI0(alpha);
+        kernel.weights.push_back((float)weight);
+        sum += weight;
+    }
+    for (float &weight : kernel.weights)
+        weight = (float)(weight / sum);
+    return kernel;
+}
+
+inline const MipKernel &mipKernel(MipFilter filter)
+{
+    static const MipKernel kernels[3] = {makeMipKernel(MipFilter::Box), makeMipKernel(MipFilter::Kaiser),
+                                         makeMipKernel(MipFilter::Lanczos)};
+    return kernels[(int)filter];
+}
+
+// dst[i] = soma de weights[k] * srcs[k][i], para i em [0, n)
+inline void weightedSum(float *dst, const float *const *srcs, const float *weights, int taps, size_t n)
+{
+    size_t i = 0;
+#if defined(MIP_GENERATOR_AVX2)
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256 a = _mm256_setzero_ps(), b = _mm256_setzero_ps();
+        for (int k = 0; k < taps; k++)
+        {
+            __m256 weight = _mm256_set1_ps(weights[k]);
+            a = _mm256_fmadd_ps(weight, _mm256_loadu_ps(srcs[k] + i), a);
+            b = _mm256_fmadd_ps(weight, _mm256_loadu_ps(srcs[k] + i + 8), b);
+        }
+        _mm256_storeu_ps(dst + i, a);
+        _mm256_storeu_ps(dst + i + 8, b);
+    }
+#elif defined(MIP_GENERATOR_SSE2)
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128 a = _mm_setzero_ps(), b = _mm_setzero_ps();
+        for (int k = 0; k < taps; k++)
+        {
+            __m128 weight = _mm_set1_ps(weights[k]);
+            a = _mm_add_ps(a, _mm_mul_ps(weight, _mm_loadu_ps(srcs[k] + i)));
+            b = _mm_add_ps(b, _mm_mul_ps(weight, _mm_loadu_ps(srcs[k] + i + 4)));
+        }
+        _mm_storeu_ps(dst + i, a);
+        _mm_storeu_ps(dst + i + 4, b);
+    }
+#endif
+    for (; i < n; i++)
+    {
+        float sum = 0.0f;
+        for (int k = 0; k < taps; k++)
+            sum += weights[k] * srcs[k][i];
+        dst[i] = sum;
+    }
+}
+
+// Bytes de texels de `Channels` canais para float: o canal c pela metade
+// sRGB (0) ou linear (256) de SrgbTables::toLinear, dada por `table[c]`
+template <int Channels>
+inline void decodeTexels(const uint8_t *bytes, float *out, size_t n, const int *table)
+{
+    const float *toLinear = srgbTables().toLinear;
+    size_t i = 0;
+#if defined(MIP_GENERATOR_AVX2)
+    size_t vectorEnd = n - n % (Channels == 3 ? 24 : 8); // o resto começa num texel inteiro
+    // 8 valores por gather: com 1, 2 ou 4 canais, o canal da posição j de
+    // cada grupo é j % Channels; com 3, todos usam a mesma metade
+    const __m256i offsets = _mm256_setr_epi32(table[0], table[1 % Channels], table[2 % Channels], table[3 % Channels],
+                                              table[4 % Channels], table[5 % Channels], table[6 % Channels],
+                                              table[7 % Channels]);
+    for (; i + 8 <= vectorEnd; i += 8)
+    {
+        __m256i index = _mm256_add_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(bytes + i))), offsets);
+        _mm256_storeu_ps(out + i, _mm256_i32gather_ps(toLinear, index, 4));
+    }
+#endif
+    for (; i < n; i += Channels)
+        for (int c = 0; c < Channels; c++)
+            out[i + c] = toLinear[bytes[i + c] + table[c]];
+}
+
+// Floats de texels de volta para bytes: sRGB nos canais com `table[c]` 0,
+// direto nos outros (como decodeTexels)
+template <int Channels>
+inline void encodeTexels(const float *in, uint8_t *out, size_t n, const int *table)
+{
+    const uint8_t *fromLinear = srgbTables().fromLinear;
+    const float steps = (float)(SRGB_ENCODE_STEPS - 1);
+    size_t i = 0;
+#if defined(MIP_GENERATOR_AVX2)
+    size_t vectorEnd = n - n % (Channels == 3 ? 24 : 8);
+    __m256i srgbLanes = _mm256_setzero_si256();
+    for (int j = 0; j < 8; j++)
+        if (table[j % Channels] == 0)
+            srgbLanes = _mm256_or_si256(srgbLanes, _mm256_set_epi32(j == 7 ? -1 : 0, j == 6 ? -1 : 0, j == 5 ? -1 : 0,
+                                                                    j == 4 ? -1 : 0, j == 3 ? -1 : 0, j == 2 ? -1 : 0,
+                                                                    j == 1 ? -1 : 0, j == 0 ? -1 : 0));
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f), half = _mm256_set1_ps(0.5f);
+    const __m256 srgbScale = _mm256_set1_ps(steps), unormScale = _mm256_set1_ps(255.0f);
+    for (; i + 8 <= vectorEnd; i += 8)
+    {
+        __m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + i), zero), one);
+        // O byte da tabela vem de uma leitura de 4 bytes a partir do índice
+        __m256i index = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(v, srgbScale), half));
+        __m256i srgb = _mm256_and_si256(_mm256_i32gather_epi32((const int *)fromLinear, index, 1), _mm256_set1_epi32(0xFF));
+        __m256i unorm = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(v, unormScale), half));
+        __m256i values = _mm256_blendv_epi8(unorm, srgb, srgbLanes);
+        __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(values), _mm256_extracti128_si256(values, 1));
+        _mm_storel_epi64((__m128i *)(out + i), _mm_packus_epi16(words, words));
+    }
+#endif
+    for (; i < n; i += Channels)
+        for (int c = 0; c < Channels; c++)
+        {
+            float v = std::min(std::max(in[i + c], 0.0f), 1.0f);
+            out[i + c] = table[c] == 0 ? fromLinear[(int)(v * steps + 0.5f)] : (uint8_t)(v * 255.0f + 0.5f);
+        }
+}
+
+// Linhas [rowBegin, rowEnd) da redução pela média de cada bloco de 2x2
+// texels (numa dimensão ímpar, a última linha/coluna fica de fora; numa
+// dimensão 1, a única linha/coluna entra duas vezes), direto dos bytes:
+// com só 4 texels por média, as tabelas custam mais que as contas, e
+// converter as linhas para float não compensa
+template <int Channels>
+inline void downsampleBoxRows(const uint8_t *src, int width, int height, uint8_t *dst, bool srgb, int rowBegin,
+                              int rowEnd)
+{
+    const float *toLinear = srgbTables().toLinear;
+    const int alpha = Channels == 2 ? 1 : (Channels == 4 ? 3 : -1);
+    int w = std::max(width / 2, 1);
+    size_t stride = (size_t)width * Channels;
+    for (int y = rowBegin; y < rowEnd; y++)
+    {
+        const uint8_t *row0 = src + (size_t)std::min(2 * y, height - 1) * stride;
+        const uint8_t *row1 = src + (size_t)std::min(2 * y + 1, height - 1) * stride;
+        uint8_t *out = dst + (size_t)y * w * Channels;
+        for (int x = 0; x < w; x++)
+        {
+            size_t left = (size_t)std::min(2 * x, width - 1) * Channels, right = (size_t)std::min(2 * x + 1, width - 1) * Channels;
+            for (int c = 0; c < Channels; c++)
+            {
+                int a = row0[left + c], b = row0[right + c], d = row1[left + c], e = row1[right + c];
+                out[c] = srgb && c != alpha ? linearToSrgb8(0.25f * (toLinear[a] + toLinear[b] + toLinear[d] + toLinear[e]))
+                                            : (uint8_t)((a + b + d + e + 2) / 4);
+            }
+            out += Channels;
+        }
+    }
+}
+
+// Reduz uma imagem RGBA8 à metade pela média de cada bloco de 2x2 texels
+inline void downsampleRGBA8(const uint8_t *src, int width, int height, uint8_t *dst, bool srgb)
+{
+    downsampleBoxRows<4>(src, width, height, dst, srgb, 0, std::max(height / 2, 1));
+}
+
+// Linhas [rowBegin, rowEnd) da redução à metade de um nível de `Channels`
+// canais. As linhas de origem convertidas ficam num anel de `taps` linhas,
+// indexado pela linha antes de limitada à imagem: cada uma é convertida uma
+// vez por faixa (só as bordas repetidas se repetem).
+template <int Channels>
+inline void downsampleRows(const uint8_t *src, int width, int height, uint8_t *dst, bool srgb, const MipKernel &kernel,
+                           int rowBegin, int rowEnd)
+{
+    const int alpha = Channels == 2 ? 1 : (Channels == 4 ? 3 : -1);
+    int w = std::max(width / 2, 1);
+    int taps = (int)kernel.weights.size(), last = kernel.first + taps - 1;
+    int table[Channels]; // metade de SrgbTables::toLinear de cada canal
+    for (int c = 0; c < Channels; c++)
+        table[c] = srgb && c != alpha ? 0 : 256;
+
+    // Borda de `pad` texels (par) dos dois lados, para o filtro horizontal
+    // não precisar limitar os índices
+    int pad = (std::max(-kernel.first, last) + 1) & ~1;
+    size_t rowFloats = (size_t)width * Channels;
+    size_t halfTexels = (size_t)(width + 1) / 2 + pad; // texels pares (ou ímpares) da linha com a borda
+    std::vector<float> ring((size_t)taps * rowFloats);
+    std::vector<int> ringRow(taps, -1);
+    std::vector<float> column(rowFloats);
+    std::vector<float> even(halfTexels * Channels), odd(halfTexels * Channels);
+    std::vector<float> filtered((size_t)w * Channels);
+    std::vector<const float *> srcs(taps);
+
+    for (int y = rowBegin; y < rowEnd; y++)
+    {
+        for (int k = 0; k < taps; k++)
+        {
+            int unclamped = 2 * y + kernel.first + k;
+            int row = std::min(std::max(unclamped, 0), height - 1);
+            int slot = ((unclamped % taps) + taps) % taps;
+            float *linear = ring.data() + (size_t)slot * rowFloats;
+            if (ringRow[slot] != row)
+            {
+                decodeTexels<Channels>(src + (size_t)row * rowFloats, linear, rowFloats, table);
+                ringRow[slot] = row;
+            }
+            srcs[k] = linear;
+        }
+        weightedSum(column.data(), srcs.data(), kernel.weights.data(), taps, rowFloats);
+
+        // Texels pares e ímpares da linha com a borda (o texel t da linha é
+        // o t + pad da borda, e pad é par), repetindo os das pontas
+        for (int t = -pad; t < width + pad; t++)
+        {
+            const float *texel = column.data() + (size_t)std::min(std::max(t, 0), width - 1) * Channels;
+            float *half = ((t + pad) & 1 ? odd.data() : even.data()) + (size_t)((t + pad) >> 1) * Channels;
+            for (int c = 0; c < Channels; c++)
+                half[c] = texel[c];
+        }
+
+        // O texel 2x+k da origem é o 2x+k+pad da borda: par ou ímpar
+        // conforme k, sempre no deslocamento x + (k+pad)/2
+        for (int k = 0; k < taps; k++)
+        {
+            int shifted = kernel.first + k + pad;
+            srcs[k] = ((shifted & 1) ? odd.data() : even.data()) + (size_t)(shifted >> 1) * Channels;
+        }
+        weightedSum(filtered.data(), srcs.data(), kernel.weights.data(), taps, filtered.size());
+
+        encodeTexels<Channels>(filtered.data(), dst + (size_t)y * w * Channels, filtered.size(), table);
+    }
+}
+
+// Linhas [rowBegin, rowEnd) da redução à metade com o filtro `filter`
+template <int Channels>
+inline void downsampleBand(const uint8_t *src, int width, int height, uint8_t *dst, bool srgb, MipFilter filter,
+                           int rowBegin, int rowEnd)
+{
+    if (filter == MipFilter::Box)
+        downsampleBoxRows<Channels>(src, width, height, dst, srgb, rowBegin, rowEnd);
+    else
+        downsampleRows<Channels>(src, width, height, dst, srgb, mipKernel(filter), rowBegin, rowEnd);
+}
+
+// Reduz um nível de 1 a 4 canais à metade, com as linhas divididas entre
+// `nThreads` threads (0 = todos os núcleos)
+inline void downsampleImage(const uint8_t *src, int width, int height, uint8_t *dst, int channels, bool srgb,
+                            MipFilter filter, unsigned nThreads = 0)
+{
+    int w = std::max(width / 2, 1), h = std::max(height / 2, 1);
+    // Faixas de pelo menos ~256 mil texels da saída: cada uma converte de
+    // novo as linhas da borda de cima
+    size_t minRows = std::max<size_t>(8, ((size_t)1 << 18) / (size_t)w);
+    parallelFor((size_t)h, nThreads, [&](size_t begin, size_t end)
+    {
+        switch (channels)
+        {
+        case 1:
+            downsampleBand<1>(src, width, height, dst, srgb, filter, (int)begin, (int)end);
+            break;
+        case 2:
+            downsampleBand<2>(src, width, height, dst, srgb, filter, (int)begin, (int)end);
+            break;
+        case 3:
+            downsampleBand<3>(src, width, height, dst, srgb, filter, (int)begin, (int)end);
+            break;
+        default:
+            downsampleBand<4>(src, width, height, dst, srgb, filter, (int)begin, (int)end);
+        }
+    }, minRows);
+}
+
+struct MipLevel
+{
+    int width, height;
+    size_t offset; // bytes desde o início do nível 0
+};
+
+// Níveis de uma imagem de `channels` canais (RGBA8 por padrão) até 1x1, ou
+// só o nível 0, sem `fullChain`
+inline std::vector<MipLevel> mipLevels(int width, int height, bool fullChain = true, int channels = 4)
+{
+    std::vector<MipLevel> levels;
+    size_t offset = 0;
+    for (;;)
+    {
+        levels.push_back({width, height, offset});
+        offset += (size_t)width * height * channels;
+        if (!fullChain || (width == 1 && height == 1))
+            return levels;
+        width = std::max(width / 2, 1);
+        height = std::max(height / 2, 1);
+    }
+}
+
+inline size_t mipLevelBytes(const MipLevel &level, int channels = 4)
+{
+    return (size_t)level.width * level.height * channels;
+}
+
+inline size_t mipChainBytes(const std::vector<MipLevel> &levels, int channels = 4)
+{
+    return levels.back().offset + mipLevelBytes(levels.back(), channels);
+}
+
+// Gera os níveis 1 em diante de `levels` em `mips` (o início do nível 1, com
+// os níveis seguintes logo depois) a partir do nível 0 em `level0`. Cada
+// nível sai do anterior; os menores rodam numa thread só.
+inline void generateMipChain(const uint8_t *level0, uint8_t *mips, const std::vector<MipLevel> &levels, bool srgb,
+                             MipFilter filter = MipFilter::Box, int channels = 4, unsigned nThreads = 0)
+{
+    if (levels.size() < 2)
+        return;
+    size_t base = levels[1].offset;
+    for (size_t l = 1; l < levels.size(); l++)
+    {
+        const MipLevel &src = levels[l - 1];
+        const uint8_t *from = l == 1 ? level0 : mips + (src.offset - base);
+        downsampleImage(from, src.width, src.height, mips + (levels[l].offset - base), channels, srgb, filter, nThreads);
+    }
+}
@@ -0,0 +1,79 @@
+/*
+ *  MpscQueue - fila sem travas de vários produtores e um consumidor
+ *
+ *  Fila de Vyukov: `push` é uma troca atômica seguida de um store (nenhuma
+ *  thread espera pela outra) e `pop`, só na thread consumidora, apenas lê
+ *  ponteiros. Serve para as threads de trabalho entregarem resultados à
+ *  thread da OpenGL sem que o laço de desenho tenha de disputar um mutex.
+ *
+ *  Entre a troca e o store de um `push`, o nó ainda não está ligado à lista:
+ *  nesse instante `pop` retorna false mesmo com um item a caminho, e o
+ *  consumidor o recebe na próxima chamada (no próximo quadro).
+ *
+ *  Forma de uso
+ *  -----------------
+ *  MpscQueue<std::unique_ptr<Resultado>> prontos;
+ *  // thread de trabalho:
+ *  prontos.push(std::move(resultado));
+ *  // thread principal, a cada quadro:
+ *  std::unique_ptr<Resultado> r;
+ *  while (prontos.pop(r))
+ *      ...
+ */
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+template <typename T>
+class MpscQueue
+{
+public:
+    MpscQueue() : head(new Node()), tail(head.load(std::memory_order_relaxed)) {}
+
+    ~MpscQueue()
+    {
+        while (tail)
+        {
+            Node *next = tail->next.load(std::memory_order_relaxed);
+            delete tail;
+            tail = next;
+        }
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    // Qualquer thread
+    void push(T value)
+    {
+        Node *node = new Node();
+        node->value = std::move(value);
+        Node *prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // Só a thread consumidora. Retorna false se a fila estiver vazia.
+    bool pop(T &value)
+    {
+        Node *next = tail->next.load(std::memory_order_acquire);
+        if (!next)
+            return false;
+        // `next` passa a ser o nó vazio do início da fila
+        value = std::move(next->value);
+        delete tail;
+        tail = next;
+        return true;
+    }
+
+private:
+    struct Node
+    {
+        std::atomic<Node *> next{nullptr};
+        T value{};
+    };
+
+    std::atomic<Node *> head; // último nó inserido (produtores)
+    Node *tail;               // nó vazio antes do primeiro item (consumidor)
+};
@@ -0,0 +1,119 @@
+/*
+ *  MtlParser - leitura de bibliotecas de materiais Wavefront .MTL
+ *
+ *  Um .OBJ referencia suas bibliotecas com `mtllib arquivo.mtl` e escolhe o
+ *  material das faces seguintes com `usemtl nome`. Cada material começa com
+ *  `newmtl nome`; são lidos os registros usados pelo modelo de Phong:
+ *
+ *  Ka r g b      -> ka       (cor ambiente)
+ *  Kd r g b      -> kd       (cor difusa)
+ *  Ks r g b      -> ks       (cor especular)
+ *  Ns expoente   -> ns       (brilho especular)
+ *  map_Kd a.png  -> mapKd    (textura difusa, caminho relativo ao .MTL)
+ *
+ *  Os demais registros (Ke, Ni, d, illum, ...) são ignorados.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  std::vector<Material> materials;
+ *  parseMTLFile("../assets/Modelos3D/Suzanne.mtl", materials);
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "MappedFile.h"
+#include "ObjParser.h"
+
+struct Material
+{
+    std::string name;
+    // Valores neutros: sem Ka/Kd no .MTL, a textura aparece sem alteração
+    glm::vec3 ka = glm::vec3(1.0f);
+    glm::vec3 kd = glm::vec3(1.0f);
+    glm::vec3 ks = glm::vec3(0.0f);
+    float ns = 32.0f;
+    std::string mapKd;           // caminho completo da textura difusa ("" = sem textura)
+    uint32_t diffuseTexture = 0; // textura OpenGL de mapKd, preenchida pelo carregador
+    uint32_t diffuseSampler = 0; // objeto de amostragem de diffuseTexture (glBindSampler)
+};
+
+// Pasta de um caminho, com a barra final ("" se não houver pasta)
+inline std::string directoryOf(const std::string &path)
+{
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+// Nome de arquivo de um map_*: as opções (-s 1 1 1, -bm 0.5, ...) vêm antes
+// do nome, então quando houver opções fica só a última palavra
+inline std::string mtlParseMapName(const char *p, const char *end)
+{
+    std::string name = objParseName(p, end);
+    if (!name.empty() && name[0] == '-')
+    {
+        size_t space = name.find_last_of(" \t");
+        name = space == std::string::npos ? std::string() : name.substr(space + 1);
+    }
+    return name;
+}
+
+inline const char *mtlParseColor(const char *p, const char *end, glm::vec3 &color)
+{
+    p = objParseFloat(p, end, color.r);
+    p = objParseFloat(p, end, color.g);
+    return objParseFloat(p, end, color.b);
+}
+
+// Acrescenta a `materials` os materiais do arquivo
+inline bool parseMTLFile(const std::string &filePATH, std::vector<Material> &materials)
+{
+    MappedFile file;
+    if (!file.open(filePATH))
+    {
+        std::cerr << "Erro ao tentar ler o arquivo " << filePATH << std::endl;
+        return false;
+    }
+    std::string dir = directoryOf(filePATH);
+
+    const char *p = file.data(), *end = file.data() + file.size();
+    Material *current = nullptr;
+    while (p < end)
+    {
+        const char *lineEnd = (const char *)std::memchr(p, '\n', end - p);
+        if (!lineEnd)
+            lineEnd = end;
+        const char *q = objSkipSpaces(p, lineEnd);
+
+        if (objKeyword(q, lineEnd, "newmtl"))
+        {
+            materials.push_back(Material());
+            current = &materials.back();
+            current->name = objParseName(q + 6, lineEnd);
+        }
+        else if (current && objKeyword(q, lineEnd, "Ka"))
+            mtlParseColor(q + 2, lineEnd, current->ka);
+        else if (current && objKeyword(q, lineEnd, "Kd"))
+            mtlParseColor(q + 2, lineEnd, current->kd);
+        else if (current && objKeyword(q, lineEnd, "Ks"))
+            mtlParseColor(q + 2, lineEnd, current->ks);
+        else if (current && objKeyword(q, lineEnd, "Ns"))
+            objParseFloat(q + 2, lineEnd, current->ns);
+        else if (current && objKeyword(q, lineEnd, "map_Kd"))
+        {
+            std::string name = mtlParseMapName(q + 6, lineEnd);
+            if (!name.empty())
+                current->mapKd = dir + name;
+        }
+        p = lineEnd + 1;
+    }
+    return true;
+}
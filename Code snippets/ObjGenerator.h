@@ -0,0 +1,308 @@
+/*
+ *  ObjGenerator - .OBJ sintéticos grandes e reproduzíveis, para medições
+ *
+ *  `writeSyntheticOBJ` grava um terreno em grade (altura senoidal com um
+ *  ruído pequeno) com o número pedido de faces. A mesma semente e as mesmas
+ *  opções geram sempre o mesmo arquivo, byte a byte, com o mesmo compilador
+ *  e a mesma biblioteca (gerador congruencial próprio e números escritos
+ *  com aritmética inteira, sem locale). Entre plataformas, as alturas podem
+ *  mudar na última casa: o std::sin e o std::cos da biblioteca matemática
+ *  não são iguais em todas.
+ *
+ *  - ObjFaceType::Triangles: cada célula da grade vira 2 triângulos
+ *  - ObjFaceType::Quads: uma face de 4 cantos por célula
+ *  - ObjFaceType::NGons: `ngonCells` células vizinhas de uma linha formam um
+ *    polígono de 2 * ngonCells + 2 cantos (triangulado em leque pelo leitor)
+ *
+ *  Com `objects` > 1, as faces são divididas em faixas de linhas da grade,
+ *  uma por objeto (`o Parte_<n>`), como nos arquivos com muitas peças.
+ *
+ *  Sem `vt` e/ou sem `vn` (texCoords/normals = false), as faces usam os
+ *  formatos "v", "v/t" e "v//n", como nos arquivos exportados sem esses
+ *  atributos. Há um `v`, um `vt` e um `vn` por ponto da grade, com o mesmo
+ *  índice nos três.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  ObjGeneratorOptions options;
+ *  options.faces = 10000000;
+ *  options.faceType = ObjFaceType::Quads;
+ *  options.normals = false;
+ *  writeSyntheticOBJ("terreno_10M.obj", options);
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+enum class ObjFaceType
+{
+    Triangles = 0,
+    Quads = 1,
+    NGons = 2
+};
+
+struct ObjGeneratorOptions
+{
+    size_t faces = 1000000;
+    ObjFaceType faceType = ObjFaceType::Triangles;
+    int ngonCells = 3;     // células por n-gono (2 * ngonCells + 2 cantos)
+    bool texCoords = true; // grava `vt`
+    bool normals = true;   // grava `vn`
+    uint32_t seed = 1;     // semente do ruído de altura
+    size_t objects = 1;    // registros `o` (1 = um só objeto)
+};
+
+inline const char *objFaceTypeName(ObjFaceType type)
+{
+    return type == ObjFaceType::Quads ? "quad" : type == ObjFaceType::NGons ? "ngon" : "tri";
+}
+
+// Buffer de saída com conversão de números sem printf (mais rápido e sem locale)
+class ObjTextWriter
+{
+public:
+    explicit ObjTextWriter(std::FILE *file) : file(file) { buffer.reserve(BUFFER_BYTES + 256); }
+    ~ObjTextWriter() { flush(); }
+
+    void text(const char *s)
+    {
+        while (*s)
+            buffer.push_back(*s++);
+    }
+
+    // Com 6 casas, a partir dos milionésimos arredondados: não depende do
+    // std::to_chars de float (libstdc++ 11 em diante) nem do arredondamento dele
+    void number(float value)
+    {
+        long long micros = std::llround((double)value * 1e6);
+        if (micros < 0)
+        {
+            buffer.push_back('-');
+            micros = -micros;
+        }
+        number((uint64_t)micros / 1000000u);
+        char digits[7] = {'.'};
+        uint64_t fraction = (uint64_t)micros % 1000000u;
+        for (int i = 6; i >= 1; i--, fraction /= 10)
+            digits[i] = (char)('0' + fraction % 10);
+        buffer.insert(buffer.end(), digits, digits + 7);
+    }
+
+    void number(uint64_t value)
+    {
+        char tmp[24];
+        char *end = std::to_chars(tmp, tmp + sizeof(tmp), value).ptr;
+        buffer.insert(buffer.end(), tmp, end);
+    }
+
+    void endLine()
+    {
+        buffer.push_back('\n');
+        if (buffer.size() >= BUFFER_BYTES)
+            flush();
+    }
+
+    void flush()
+    {
+        if (!buffer.empty() && std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size())
+            failed = true;
+        buffer.clear();
+    }
+
+    bool ok() const { return !failed; }
+
+private:
+    static const size_t BUFFER_BYTES = 1 << 20;
+    std::FILE *file;
+    std::vector<char> buffer;
+    bool failed = false;
+};
+
+// Gerador congruencial linear (constantes de Numerical Recipes): mesma
+// sequência em qualquer compilador, ao contrário de std::rand
+inline float objGeneratorNoise(uint32_t &state)
+{
+    state = state * 1664525u + 1013904223u;
+    return (float)(state >> 8) * (1.0f / 16777216.0f) - 0.5f;
+}
+
+// Grava o .OBJ sintético. Retorna false se o arquivo não puder ser gravado.
+inline bool writeSyntheticOBJ(const std::string &filePath, const ObjGeneratorOptions &options)
+{
+    if (options.faces == 0)
+    {
+        std::cerr << "Erro: o numero de faces deve ser maior que zero" << std::endl;
+        return false;
+    }
+
+    // Células da grade necessárias e uma grade quase quadrada que as comporte.
+    // Nos n-gonos, a largura é múltipla de ngonCells para não quebrar polígonos.
+    size_t cellsPerFace = 1, facesPerCell = 1;
+    if (options.faceType == ObjFaceType::Triangles)
+        facesPerCell = 2;
+    else if (options.faceType == ObjFaceType::NGons)
+        cellsPerFace = (size_t)std::max(options.ngonCells, 1);
+    size_t cells = (options.faces + facesPerCell - 1) / facesPerCell * cellsPerFace;
+    size_t columns = std::max<size_t>((size_t)std::ceil(std::sqrt((double)cells)), 1);
+    columns = (columns + cellsPerFace - 1) / cellsPerFace * cellsPerFace;
+    size_t rows = (cells + columns - 1) / columns;
+    size_t stride = columns + 1; // pontos por linha da grade
+
+    std::FILE *file = std::fopen(filePath.c_str(), "wb");
+    if (!file)
+    {
+        std::cerr << "Erro ao tentar gravar o arquivo " << filePath << std::endl;
+        return false;
+    }
+
+    bool ok;
+    {
+        ObjTextWriter out(file);
+        out.text("# OBJ sintetico: ");
+        out.number((uint64_t)options.faces);
+        out.text(" faces (");
+        out.text(objFaceTypeName(options.faceType));
+        out.text("), grade ");
+        out.number((uint64_t)columns);
+        out.text(" x ");
+        out.number((uint64_t)rows);
+        out.text(", semente ");
+        out.number((uint64_t)options.seed);
+        out.endLine();
+
+        // Terreno de 2 x 2 unidades centrado na origem; altura senoidal com
+        // ruído, para que a soldagem e a simplificação não vejam um plano
+        const float size = 2.0f;
+        const float dx = size / (float)columns, dz = size / (float)rows;
+        const float frequency = 6.2831853f * 4.0f / size, amplitude = 0.1f;
+        uint32_t state = options.seed * 2654435761u + 1u;
+        for (size_t j = 0; j <= rows; j++)
+            for (size_t i = 0; i <= columns; i++)
+            {
+                float x = -1.0f + dx * (float)i, z = -1.0f + dz * (float)j;
+                float y = amplitude * std::sin(frequency * x) * std::cos(frequency * z) +
+                          0.05f * std::min(dx, dz) * objGeneratorNoise(state);
+                out.text("v ");
+                out.number(x);
+                out.text(" ");
+                out.number(y);
+                out.text(" ");
+                out.number(z);
+                out.endLine();
+            }
+        if (options.texCoords)
+            for (size_t j = 0; j <= rows; j++)
+                for (size_t i = 0; i <= columns; i++)
+                {
+                    out.text("vt ");
+                    out.number((float)i / (float)columns);
+                    out.text(" ");
+                    out.number(1.0f - (float)j / (float)rows);
+                    out.endLine();
+                }
+        if (options.normals)
+            for (size_t j = 0; j <= rows; j++)
+                for (size_t i = 0; i <= columns; i++)
+                {
+                    // Normal analítica da altura senoidal (o ruído é desprezado)
+                    float x = -1.0f + dx * (float)i, z = -1.0f + dz * (float)j;
+                    float dydx = amplitude * frequency * std::cos(frequency * x) * std::cos(frequency * z);
+                    float dydz = -amplitude * frequency * std::sin(frequency * x) * std::sin(frequency * z);
+                    float length = std::sqrt(dydx * dydx + 1.0f + dydz * dydz);
+                    out.text("vn ");
+                    out.number(-dydx / length);
+                    out.text(" ");
+                    out.number(1.0f / length);
+                    out.text(" ");
+                    out.number(-dydz / length);
+                    out.endLine();
+                }
+
+        // Canto no formato pedido; o mesmo índice em v, vt e vn
+        auto corner = [&](size_t i, size_t j)
+        {
+            uint64_t index = (uint64_t)(j * stride + i) + 1;
+            out.text(" ");
+            out.number(index);
+            if (options.texCoords || options.normals)
+            {
+                out.text("/");
+                if (options.texCoords)
+                    out.number(index);
+                if (options.normals)
+                {
+                    out.text("/");
+                    out.number(index);
+                }
+            }
+        };
+
+        // Cantos em sentido anti-horário vistos de +y. O objeto k começa na
+        // face k * faces / objects.
+        size_t written = 0, objects = std::min(std::max<size_t>(options.objects, 1), options.faces), object = 0;
+        for (size_t j = 0; j < rows && written < options.faces; j++)
+            for (size_t i = 0; i < columns && written < options.faces; i += cellsPerFace)
+            {
+                if (object < objects && written >= object * options.faces / objects)
+                {
+                    out.text(objects > 1 ? "o Parte_" : "o Terreno");
+                    if (objects > 1)
+                        out.number((uint64_t)object);
+                    out.endLine();
+                    object++;
+                }
+                if (options.faceType == ObjFaceType::Triangles)
+                {
+                    out.text("f");
+                    corner(i, j);
+                    corner(i, j + 1);
+                    corner(i + 1, j + 1);
+                    out.endLine();
+                    if (++written == options.faces)
+                        break;
+                    out.text("f");
+                    corner(i, j);
+                    corner(i + 1, j + 1);
+                    corner(i + 1, j);
+                    out.endLine();
+                }
+                else if (options.faceType == ObjFaceType::Quads)
+                {
+                    out.text("f");
+                    corner(i, j);
+                    corner(i, j + 1);
+                    corner(i + 1, j + 1);
+                    corner(i + 1, j);
+                    out.endLine();
+                }
+                else
+                {
+                    // Contorno das células [i, i + cellsPerFace) da linha j
+                    out.text("f");
+                    corner(i, j);
+                    for (size_t k = 0; k <= cellsPerFace; k++)
+                        corner(i + k, j + 1);
+                    for (size_t k = cellsPerFace; k >= 1; k--)
+                        corner(i + k, j);
+                    out.endLine();
+                }
+                written++;
+            }
+        out.flush();
+        ok = out.ok();
+    }
+    if (std::fclose(file) != 0 || !ok)
+    {
+        std::cerr << "Erro ao gravar o arquivo " << filePath << std::endl;
+        return false;
+    }
+    return true;
+}
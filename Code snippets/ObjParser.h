@@ -0,0 +1,456 @@
+/*
+ *  ObjParser - leitura rápida de arquivos Wavefront .OBJ
+ *
+ *  O arquivo é mapeado em memória (MappedFile) e tokenizado no próprio buffer
+ *  com std::from_chars, sem criar std::string ou istringstream por linha.
+ *  O std::from_chars de float só existe na libstdc++ 11 (GCC 11), no MSVC
+ *  2019 16.4 e em libc++ recentes; nas bibliotecas anteriores, os números
+ *  com ponto são lidos com strtof (ver OBJ_PARSER_FROM_CHARS_FLOAT).
+ *  Reconhece os registros de geometria e de materiais:
+ *
+ *  v  x y z         -> vertices
+ *  vt s t           -> texCoords
+ *  vn nx ny nz      -> normals
+ *  f  v/vt/vn ...   -> corners (3 por triângulo; polígonos são triangulados em leque)
+ *  mtllib a.mtl     -> materialLibs (bibliotecas de materiais, ver MtlParser.h)
+ *  usemtl nome      -> materialRanges (material das faces seguintes)
+ *  s 1 | s off      -> smoothingRanges (grupo de suavização das faces seguintes)
+ *  o nome | g nome  -> objectRanges (objeto/grupo das faces seguintes, ver ObjPartName)
+ *
+ *  Os índices das faces são convertidos para base 0. Índices negativos (relativos
+ *  ao fim da lista, permitidos pelo formato) também são resolvidos. Um índice
+ *  ausente (ex.: "f 1//3") fica com o valor -1.
+ *
+ *  Arquivos grandes podem ser lidos em paralelo (parseOBJParallel), com
+ *  resultado idêntico ao da leitura serial.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  ObjData obj;
+ *  if (parseOBJFile("../assets/Modelos3D/Suzanne.obj", obj))      // serial
+ *      ...
+ *  if (parseOBJFile("../assets/Modelos3D/Suzanne.obj", obj, 0))   // todos os núcleos
+ *      ...
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "MappedFile.h"
+#include "ArenaAllocator.h" // ScratchVector: memória temporária da carga
+
+// Índices (base 0) de um canto de face: posição, coordenada de textura e normal
+struct ObjCorner
+{
+    int v, t, n;
+};
+
+// As faces a partir do canto `firstCorner` usam o material `name`
+struct ObjMaterialRange
+{
+    std::string name;
+    size_t firstCorner;
+};
+
+// As faces a partir do canto `firstCorner` estão no grupo de suavização
+// `group` (0 = "s off": faces facetadas)
+struct ObjSmoothingRange
+{
+    uint32_t group;
+    size_t firstCorner;
+};
+
+// As faces a partir do canto `firstCorner` pertencem ao objeto (`o`) ou ao
+// grupo (`g`, com group = true) `name`
+struct ObjObjectRange
+{
+    std::string name;
+    size_t firstCorner;
+    bool group;
+};
+
+// Nome da parte atual a partir dos registros `o` e `g` lidos até aqui:
+// "objeto", "grupo" ou "objeto/grupo" ("" antes do primeiro). Um `o` novo
+// encerra o grupo anterior.
+struct ObjPartName
+{
+    std::string object, group;
+
+    void apply(const ObjObjectRange &range)
+    {
+        if (range.group)
+            group = range.name;
+        else
+        {
+            object = range.name;
+            group.clear();
+        }
+    }
+
+    std::string name() const
+    {
+        if (object.empty() || group.empty())
+            return object.empty() ? group : object;
+        return object + "/" + group;
+    }
+};
+
+struct ObjData
+{
+    ScratchVector<glm::vec3> vertices;
+    ScratchVector<glm::vec2> texCoords;
+    ScratchVector<glm::vec3> normals;
+    ScratchVector<ObjCorner> corners;
+    ScratchVector<std::string> materialLibs;
+    ScratchVector<ObjMaterialRange> materialRanges;
+    ScratchVector<ObjSmoothingRange> smoothingRanges;
+    ScratchVector<ObjObjectRange> objectRanges;
+};
+
+inline const char *objSkipSpaces(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        ++p;
+    return p;
+}
+
+// 1 se a biblioteca tiver std::from_chars de float (a <charconv> define
+// __cpp_lib_to_chars só com ele); 0 usa strtof
+#ifndef OBJ_PARSER_FROM_CHARS_FLOAT
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define OBJ_PARSER_FROM_CHARS_FLOAT 1
+#else
+#define OBJ_PARSER_FROM_CHARS_FLOAT 0
+#endif
+#endif
+
+inline const char *objParseFloat(const char *p, const char *end, float &value)
+{
+    p = objSkipSpaces(p, end);
+    // from_chars não aceita o sinal '+' explícito
+    if (p < end && *p == '+')
+        ++p;
+#if OBJ_PARSER_FROM_CHARS_FLOAT
+    std::from_chars_result res = std::from_chars(p, end, value);
+    if (res.ec != std::errc())
+        value = 0.0f;
+    return res.ptr;
+#else
+    // O buffer mapeado não termina em '\0': strtof lê uma cópia do número.
+    // strtof segue o locale, que é o "C" (ponto decimal) sem setlocale.
+    char token[64];
+    size_t n = 0;
+    while (p + n < end && n + 1 < sizeof(token) && p[n] != ' ' && p[n] != '\t' && p[n] != '\r' && p[n] != '\n')
+    {
+        token[n] = p[n];
+        n++;
+    }
+    token[n] = '\0';
+    char *stop = token;
+    value = std::strtof(token, &stop);
+    if (stop == token)
+        value = 0.0f;
+    return p + (stop - token);
+#endif
+}
+
+// Converte um índice do .OBJ (base 1, ou negativo = relativo) para base 0.
+// Retorna -1 se o campo estiver vazio. `relative` indica que o índice foi
+// resolvido a partir de `count` (usado na correção da leitura paralela).
+inline const char *objParseIndex(const char *p, const char *end, int count, int &index, bool &relative)
+{
+    int raw = 0;
+    std::from_chars_result res = std::from_chars(p, end, raw);
+    relative = false;
+    if (res.ec != std::errc() || raw == 0)
+    {
+        index = -1;
+        return res.ptr;
+    }
+    relative = raw < 0;
+    index = raw > 0 ? raw - 1 : count + raw;
+    return res.ptr;
+}
+
+// Lê um canto de face no formato v, v/vt, v//vn ou v/vt/vn.
+// Os bits 0, 1 e 2 de `relMask` marcam os índices v, vt e vn relativos.
+inline const char *objParseCorner(const char *p, const char *end, const ObjData &obj, ObjCorner &c, unsigned &relMask)
+{
+    bool rel = false;
+    c.v = c.t = c.n = -1;
+    relMask = 0;
+    p = objParseIndex(p, end, (int)obj.vertices.size(), c.v, rel);
+    relMask |= rel ? 1u : 0u;
+    if (p < end && *p == '/')
+    {
+        ++p;
+        if (p < end && *p != '/')
+        {
+            p = objParseIndex(p, end, (int)obj.texCoords.size(), c.t, rel);
+            relMask |= rel ? 2u : 0u;
+        }
+        if (p < end && *p == '/')
+        {
+            ++p;
+            p = objParseIndex(p, end, (int)obj.normals.size(), c.n, rel);
+            relMask |= rel ? 4u : 0u;
+        }
+    }
+    // Descarta qualquer resto inesperado do token
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\r')
+        ++p;
+    return p;
+}
+
+// Cantos com índices relativos são anotados em `relative` (posição do canto * 8
+// + máscara), quando fornecido. Na leitura serial ele é nulo, pois as contagens
+// já são as globais.
+inline void objParseFace(const char *p, const char *end, ObjData &obj, ScratchVector<uint64_t> *relative)
+{
+    ObjCorner first, prev, cur;
+    unsigned firstMask = 0, prevMask = 0, curMask = 0;
+    int nCorners = 0;
+
+    p = objSkipSpaces(p, end);
+    while (p < end)
+    {
+        p = objParseCorner(p, end, obj, cur, curMask);
+        if (nCorners == 0)
+        {
+            first = cur;
+            firstMask = curMask;
+        }
+        else if (nCorners >= 2)
+        {
+            if (relative && (firstMask | prevMask | curMask))
+            {
+                uint64_t base = obj.corners.size();
+                if (firstMask) relative->push_back((base + 0) * 8 + firstMask);
+                if (prevMask) relative->push_back((base + 1) * 8 + prevMask);
+                if (curMask) relative->push_back((base + 2) * 8 + curMask);
+            }
+            obj.corners.push_back(first);
+            obj.corners.push_back(prev);
+            obj.corners.push_back(cur);
+        }
+        prev = cur;
+        prevMask = curMask;
+        ++nCorners;
+        p = objSkipSpaces(p, end);
+    }
+}
+
+// Restante da linha, sem os espaços das pontas (nomes de arquivo e de material)
+inline std::string objParseName(const char *p, const char *end)
+{
+    p = objSkipSpaces(p, end);
+    while (end > p && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+        --end;
+    return std::string(p, end);
+}
+
+// Compara o início da linha com uma palavra-chave seguida de espaço
+inline bool objKeyword(const char *p, const char *end, const char *keyword)
+{
+    size_t n = std::strlen(keyword);
+    return (size_t)(end - p) > n && std::memcmp(p, keyword, n) == 0 && (p[n] == ' ' || p[n] == '\t');
+}
+
+// Processa uma linha (sem o '\n')
+inline void objParseLine(const char *p, const char *end, ObjData &obj, ScratchVector<uint64_t> *relative)
+{
+    p = objSkipSpaces(p, end);
+    if (end - p < 2)
+        return;
+
+    if (p[0] == 'v')
+    {
+        if (p[1] == ' ' || p[1] == '\t')
+        {
+            glm::vec3 vertice;
+            p = objParseFloat(p + 1, end, vertice.x);
+            p = objParseFloat(p, end, vertice.y);
+            objParseFloat(p, end, vertice.z);
+            obj.vertices.push_back(vertice);
+        }
+        else if (p[1] == 't')
+        {
+            glm::vec2 vt;
+            p = objParseFloat(p + 2, end, vt.s);
+            objParseFloat(p, end, vt.t);
+            obj.texCoords.push_back(vt);
+        }
+        else if (p[1] == 'n')
+        {
+            glm::vec3 normal;
+            p = objParseFloat(p + 2, end, normal.x);
+            p = objParseFloat(p, end, normal.y);
+            objParseFloat(p, end, normal.z);
+            obj.normals.push_back(normal);
+        }
+    }
+    else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+    {
+        objParseFace(p + 1, end, obj, relative);
+    }
+    else if (objKeyword(p, end, "usemtl"))
+    {
+        obj.materialRanges.push_back({objParseName(p + 6, end), obj.corners.size()});
+    }
+    else if (objKeyword(p, end, "mtllib"))
+    {
+        obj.materialLibs.push_back(objParseName(p + 6, end));
+    }
+    else if (p[0] == 's' && (p[1] == ' ' || p[1] == '\t'))
+    {
+        // "s off" e "s 0" desligam a suavização
+        p = objSkipSpaces(p + 1, end);
+        unsigned group = 0;
+        std::from_chars(p, end, group);
+        obj.smoothingRanges.push_back({(uint32_t)group, obj.corners.size()});
+    }
+    else if ((p[0] == 'o' || p[0] == 'g') && (p[1] == ' ' || p[1] == '\t'))
+    {
+        obj.objectRanges.push_back({objParseName(p + 1, end), obj.corners.size(), p[0] == 'g'});
+    }
+}
+
+// Processa todas as linhas do intervalo [begin, end)
+inline void parseOBJ(const char *begin, const char *end, ObjData &obj, ScratchVector<uint64_t> *relative = nullptr)
+{
+    const char *p = begin;
+    while (p < end)
+    {
+        const char *lineEnd = (const char *)std::memchr(p, '\n', end - p);
+        if (!lineEnd)
+            lineEnd = end;
+        objParseLine(p, lineEnd, obj, relative);
+        p = lineEnd + 1;
+    }
+}
+
+// Tamanho mínimo de cada bloco na leitura paralela: abaixo disso o custo de
+// criar threads supera o ganho
+const size_t OBJ_MIN_CHUNK_BYTES = 256 * 1024;
+
+// Leitura paralela: o arquivo é dividido em blocos que terminam em '\n', cada
+// bloco é lido por uma thread em um ObjData local e, no fim, os blocos são
+// concatenados em ordem. Os índices relativos de cada bloco são corrigidos com
+// a soma de prefixos das contagens dos blocos anteriores, de modo que o
+// resultado é idêntico (bit a bit) ao de parseOBJ.
+inline void parseOBJParallel(const char *begin, const char *end, ObjData &obj, unsigned nThreads)
+{
+    size_t size = (size_t)(end - begin);
+    size_t maxChunks = size / OBJ_MIN_CHUNK_BYTES;
+    size_t nChunks = std::min<size_t>(nThreads, maxChunks);
+    if (nChunks <= 1 || !obj.vertices.empty() || !obj.texCoords.empty() || !obj.normals.empty() || !obj.corners.empty() ||
+        !obj.materialLibs.empty() || !obj.materialRanges.empty() || !obj.smoothingRanges.empty() ||
+        !obj.objectRanges.empty())
+    {
+        parseOBJ(begin, end, obj);
+        return;
+    }
+
+    // Limites dos blocos, sempre logo após um '\n'
+    ScratchVector<const char *> bounds(nChunks + 1);
+    bounds[0] = begin;
+    bounds[nChunks] = end;
+    for (size_t i = 1; i < nChunks; i++)
+    {
+        const char *p = std::max(begin + size * i / nChunks, bounds[i - 1]);
+        const char *nl = (const char *)std::memchr(p, '\n', end - p);
+        bounds[i] = nl ? nl + 1 : end;
+    }
+
+    ScratchVector<ObjData> chunks(nChunks);
+    ScratchVector<ScratchVector<uint64_t>> relative(nChunks);
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < nChunks; i++)
+        workers.emplace_back([&, i]() { parseOBJ(bounds[i], bounds[i + 1], chunks[i], &relative[i]); });
+    for (std::thread &w : workers)
+        w.join();
+    workers.clear();
+
+    // Soma de prefixos das contagens de cada bloco
+    ScratchVector<size_t> vBase(nChunks + 1, 0), tBase(nChunks + 1, 0), nBase(nChunks + 1, 0), cBase(nChunks + 1, 0);
+    for (size_t i = 0; i < nChunks; i++)
+    {
+        vBase[i + 1] = vBase[i] + chunks[i].vertices.size();
+        tBase[i + 1] = tBase[i] + chunks[i].texCoords.size();
+        nBase[i + 1] = nBase[i] + chunks[i].normals.size();
+        cBase[i + 1] = cBase[i] + chunks[i].corners.size();
+    }
+    obj.vertices.resize(vBase[nChunks]);
+    obj.texCoords.resize(tBase[nChunks]);
+    obj.normals.resize(nBase[nChunks]);
+    obj.corners.resize(cBase[nChunks]);
+
+    // Cada thread copia o seu bloco para a posição final e corrige os índices
+    for (size_t i = 0; i < nChunks; i++)
+    {
+        workers.emplace_back([&, i]()
+        {
+            ObjData &c = chunks[i];
+            std::copy(c.vertices.begin(), c.vertices.end(), obj.vertices.begin() + vBase[i]);
+            std::copy(c.texCoords.begin(), c.texCoords.end(), obj.texCoords.begin() + tBase[i]);
+            std::copy(c.normals.begin(), c.normals.end(), obj.normals.begin() + nBase[i]);
+            for (uint64_t r : relative[i])
+            {
+                ObjCorner &corner = c.corners[r >> 3];
+                if (r & 1u) corner.v += (int)vBase[i];
+                if (r & 2u) corner.t += (int)tBase[i];
+                if (r & 4u) corner.n += (int)nBase[i];
+            }
+            std::copy(c.corners.begin(), c.corners.end(), obj.corners.begin() + cBase[i]);
+            // Libera o bloco já copiado. A troca usa o mesmo recurso do vetor:
+            // nesta thread não há ScratchScope, e a atribuição de um vetor de
+            // outro recurso só moveria os elementos, mantendo a memória.
+            ScratchVector<glm::vec3>(c.vertices.get_allocator()).swap(c.vertices);
+            ScratchVector<glm::vec2>(c.texCoords.get_allocator()).swap(c.texCoords);
+            ScratchVector<glm::vec3>(c.normals.get_allocator()).swap(c.normals);
+            ScratchVector<ObjCorner>(c.corners.get_allocator()).swap(c.corners);
+        });
+    }
+    for (std::thread &w : workers)
+        w.join();
+
+    // Materiais, grupos de suavização e objetos: poucos registros, concatenados em ordem
+    for (size_t i = 0; i < nChunks; i++)
+    {
+        for (std::string &lib : chunks[i].materialLibs)
+            obj.materialLibs.push_back(std::move(lib));
+        for (ObjMaterialRange &range : chunks[i].materialRanges)
+            obj.materialRanges.push_back({std::move(range.name), range.firstCorner + cBase[i]});
+        for (const ObjSmoothingRange &range : chunks[i].smoothingRanges)
+            obj.smoothingRanges.push_back({range.group, range.firstCorner + cBase[i]});
+        for (ObjObjectRange &range : chunks[i].objectRanges)
+            obj.objectRanges.push_back({std::move(range.name), range.firstCorner + cBase[i], range.group});
+    }
+}
+
+// nThreads = 0 usa todos os núcleos disponíveis; 1 força a leitura serial
+inline bool parseOBJFile(const std::string &filePATH, ObjData &obj, unsigned nThreads = 1)
+{
+    MappedFile file;
+    if (!file.open(filePATH))
+    {
+        std::cerr << "Erro ao tentar ler o arquivo " << filePATH << std::endl;
+        return false;
+    }
+    if (nThreads == 0)
+        nThreads = std::max(1u, std::thread::hardware_concurrency());
+    parseOBJParallel(file.data(), file.data() + file.size(), obj, nThreads);
+    return true;
+}
@@ -0,0 +1,347 @@
+/*
+ *  ObjStream - leitura de .OBJ em fluxo, com memória limitada
+ *
+ *  `parseOBJFile` guarda todos os cantos de face (`corners`) antes da soldagem
+ *  e o carregador ainda monta os bytes do VBO/EBO inteiros na RAM: o pico de
+ *  memória é várias vezes o tamanho final na GPU. Para varreduras 3D de
+ *  vários GB, `ObjStream` lê o arquivo em janelas de tamanho fixo e entrega
+ *  lotes de triângulos já soldados, que o chamador envia à GPU e descarta:
+ *
+ *  1. Uma primeira passada só conta os registros (v, vt, vn e triângulos).
+ *     Com isso as tabelas de atributos são reservadas no tamanho exato e o
+ *     orçamento é verificado antes de qualquer alocação grande.
+ *  2. Na segunda passada, as faces são lidas até encher um lote, soldadas
+ *     dentro do lote (a tabela hash é limpa a cada lote) e entregues por
+ *     `next`. Os cantos, a tabela hash e o lote são reaproveitados.
+ *
+ *  As tabelas v/vt/vn ficam na memória até o fim, pois uma face pode
+ *  referenciar qualquer registro anterior. O orçamento cobre as tabelas, a
+ *  janela de leitura e o lote; o que sobrar das tabelas e da janela define o
+ *  tamanho do lote. A soldagem por lote duplica só os vértices das fronteiras
+ *  entre lotes.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  ObjStream stream;
+ *  if (stream.open("scan.obj", 256u << 20))   // orçamento de 256 MB
+ *  {
+ *      ObjStreamBatch batch;
+ *      while (stream.next(batch))
+ *          ... // batch.vertices, batch.indices (locais ao lote), batch.parts
+ *  }
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "MeshBuilder.h"
+#include "ObjParser.h"
+
+// Memória de cada triângulo do lote: 3 cantos lidos, até 3 vértices soldados,
+// 3 índices e as entradas da tabela hash (nó + balde)
+const size_t OBJ_STREAM_BYTES_PER_TRIANGLE = 3 * (sizeof(ObjCorner) + sizeof(MeshVertex) + sizeof(uint32_t) + 48);
+// Limites da janela de leitura e do lote (lotes maiores não ganham nada)
+const size_t OBJ_STREAM_MIN_WINDOW = 64 * 1024;
+const size_t OBJ_STREAM_MAX_WINDOW = 8 * 1024 * 1024;
+const size_t OBJ_STREAM_MIN_BATCH = 4096;
+const size_t OBJ_STREAM_MAX_BATCH = 1 << 20;
+
+struct ObjStreamCounts
+{
+    size_t vertices = 0, texCoords = 0, normals = 0, triangles = 0;
+};
+
+// Lote de triângulos soldados; os índices começam em 0 a cada lote e `parts`
+// dá o material e o objeto de cada faixa de índices do lote
+struct ObjStreamBatch
+{
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<Submesh> parts;
+};
+
+// Linhas de um arquivo lido em janelas de tamanho fixo. Uma linha maior que a
+// janela faz a janela crescer (só acontece com linhas patológicas).
+class ObjLineReader
+{
+public:
+    ~ObjLineReader() { close(); }
+
+    bool open(const std::string &filePath, size_t windowBytes)
+    {
+        close();
+        file = std::fopen(filePath.c_str(), "rb");
+        if (!file)
+            return false;
+        // A janela já é o buffer de leitura: sem o buffer interno do FILE
+        std::setvbuf(file, nullptr, _IONBF, 0);
+        window.resize(windowBytes);
+        rewind();
+        return true;
+    }
+
+    void close()
+    {
+        if (file)
+            std::fclose(file);
+        file = nullptr;
+    }
+
+    void rewind()
+    {
+        std::rewind(file);
+        pos = filled = 0;
+        eof = false;
+    }
+
+    // Próxima linha, sem o '\n'. Retorna false no fim do arquivo.
+    bool nextLine(const char *&begin, const char *&end)
+    {
+        while (true)
+        {
+            const char *p = window.data() + pos;
+            const char *nl = (const char *)std::memchr(p, '\n', filled - pos);
+            if (nl)
+            {
+                begin = p;
+                end = nl;
+                pos = (size_t)(nl - window.data()) + 1;
+                return true;
+            }
+            if (eof)
+            {
+                if (pos == filled)
+                    return false;
+                begin = p;
+                end = window.data() + filled;
+                pos = filled;
+                return true;
+            }
+            // Move o início da linha incompleta para o começo da janela e lê mais
+            size_t tail = filled - pos;
+            std::memmove(window.data(), p, tail);
+            pos = 0;
+            filled = tail;
+            if (filled == window.size())
+                window.resize(window.size() * 2);
+            size_t wanted = window.size() - filled;
+            size_t got = std::fread(window.data() + filled, 1, wanted, file);
+            filled += got;
+            eof = got < wanted;
+        }
+    }
+
+    size_t windowBytes() const { return window.capacity(); }
+
+private:
+    std::FILE *file = nullptr;
+    std::vector<char> window;
+    size_t pos = 0, filled = 0;
+    bool eof = false;
+};
+
+// Contagem de registros de uma linha (primeira passada)
+inline void objCountLine(const char *p, const char *end, ObjStreamCounts &counts)
+{
+    p = objSkipSpaces(p, end);
+    if (end - p < 2)
+        return;
+    if (p[0] == 'v')
+    {
+        if (p[1] == ' ' || p[1] == '\t')
+            counts.vertices++;
+        else if (p[1] == 't')
+            counts.texCoords++;
+        else if (p[1] == 'n')
+            counts.normals++;
+    }
+    else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+    {
+        // Mesma triangulação em leque de objParseFace: n cantos, n - 2 triângulos
+        size_t nCorners = 0;
+        p = objSkipSpaces(p + 1, end);
+        while (p < end)
+        {
+            while (p < end && *p != ' ' && *p != '\t' && *p != '\r')
+                ++p;
+            nCorners++;
+            p = objSkipSpaces(p, end);
+        }
+        if (nCorners >= 3)
+            counts.triangles += nCorners - 2;
+    }
+}
+
+class ObjStream
+{
+public:
+    // Conta os registros e prepara a segunda passada. Falha se o arquivo não
+    // abrir ou se o orçamento não comportar as tabelas de atributos.
+    bool open(const std::string &filePath, size_t budgetBytes)
+    {
+        size_t windowSize = std::min(std::max(budgetBytes / 16, OBJ_STREAM_MIN_WINDOW), OBJ_STREAM_MAX_WINDOW);
+        if (!reader.open(filePath, windowSize))
+        {
+            std::cerr << "Erro ao tentar ler o arquivo " << filePath << std::endl;
+            return false;
+        }
+
+        fileCounts = ObjStreamCounts();
+        const char *begin, *end;
+        while (reader.nextLine(begin, end))
+            objCountLine(begin, end, fileCounts);
+
+        size_t tableBytes = fileCounts.vertices * sizeof(glm::vec3) + fileCounts.texCoords * sizeof(glm::vec2) +
+                            fileCounts.normals * sizeof(glm::vec3);
+        size_t fixedBytes = tableBytes + reader.windowBytes();
+        if (budgetBytes < fixedBytes + OBJ_STREAM_MIN_BATCH * OBJ_STREAM_BYTES_PER_TRIANGLE)
+        {
+            std::cerr << "Erro: o orcamento de " << (budgetBytes >> 20) << " MB nao comporta as tabelas de "
+                      << (tableBytes >> 20) << " MB de " << filePath << std::endl;
+            return false;
+        }
+        batchTriangles = std::min((budgetBytes - fixedBytes) / OBJ_STREAM_BYTES_PER_TRIANGLE, OBJ_STREAM_MAX_BATCH);
+
+        obj = ObjData();
+        obj.vertices.reserve(fileCounts.vertices);
+        obj.texCoords.reserve(fileCounts.texCoords);
+        obj.normals.reserve(fileCounts.normals);
+        obj.corners.reserve(batchTriangles * 3 + 64);
+        welded.reserve(batchTriangles * 3);
+        names.clear();
+        nameIds.clear();
+        objects.clear();
+        objectIds.clear();
+        partName = ObjPartName();
+        currentMaterial = currentObject = 0;
+        hasMaterial = hasObject = false;
+        reader.rewind();
+        return true;
+    }
+
+    // Lê faces até encher um lote. Retorna false quando não há mais triângulos.
+    bool next(ObjStreamBatch &batch)
+    {
+        batch.vertices.clear();
+        batch.indices.clear();
+        batch.parts.clear();
+        obj.corners.clear();
+        obj.materialRanges.clear();
+        obj.smoothingRanges.clear();
+        obj.objectRanges.clear();
+
+        const char *begin, *end;
+        while (obj.corners.size() < batchTriangles * 3 && reader.nextLine(begin, end))
+            objParseLine(begin, end, obj, nullptr);
+        if (obj.corners.empty())
+            return false;
+
+        // Soldagem dentro do lote
+        welded.clear();
+        batch.vertices.reserve(batchTriangles * 3);
+        batch.indices.reserve(obj.corners.capacity());
+        for (const ObjCorner &c : obj.corners)
+        {
+            auto it = welded.emplace(c, (uint32_t)batch.vertices.size());
+            if (it.second)
+            {
+                MeshVertex vertex;
+                vertex.position = objAttribute(obj.vertices, c.v);
+                vertex.texCoord = objAttribute(obj.texCoords, c.t);
+                vertex.normal = objAttribute(obj.normals, c.n);
+                batch.vertices.push_back(vertex);
+            }
+            batch.indices.push_back(it.first->second);
+        }
+
+        // Faixas de material e objeto do lote; o material e o objeto atuais
+        // passam para o lote seguinte
+        size_t range = 0, objectRange = 0;
+        for (size_t corner = 0; corner < obj.corners.size(); corner += 3)
+        {
+            while (range < obj.materialRanges.size() && obj.materialRanges[range].firstCorner <= corner)
+                selectMaterial(obj.materialRanges[range++].name);
+            if (objectRange < obj.objectRanges.size() && obj.objectRanges[objectRange].firstCorner <= corner)
+            {
+                while (objectRange < obj.objectRanges.size() && obj.objectRanges[objectRange].firstCorner <= corner)
+                    partName.apply(obj.objectRanges[objectRange++]);
+                hasObject = false;
+            }
+            if (!hasMaterial)
+                selectMaterial("");
+            if (!hasObject)
+                selectObject(partName.name());
+            if (batch.parts.empty() || batch.parts.back().material != currentMaterial || batch.parts.back().object != currentObject)
+                batch.parts.push_back({(uint32_t)corner, 0, currentMaterial, 0, currentObject});
+            batch.parts.back().indexCount += 3;
+        }
+        while (range < obj.materialRanges.size())
+            selectMaterial(obj.materialRanges[range++].name);
+        // Um `o`/`g` depois da última face só vale a partir do próximo lote
+        while (objectRange < obj.objectRanges.size())
+        {
+            partName.apply(obj.objectRanges[objectRange++]);
+            hasObject = false;
+        }
+        return true;
+    }
+
+    const ObjStreamCounts &counts() const { return fileCounts; }
+    size_t trianglesPerBatch() const { return batchTriangles; }
+    // Nomes na ordem do primeiro `usemtl` ("" = faces sem material)
+    const std::vector<std::string> &materialNames() const { return names; }
+    std::vector<std::string> materialLibs() const { return std::vector<std::string>(obj.materialLibs.begin(), obj.materialLibs.end()); }
+    // Nomes na ordem do primeiro `o`/`g` com faces ("" = faces antes deles)
+    const std::vector<std::string> &objectNames() const { return objects; }
+
+    // Memória reservada pelo leitor (tabelas, janela e lote)
+    size_t memoryBytes() const
+    {
+        return obj.vertices.capacity() * sizeof(glm::vec3) + obj.texCoords.capacity() * sizeof(glm::vec2) +
+               obj.normals.capacity() * sizeof(glm::vec3) + reader.windowBytes() +
+               batchTriangles * OBJ_STREAM_BYTES_PER_TRIANGLE;
+    }
+
+private:
+    void selectMaterial(const std::string &name)
+    {
+        auto it = nameIds.emplace(name, (uint32_t)names.size());
+        if (it.second)
+            names.push_back(name);
+        currentMaterial = it.first->second;
+        hasMaterial = true;
+    }
+
+    void selectObject(const std::string &name)
+    {
+        auto it = objectIds.emplace(name, (uint32_t)objects.size());
+        if (it.second)
+            objects.push_back(name);
+        currentObject = it.first->second;
+        hasObject = true;
+    }
+
+    ObjLineReader reader;
+    ObjStreamCounts fileCounts;
+    ObjData obj; // tabelas v/vt/vn completas; cantos só do lote atual
+    std::unordered_map<ObjCorner, uint32_t, ObjCornerHash, ObjCornerEqual> welded;
+    size_t batchTriangles = 0;
+    std::vector<std::string> names;
+    std::unordered_map<std::string, uint32_t> nameIds;
+    std::vector<std::string> objects;
+    std::unordered_map<std::string, uint32_t> objectIds;
+    ObjPartName partName;
+    uint32_t currentMaterial = 0, currentObject = 0;
+    bool hasMaterial = false, hasObject = false;
+};
@@ -0,0 +1,52 @@
+/*
+ *  ParallelFor - divide um intervalo de índices entre threads
+ *
+ *  `parallelFor(n, nThreads, f)` chama f(begin, end) para blocos contíguos
+ *  de [0, n), um por thread. Com nThreads = 0 usa todos os núcleos; abaixo de
+ *  `minPerThread` itens por thread o trabalho roda na thread atual (criar
+ *  threads custa mais que o ganho).
+ *
+ *  Forma de uso
+ *  -----------------
+ *  parallelFor(triangles.size(), 0, [&](size_t begin, size_t end)
+ *  {
+ *      for (size_t t = begin; t < end; t++)
+ *          ...
+ *  });
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+inline unsigned resolveThreadCount(unsigned nThreads)
+{
+    return nThreads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : nThreads;
+}
+
+// Número de blocos (um por thread) em que parallelFor divide n itens; 1 quando
+// tudo roda na thread atual
+inline size_t parallelChunkCount(size_t n, unsigned nThreads, size_t minPerThread = 16384)
+{
+    return std::min<size_t>(resolveThreadCount(nThreads), std::max<size_t>(n / minPerThread, 1));
+}
+
+template <typename F>
+inline void parallelFor(size_t n, unsigned nThreads, F f, size_t minPerThread = 16384)
+{
+    size_t nChunks = parallelChunkCount(n, nThreads, minPerThread);
+    if (nChunks <= 1)
+    {
+        f((size_t)0, n);
+        return;
+    }
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < nChunks; i++)
+        workers.emplace_back([&, i]() { f(n * i / nChunks, n * (i + 1) / nChunks); });
+    f((size_t)0, n / nChunks);
+    for (std::thread &w : workers)
+        w.join();
+}
@@ -0,0 +1,351 @@
+/*
+ *  TextureAtlas - várias imagens em uma única textura, para desenhar
+ *  objetos com texturas diferentes na mesma chamada de desenho
+ *
+ *  Cada glBindTexture entre dois desenhos obriga a uma chamada de desenho
+ *  separada; com muitas texturas pequenas, trocar de textura domina o tempo
+ *  de CPU do quadro. O atlas junta as imagens em páginas de
+ *  ATLAS_PAGE_SIZE x ATLAS_PAGE_SIZE texels, que são as camadas de um único
+ *  GL_TEXTURE_2D_ARRAY: vinculado uma vez, ele serve para todos os objetos.
+ *  Cada imagem vira uma região (`AtlasRegion`), com a camada e o retângulo
+ *  de coordenadas de textura dela, que o shader recebe por objeto (por
+ *  instância, em glDrawArraysInstanced):
+ *
+ *      uniform sampler2DArray atlas;
+ *      ...
+ *      texture(atlas, vec3(uvRect.xy + texCoord * uvRect.zw, layer))
+ *
+ *  AtlasInstances.h faz o envio por instância e as chamadas de desenho.
+ *
+ *  As imagens são distribuídas nas páginas por um empacotador skyline (a
+ *  mais alta primeiro, cada uma na posição mais baixa em que cabe). Em volta
+ *  de cada imagem, ATLAS_PADDING texels repetem a borda dela, para que a
+ *  filtragem linear e os mipmaps não misturem imagens vizinhas; por isso os
+ *  mipmaps param no nível log2(ATLAS_PADDING). Uma imagem maior que a página
+ *  é reduzida à metade até caber.
+ *
+ *  As coordenadas de textura dos objetos devem ficar em [0, 1]: GL_REPEAT
+ *  não funciona dentro de uma região (uma textura que se repete deve ficar
+ *  fora do atlas, no TextureManager).
+ *
+ *  Só a thread da OpenGL deve usar o atlas, e `clear` deve ser chamado
+ *  antes de glfwTerminate.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  TextureAtlas atlas;
+ *  int wall = atlas.add("../assets/tex/pixelWall.png");
+ *  int uv = atlas.add("../assets/Modelos3D/SuzanneUV.png");
+ *  atlas.build(); // decodificadas na hora do add, enviadas aqui
+ *  ...
+ *  glBindTexture(GL_TEXTURE_2D_ARRAY, atlas.id()); // uma vez para todos
+ *  const AtlasRegion &region = atlas.region(wall); // region.uvRect, region.layer
+ *  ...
+ *  atlas.clear(); // antes de glfwTerminate
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// GLAD
+#include <glad/glad.h>
+
+// GLM
+#include <glm/glm.hpp>
+
+// STB_IMAGE (a implementação, STB_IMAGE_IMPLEMENTATION, fica no programa)
+#include <stb_image.h>
+
+#include "MipGenerator.h"
+
+// Largura e altura de cada página (camada do GL_TEXTURE_2D_ARRAY)
+const int ATLAS_PAGE_SIZE = 2048;
+// Texels de borda repetida em volta de cada imagem: com 4, os níveis 1 e 2
+// dos mipmaps ainda não misturam imagens vizinhas
+const int ATLAS_PADDING = 4;
+const int ATLAS_MIP_LEVELS = 3;
+
+// Empacotador skyline: guarda o contorno de cima da área já ocupada
+// (segmentos com x, largura e altura) e põe cada retângulo na posição mais
+// baixa em que ele cabe (no empate, a mais à esquerda)
+class SkylinePacker
+{
+public:
+    SkylinePacker(int width, int height) : width(width), height(height)
+    {
+        skyline.push_back({0, 0, width});
+    }
+
+    // Posição de um retângulo w x h; false se não couber
+    bool insert(int w, int h, int &x, int &y)
+    {
+        int bestY = INT_MAX;
+        size_t best = skyline.size();
+        for (size_t i = 0; i < skyline.size(); i++)
+        {
+            int top;
+            if (fits(i, w, h, top) && top < bestY)
+            {
+                bestY = top;
+                best = i;
+            }
+        }
+        if (best == skyline.size())
+            return false;
+        x = skyline[best].x;
+        y = bestY;
+        place(best, x, y + h, w);
+        return true;
+    }
+
+private:
+    struct Segment
+    {
+        int x, y, width;
+    };
+
+    // Altura em que um retângulo apoiado a partir do segmento i fica
+    bool fits(size_t i, int w, int h, int &top) const
+    {
+        if (skyline[i].x + w > width)
+            return false;
+        top = 0;
+        for (size_t j = i; j < skyline.size() && skyline[j].x < skyline[i].x + w; j++)
+            top = std::max(top, skyline[j].y);
+        return top + h <= height;
+    }
+
+    // Novo segmento [x, x + w) na altura `top`, cobrindo os que ficam embaixo
+    void place(size_t i, int x, int top, int w)
+    {
+        skyline.insert(skyline.begin() + i, Segment{x, top, w});
+        for (size_t j = i + 1; j < skyline.size();)
+        {
+            int covered = x + w - skyline[j].x;
+            if (covered <= 0)
+                break;
+            skyline[j].x += covered;
+            skyline[j].width -= covered;
+            if (skyline[j].width > 0)
+                break;
+            skyline.erase(skyline.begin() + j);
+        }
+        for (size_t j = 0; j + 1 < skyline.size();)
+        {
+            if (skyline[j].y == skyline[j + 1].y)
+            {
+                skyline[j].width += skyline[j + 1].width;
+                skyline.erase(skyline.begin() + j + 1);
+            }
+            else
+                j++;
+        }
+    }
+
+    int width, height;
+    std::vector<Segment> skyline; // da esquerda para a direita
+};
+
+// Lugar de uma imagem no atlas
+struct AtlasRegion
+{
+    std::string path;
+    int layer = 0;             // camada do GL_TEXTURE_2D_ARRAY
+    int x = 0, y = 0;          // canto da imagem na camada (sem a borda)
+    int width = 0, height = 0; // tamanho na camada (menor que o da imagem se ela foi reduzida)
+    glm::vec4 uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f); // uv na camada = uvRect.xy + uv * uvRect.zw
+};
+
+class TextureAtlas
+{
+public:
+    // srgb: páginas em GL_SRGB8_ALPHA8 (a OpenGL converte para linear na
+    // amostragem) e mipmaps com a média em espaço linear; senão, GL_RGBA8 e
+    // a média direto dos bytes, como a filtragem da OpenGL faz com eles
+    explicit TextureAtlas(int pageSize = ATLAS_PAGE_SIZE, bool srgb = false) : pageSize(pageSize), srgb(srgb) {}
+    ~TextureAtlas() { clear(); }
+
+    TextureAtlas(const TextureAtlas &) = delete;
+    TextureAtlas &operator=(const TextureAtlas &) = delete;
+
+    // Decodifica a imagem e reserva a região dela; retorna o índice da região
+    // (o mesmo para um arquivo já adicionado). Uma imagem que não pode ser
+    // lida vira um texel branco.
+    int add(const std::string &filePath)
+    {
+        auto found = indices.find(filePath);
+        if (found != indices.end())
+            return found->second;
+
+        Image image;
+        int channels;
+        unsigned char *data = stbi_load(filePath.c_str(), &image.width, &image.height, &channels, 4);
+        if (data)
+        {
+            image.pixels.assign(data, data + (size_t)image.width * image.height * 4);
+            stbi_image_free(data);
+        }
+        else
+        {
+            std::cout << "Failed to load texture: " << filePath << std::endl;
+            image.width = image.height = 1;
+            image.pixels.assign(4, 255);
+        }
+        // Reduz à metade até caber em uma página com a borda
+        while (image.width + 2 * ATLAS_PADDING > pageSize || image.height + 2 * ATLAS_PADDING > pageSize)
+        {
+            std::vector<uint8_t> half((size_t)std::max(image.width / 2, 1) * std::max(image.height / 2, 1) * 4);
+            downsampleRGBA8(image.pixels.data(), image.width, image.height, half.data(), srgb);
+            image.width = std::max(image.width / 2, 1);
+            image.height = std::max(image.height / 2, 1);
+            image.pixels.swap(half);
+        }
+
+        AtlasRegion region;
+        region.path = filePath;
+        region.width = image.width;
+        region.height = image.height;
+        regions.push_back(region);
+        images.push_back(std::move(image));
+        int index = (int)regions.size() - 1;
+        indices[filePath] = index;
+        return index;
+    }
+
+    // Empacota as imagens adicionadas, monta as páginas com os mipmaps e as
+    // envia como camadas do GL_TEXTURE_2D_ARRAY. Pode ser chamado de novo
+    // depois de novos `add` (as páginas são refeitas).
+    void build()
+    {
+        if (images.empty())
+            return;
+
+        std::vector<int> order(images.size());
+        for (size_t i = 0; i < order.size(); i++)
+            order[i] = (int)i;
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return images[a].height > images[b].height; });
+
+        std::vector<SkylinePacker> packers;
+        for (int i : order)
+        {
+            AtlasRegion &region = regions[i];
+            int w = paddedSize(region.width), h = paddedSize(region.height), x = 0, y = 0;
+            size_t page = 0;
+            while (page < packers.size() && !packers[page].insert(w, h, x, y))
+                page++;
+            if (page == packers.size())
+            {
+                packers.emplace_back(pageSize, pageSize);
+                packers.back().insert(w, h, x, y);
+            }
+            region.layer = (int)page;
+            region.x = x + ATLAS_PADDING;
+            region.y = y + ATLAS_PADDING;
+            region.uvRect = glm::vec4((float)region.x, (float)region.y, (float)region.width, (float)region.height) / (float)pageSize;
+        }
+        pages = (int)packers.size();
+
+        if (!texture)
+            glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, ATLAS_MIP_LEVELS - 1);
+
+        std::vector<MipLevel> levels = mipLevels(pageSize, pageSize);
+        levels.resize(std::min<size_t>(levels.size(), ATLAS_MIP_LEVELS));
+        for (size_t l = 0; l < levels.size(); l++)
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, (GLint)l, srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8, levels[l].width, levels[l].height, pages, 0, GL_RGBA,
+                         GL_UNSIGNED_BYTE, nullptr);
+
+        // Uma página por vez: a imagem de cada região com a borda repetida,
+        // os mipmaps e o envio da camada
+        std::vector<uint8_t> chain(mipChainBytes(levels));
+        for (int page = 0; page < pages; page++)
+        {
+            std::fill(chain.begin(), chain.end(), 0);
+            for (size_t i = 0; i < regions.size(); i++)
+                if (regions[i].layer == page)
+                    blit(images[i], regions[i], chain.data());
+            if (levels.size() > 1)
+                generateMipChain(chain.data(), chain.data() + levels[1].offset, levels, srgb);
+            for (size_t l = 0; l < levels.size(); l++)
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, (GLint)l, 0, 0, page, levels[l].width, levels[l].height, 1, GL_RGBA,
+                                GL_UNSIGNED_BYTE, chain.data() + levels[l].offset);
+        }
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        bytes = mipChainBytes(levels) * (size_t)pages;
+    }
+
+    // Apaga a textura e esquece as imagens (antes de glfwTerminate)
+    void clear()
+    {
+        if (texture)
+            glDeleteTextures(1, &texture);
+        texture = 0;
+        pages = 0;
+        bytes = 0;
+        images.clear();
+        regions.clear();
+        indices.clear();
+    }
+
+    GLuint id() const { return texture; }
+    const AtlasRegion &region(int index) const { return regions[index]; }
+    size_t regionCount() const { return regions.size(); }
+    int pageCount() const { return pages; }
+    // Memória das páginas na GPU, com os mipmaps
+    size_t residentBytes() const { return bytes; }
+
+private:
+    struct Image
+    {
+        int width = 0, height = 0;
+        std::vector<uint8_t> pixels; // RGBA8
+    };
+
+    // Tamanho ocupado na página: a imagem com a borda, arredondado para
+    // múltiplo de 4 (assim os níveis 1 e 2 dos mipmaps não cruzam a borda)
+    static int paddedSize(int size)
+    {
+        return (size + 2 * ATLAS_PADDING + 3) & ~3;
+    }
+
+    // Copia a imagem para a página, com a borda (e o arredondamento) repetindo
+    // os texels da beira
+    void blit(const Image &image, const AtlasRegion &region, uint8_t *page) const
+    {
+        int x0 = region.x - ATLAS_PADDING, y0 = region.y - ATLAS_PADDING;
+        int w = paddedSize(region.width), h = paddedSize(region.height);
+        for (int y = 0; y < h; y++)
+        {
+            int sy = std::min(std::max(y - ATLAS_PADDING, 0), image.height - 1);
+            const uint8_t *src = image.pixels.data() + (size_t)sy * image.width * 4;
+            uint8_t *dst = page + ((size_t)(y0 + y) * pageSize + x0) * 4;
+            for (int x = 0; x < w; x++)
+            {
+                int sx = std::min(std::max(x - ATLAS_PADDING, 0), image.width - 1);
+                std::memcpy(dst + x * 4, src + sx * 4, 4);
+            }
+        }
+    }
+
+    int pageSize;
+    bool srgb;
+    GLuint texture = 0;
+    int pages = 0;
+    size_t bytes = 0;
+    std::vector<Image> images; // decodificadas, na ordem de `regions` (mantidas para um novo build)
+    std::vector<AtlasRegion> regions;
+    std::map<std::string, int> indices;
+};
@@ -0,0 +1,604 @@
+/*
+ *  TextureManager - texturas compartilhadas, carregadas uma única vez por arquivo
+ *
+ *  `load` devolve um TextureHandle (std::shared_ptr<const Texture>) para a
+ *  textura de um arquivo. Pedidos do mesmo arquivo com os mesmos parâmetros
+ *  de amostragem (wrap, filtros, anisotropia e sRGB) recebem a mesma textura
+ *  enquanto ela estiver em uso: a imagem é decodificada e enviada à GPU só
+ *  uma vez, mesmo que centenas de materiais usem o mesmo `pixelWall.png`. O
+ *  arquivo é identificado pelo caminho canônico, então "../assets/tex/a.png"
+ *  e "../assets/Modelos3D/../tex/a.png" são a mesma textura.
+ *
+ *  Quando o último handle é destruído, a textura é apagada da GPU
+ *  (glDeleteTextures); um pedido seguinte do mesmo arquivo a carrega de
+ *  novo. O gerenciador só guarda referências fracas (std::weak_ptr), então
+ *  ele nunca mantém uma textura viva sozinho.
+ *
+ *  A textura é criada com glTexStorage2D (OpenGL 4.2 ou ARB_texture_storage;
+ *  sem ela, um glTexImage2D por nível) num formato com tamanho que segue os
+ *  canais da imagem: R8 (cinza), RG8 (cinza e alfa), RGBA8 (RGB e RGBA) ou
+ *  SRGB8_ALPHA8 com TextureSampler::srgb. Os parâmetros de amostragem ficam
+ *  em objetos de amostragem (glBindSampler) compartilhados pelas texturas
+ *  iguais; `bindTexture` vincula os dois. Os mipmaps são gerados na CPU, com
+ *  o filtro TextureSampler::mipFilter (MipGenerator.h) e, nas texturas
+ *  sRGB, as cores em espaço linear.
+ *
+ *  Se a imagem tiver um .ktx2 pré-processado ao lado (pixelWall.png ->
+ *  pixelWall.ktx2, gerado pelo TextureCooker, ver KtxTexture.h), a textura
+ *  vem dele: os mipmaps já estão prontos e nada é decodificado. Os níveis
+ *  comprimidos (BC1, BC3 ou BC7) vão para a GPU como estão; se o driver não
+ *  tiver o formato, eles são descomprimidos para RGBA8 na carga.
+ *
+ *  Uma imagem que não pode ser lida, e o caminho "" (material sem map_Kd),
+ *  dão uma textura de um texel branco, que não altera as cores do material.
+ *
+ *  Só a thread da OpenGL deve usar o gerenciador, e os handles devem ser
+ *  destruídos antes de glfwTerminate. Para decodificar as imagens fora da
+ *  thread de desenho, ver AsyncTextureLoader.h.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  TextureSampler sampler;
+ *  sampler.anisotropy = 8.0f;
+ *  TextureHandle wall = textureManager().load("../assets/tex/pixelWall.png", sampler);
+ *  ...
+ *  bindTexture(*wall); // unidade 0
+ *  ...
+ *  wall.reset(); // antes de glfwTerminate
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// GLAD
+#include <glad/glad.h>
+
+// GLFW (glfwGetProcAddress, para as funções que a GLAD 4.0 não traz)
+#include <GLFW/glfw3.h>
+
+// STB_IMAGE (a implementação, STB_IMAGE_IMPLEMENTATION, fica no programa)
+#include <stb_image.h>
+
+#include "BlockCompression.h"
+#include "KtxTexture.h"
+#include "MipGenerator.h"
+
+// Formatos comprimidos das extensões EXT_texture_compression_s3tc,
+// EXT_texture_sRGB e ARB_texture_compression_bptc (núcleo na OpenGL 4.2) e
+// a anisotropia (EXT_texture_filter_anisotropic, núcleo na 4.6), que a GLAD
+// 4.0 não traz
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D
+#endif
+#ifndef GL_TEXTURE_MAX_ANISOTROPY
+#define GL_TEXTURE_MAX_ANISOTROPY 0x84FE
+#endif
+#ifndef GL_MAX_TEXTURE_MAX_ANISOTROPY
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY 0x84FF
+#endif
+
+// Parâmetros de amostragem, que fazem parte da identidade da textura
+struct TextureSampler
+{
+    GLenum wrapS = GL_REPEAT;
+    GLenum wrapT = GL_REPEAT;
+    GLenum minFilter = GL_LINEAR_MIPMAP_LINEAR; // trilinear; os mipmaps são criados se o filtro os usar
+    GLenum magFilter = GL_LINEAR;
+    float anisotropy = 1.0f; // filtragem anisotrópica (limitada à do driver); 1 = desligada
+    bool srgb = false;       // cores em sRGB (SRGB8_ALPHA8): a amostragem devolve valores lineares
+    MipFilter mipFilter = MipFilter::Box; // filtro dos mipmaps gerados na carga (MipGenerator.h)
+
+    bool usesMipmaps() const { return minFilter != GL_NEAREST && minFilter != GL_LINEAR; }
+};
+
+// Objeto de amostragem da OpenGL, compartilhado pelas texturas com os mesmos
+// parâmetros (ver sharedSampler)
+struct SamplerObject
+{
+    GLuint id = 0;
+
+    SamplerObject() = default;
+    SamplerObject(const SamplerObject &) = delete;
+    SamplerObject &operator=(const SamplerObject &) = delete;
+    ~SamplerObject()
+    {
+        if (id)
+            glDeleteSamplers(1, &id);
+    }
+};
+
+struct Texture
+{
+    GLuint id = 0;
+    int width = 0, height = 0;
+    int channels = 0;         // canais da imagem (1 = cinza, 2 = cinza e alfa, 3 = RGB, 4 = RGBA)
+    int levels = 0;           // níveis de mipmap na GPU
+    int baseLevel = 0;        // nível mais fino na GPU (os anteriores esperam o TextureStreamer.h)
+    GLenum internalFormat = 0; // GL_RGBA8, GL_R8, GL_COMPRESSED_...
+    size_t bytes = 0;         // memória na GPU, com os mipmaps
+    std::string path;         // caminho canônico ("" = texel branco)
+    TextureSampler sampler;
+    std::shared_ptr<const SamplerObject> samplerObject; // com os parâmetros de `sampler`
+    bool loading = false; // em carregamento (AsyncTextureLoader.h); até lá, um texel branco
+
+    Texture() = default;
+    Texture(const Texture &) = delete;
+    Texture &operator=(const Texture &) = delete;
+    ~Texture()
+    {
+        if (id)
+            glDeleteTextures(1, &id);
+    }
+};
+
+using TextureHandle = std::shared_ptr<const Texture>;
+
+// Vincula a textura e o seu objeto de amostragem na unidade `unit`
+inline void bindTexture(const Texture &texture, GLuint unit = 0)
+{
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, texture.id);
+    glBindSampler(unit, texture.samplerObject ? texture.samplerObject->id : 0);
+}
+
+// Memória na GPU de `levels` níveis a partir de width x height
+inline size_t textureBytes(int width, int height, int levels, int texelBytes)
+{
+    size_t bytes = 0;
+    for (int l = 0; l < levels; l++)
+        bytes += (size_t)std::max(width >> l, 1) * (size_t)std::max(height >> l, 1) * (size_t)texelBytes;
+    return bytes;
+}
+
+inline bool hasGLExtension(const char *name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++)
+    {
+        const char *extension = (const char *)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (extension && std::strcmp(extension, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+// Se o contexto é de uma OpenGL major.minor ou mais nova
+inline bool hasGLVersion(int major, int minor)
+{
+    static const int version = []()
+    {
+        GLint contextMajor = 0, contextMinor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &contextMajor);
+        glGetIntegerv(GL_MINOR_VERSION, &contextMinor);
+        return contextMajor * 10 + contextMinor;
+    }();
+    return version >= major * 10 + minor;
+}
+
+inline GLenum textureFormatGLEnum(TextureFormat format, bool srgb = false)
+{
+    switch (format)
+    {
+    case TextureFormat::BC1:
+        return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case TextureFormat::BC3:
+        return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case TextureFormat::BC7:
+        return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+    default:
+        return srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+    }
+}
+
+// Se o driver aceita o formato em glCompressedTexImage2D. Consultado uma vez,
+// na primeira chamada (com o contexto da OpenGL já criado).
+inline bool textureFormatSupported(TextureFormat format, bool srgb = false)
+{
+    static const bool s3tc = hasGLExtension("GL_EXT_texture_compression_s3tc");
+    static const bool s3tcSrgb = s3tc && hasGLExtension("GL_EXT_texture_sRGB");
+    static const bool bptc = hasGLVersion(4, 2) || hasGLExtension("GL_ARB_texture_compression_bptc");
+    if (format == TextureFormat::BC1 || format == TextureFormat::BC3)
+        return srgb ? s3tcSrgb : s3tc;
+    return format == TextureFormat::BC7 ? bptc : true;
+}
+
+// glTexStorage2D (OpenGL 4.2 ou ARB_texture_storage), carregada na primeira
+// chamada; nullptr se o driver não a tiver
+typedef void(APIENTRYP TexStorage2DProc)(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width,
+                                         GLsizei height);
+
+inline TexStorage2DProc texStorage2D()
+{
+    static const TexStorage2DProc storage = []() -> TexStorage2DProc
+    {
+        if (!hasGLVersion(4, 2) && !hasGLExtension("GL_ARB_texture_storage"))
+            return nullptr;
+        return (TexStorage2DProc)glfwGetProcAddress("glTexStorage2D");
+    }();
+    return storage;
+}
+
+// Maior anisotropia do driver (1 sem EXT/ARB_texture_filter_anisotropic)
+inline float maxTextureAnisotropy()
+{
+    static const float maximum = []()
+    {
+        GLfloat value = 1.0f;
+        if (hasGLVersion(4, 6) || hasGLExtension("GL_EXT_texture_filter_anisotropic") ||
+            hasGLExtension("GL_ARB_texture_filter_anisotropic"))
+            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &value);
+        return value;
+    }();
+    return maximum;
+}
+
+// Objeto de amostragem com os parâmetros de `sampler`, compartilhado com as
+// texturas que já o usam. Como as texturas, ele é apagado (glDeleteSamplers)
+// quando a última referência deixa de existir.
+inline std::shared_ptr<const SamplerObject> sharedSampler(const TextureSampler &sampler)
+{
+    using Key = std::tuple<GLenum, GLenum, GLenum, GLenum, float>;
+    static std::map<Key, std::weak_ptr<const SamplerObject>> samplers;
+
+    Key key(sampler.wrapS, sampler.wrapT, sampler.minFilter, sampler.magFilter, sampler.anisotropy);
+    auto found = samplers.find(key);
+    if (found != samplers.end())
+        if (std::shared_ptr<const SamplerObject> object = found->second.lock())
+            return object;
+
+    std::shared_ptr<SamplerObject> object(new SamplerObject());
+    glGenSamplers(1, &object->id);
+    glSamplerParameteri(object->id, GL_TEXTURE_WRAP_S, sampler.wrapS);
+    glSamplerParameteri(object->id, GL_TEXTURE_WRAP_T, sampler.wrapT);
+    glSamplerParameteri(object->id, GL_TEXTURE_MIN_FILTER, sampler.minFilter);
+    glSamplerParameteri(object->id, GL_TEXTURE_MAG_FILTER, sampler.magFilter);
+    float anisotropy = std::min(sampler.anisotropy, maxTextureAnisotropy());
+    if (anisotropy > 1.0f)
+        glSamplerParameterf(object->id, GL_TEXTURE_MAX_ANISOTROPY, anisotropy);
+
+    for (auto it = samplers.begin(); it != samplers.end();)
+        it = it->second.expired() ? samplers.erase(it) : std::next(it);
+    samplers[key] = object;
+    return object;
+}
+
+// Formato com tamanho na GPU e formato dos pixels enviados, para uma imagem
+// de `channels` canais. O RGB fica em RGBA8 (alfa 1): o driver guardaria
+// RGB8 em 4 bytes por texel de qualquer forma. Não há R8 e RG8 em sRGB:
+// com `srgb`, a imagem deve ser decodificada em RGBA.
+struct TexelFormat
+{
+    GLenum internalFormat;
+    GLenum pixelFormat; // dos pixels enviados
+    int pixelBytes;     // por texel, nos pixels enviados
+    int texelBytes;     // por texel, na GPU
+};
+
+inline TexelFormat texelFormat(int channels, bool srgb)
+{
+    GLenum rgba = srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+    switch (channels)
+    {
+    case 1:
+        return {GL_R8, GL_RED, 1, 1};
+    case 2:
+        return {GL_RG8, GL_RG, 2, 2};
+    case 3:
+        return {rgba, GL_RGB, 3, 4};
+    default:
+        return {rgba, GL_RGBA, 4, 4};
+    }
+}
+
+// Nas texturas R8 e RG8 vinculadas, o cinza vai para RGB e o segundo canal
+// para o alfa: o shader lê a mesma cor da imagem em RGBA
+inline void setChannelSwizzle(int channels)
+{
+    static const GLint gray[4] = {GL_RED, GL_RED, GL_RED, GL_ONE};
+    static const GLint grayAlpha[4] = {GL_RED, GL_RED, GL_RED, GL_GREEN};
+    if (channels == 1 || channels == 2)
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, channels == 1 ? gray : grayAlpha);
+}
+
+// Reserva os `levels` níveis da textura vinculada com glTexStorage2D: formato
+// e tamanhos ficam imutáveis, e o driver não precisa conferir a cadeia a cada
+// desenho. GL_TEXTURE_MAX_LEVEL para no último nível. Retorna false sem a
+// glTexStorage2D; aí cada nível é criado no seu envio.
+inline bool allocateTextureStorage(GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height)
+{
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    TexStorage2DProc storage = texStorage2D();
+    if (storage)
+        storage(GL_TEXTURE_2D, levels, internalFormat, width, height);
+    return storage != nullptr;
+}
+
+// Envia os pixels (ou o deslocamento no PBO vinculado) de um nível da textura
+// vinculada. Linhas sem múltiplo de 4 bytes (RGB, R8 ou RG8 de largura
+// ímpar) precisam de GL_UNPACK_ALIGNMENT 1, que volta ao padrão (4) depois.
+inline void uploadTextureLevel(bool immutable, GLint level, const TexelFormat &format, GLsizei width, GLsizei height,
+                               const void *pixels)
+{
+    bool aligned = (size_t)width * (size_t)format.pixelBytes % 4 == 0;
+    if (!aligned)
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (immutable)
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, format.pixelFormat, GL_UNSIGNED_BYTE, pixels);
+    else
+        glTexImage2D(GL_TEXTURE_2D, level, format.internalFormat, width, height, 0, format.pixelFormat, GL_UNSIGNED_BYTE,
+                     pixels);
+    if (!aligned)
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+// Como uploadTextureLevel, para um nível de blocos comprimidos
+inline void uploadCompressedLevel(bool immutable, GLint level, GLenum internalFormat, GLsizei width, GLsizei height,
+                                  size_t size, const void *blocks)
+{
+    if (immutable)
+        glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, internalFormat, (GLsizei)size, blocks);
+    else
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, width, height, 0, (GLsizei)size, blocks);
+}
+
+// Confere a cadeia de mipmaps da textura vinculada. Com um filtro de
+// mipmaps, todos os níveis até 1x1 precisam estar na GPU (uma cadeia cortada
+// serrilha a minificação); sem ele, só o nível 0 (os outros seriam memória
+// que nunca é lida). Cada nível deve ter metade do anterior e
+// GL_TEXTURE_MAX_LEVEL, parar no último. Mostra o problema e retorna false.
+inline bool validateMipChain(const Texture &texture)
+{
+    int expected = texture.sampler.usesMipmaps() ? (int)mipLevels(texture.width, texture.height).size() : 1;
+    GLint maxLevel = -1;
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, &maxLevel);
+    bool ok = texture.levels == expected && maxLevel == texture.levels - 1;
+    for (int l = 0; ok && l < texture.levels; l++)
+    {
+        GLint width = 0, height = 0;
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, l, GL_TEXTURE_WIDTH, &width);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, l, GL_TEXTURE_HEIGHT, &height);
+        ok = width == std::max(texture.width >> l, 1) && height == std::max(texture.height >> l, 1);
+    }
+    if (!ok)
+        std::cerr << "Erro: cadeia de mipmaps incompleta na textura " << texture.path << " (" << texture.levels
+                  << " niveis de " << expected << ", GL_TEXTURE_MAX_LEVEL " << maxLevel << ")" << std::endl;
+    return ok;
+}
+
+// Nova textura com os parâmetros de `sampler`, vinculada em GL_TEXTURE_2D. Os
+// parâmetros vão para o objeto de amostragem compartilhado e também para a
+// textura, que assim funciona mesmo vinculada só com glBindTexture.
+inline std::shared_ptr<Texture> createBoundTexture(const std::string &canonicalPath, const TextureSampler &sampler)
+{
+    std::shared_ptr<Texture> texture(new Texture());
+    texture->path = canonicalPath;
+    texture->sampler = sampler;
+    texture->samplerObject = sharedSampler(sampler);
+    glGenTextures(1, &texture->id);
+    glBindTexture(GL_TEXTURE_2D, texture->id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, sampler.wrapS);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, sampler.wrapT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, sampler.minFilter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, sampler.magFilter);
+    return texture;
+}
+
+// Envia os níveis de um .ktx2 (direto do arquivo mapeado) para a textura
+// vinculada; sem mipmaps no amostrador, só o nível 0. Fica em sRGB se o
+// amostrador pedir e o arquivo for de cores em sRGB.
+inline void uploadCookedTexture(Texture &texture, const KtxTextureView &cooked)
+{
+    GLsizei count = texture.sampler.usesMipmaps() ? (GLsizei)cooked.levels.size() : 1;
+    bool srgb = texture.sampler.srgb && cooked.srgb;
+    bool compressed = cooked.format != TextureFormat::RGBA8 && textureFormatSupported(cooked.format, srgb);
+    TexelFormat rgba = texelFormat(4, srgb);
+    GLenum internalFormat = compressed ? textureFormatGLEnum(cooked.format, srgb) : rgba.internalFormat;
+    bool immutable = allocateTextureStorage(count, internalFormat, cooked.width, cooked.height);
+    std::vector<uint8_t> pixels; // níveis descomprimidos, se o driver não tiver o formato
+    texture.bytes = 0;
+    for (GLsizei l = 0; l < count; l++)
+    {
+        const KtxLevel &level = cooked.levels[l];
+        if (compressed)
+            uploadCompressedLevel(immutable, l, internalFormat, level.width, level.height, level.size, level.data);
+        else if (cooked.format == TextureFormat::RGBA8)
+            uploadTextureLevel(immutable, l, rgba, level.width, level.height, level.data);
+        else
+        {
+            pixels.resize(textureLevelBytes(level.width, level.height, TextureFormat::RGBA8));
+            decompressImage(level.data, level.width, level.height, cooked.format, pixels.data());
+            uploadTextureLevel(immutable, l, rgba, level.width, level.height, pixels.data());
+        }
+        texture.bytes += textureLevelBytes(level.width, level.height, compressed ? cooked.format : TextureFormat::RGBA8);
+    }
+    texture.width = cooked.width;
+    texture.height = cooked.height;
+    texture.channels = cooked.format == TextureFormat::BC1 ? 3 : 4;
+    texture.levels = count;
+    texture.internalFormat = internalFormat;
+}
+
+// Um texel branco na textura vinculada (só as cores do material). Com 1x1 o
+// nível 0 já é a cadeia inteira de mipmaps, então a textura fica completa.
+// Usa glTexImage2D, não glTexStorage2D, para que o AsyncTextureLoader possa
+// reservar os níveis da imagem na mesma textura quando ela chegar.
+inline void setWhiteTexel(Texture &texture)
+{
+    const unsigned char white[4] = {255, 255, 255, 255};
+    texture.width = texture.height = 1;
+    texture.channels = 4;
+    texture.levels = 1;
+    texture.internalFormat = texture.sampler.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+    texture.bytes = textureBytes(1, 1, 1, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexImage2D(GL_TEXTURE_2D, 0, texture.internalFormat, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+}
+
+class TextureManager
+{
+public:
+    // Textura do arquivo `filePath` com a amostragem `sampler`, compartilhada
+    // com os outros pedidos iguais ainda em uso
+    TextureHandle load(const std::string &filePath, const TextureSampler &sampler = TextureSampler())
+    {
+        return acquire(filePath, sampler, [&](const std::string &canonicalPath)
+                       { return createTexture(filePath, canonicalPath, sampler); });
+    }
+
+    // Como load, mas uma textura nova vem de `create(caminho canônico)`, que
+    // retorna um std::shared_ptr<Texture> (ver AsyncTextureLoader.h)
+    template <typename Create>
+    TextureHandle acquire(const std::string &filePath, const TextureSampler &sampler, Create create)
+    {
+        std::string canonicalPath = canonicalTexturePath(filePath);
+        std::weak_ptr<const Texture> &entry =
+            textures[Key(canonicalPath, sampler.wrapS, sampler.wrapT, sampler.minFilter, sampler.magFilter,
+                         sampler.anisotropy, sampler.srgb, sampler.mipFilter)];
+        if (TextureHandle texture = entry.lock())
+            return texture;
+        TextureHandle texture = create(canonicalPath);
+        entry = texture;
+        return texture;
+    }
+
+    // Texturas ainda em uso e a memória delas na GPU
+    size_t residentCount()
+    {
+        purge();
+        return textures.size();
+    }
+
+    size_t residentBytes()
+    {
+        purge();
+        size_t bytes = 0;
+        for (const auto &entry : textures)
+            if (TextureHandle texture = entry.second.lock())
+                bytes += texture->bytes;
+        return bytes;
+    }
+
+    // Imagens decodificadas desde o início (os pedidos atendidos por uma textura
+    // já carregada não contam)
+    size_t decodeCount() const { return decodes; }
+    // Texturas lidas de um .ktx2 (KtxTexture.h), sem decodificar a imagem
+    size_t cookedLoadCount() const { return cookedLoads; }
+
+private:
+    using Key = std::tuple<std::string, GLenum, GLenum, GLenum, GLenum, float, bool, MipFilter>;
+
+    // Caminho absoluto e normalizado, com '/' ("" continua "")
+    static std::string canonicalTexturePath(const std::string &filePath)
+    {
+        if (filePath.empty())
+            return filePath;
+        std::error_code error;
+        std::filesystem::path path = std::filesystem::weakly_canonical(filePath, error);
+        if (error)
+            return filePath;
+        return path.generic_string();
+    }
+
+    std::shared_ptr<Texture> createTexture(const std::string &filePath, const std::string &canonicalPath,
+                                           const TextureSampler &sampler)
+    {
+        std::shared_ptr<Texture> texture = createBoundTexture(canonicalPath, sampler);
+        // Com o .ktx2 pré-processado, os níveis vêm prontos do arquivo
+        KtxTextureView cooked;
+        if (!filePath.empty() && openCookedTexture(filePath, cooked))
+        {
+            uploadCookedTexture(*texture, cooked);
+            cookedLoads++;
+        }
+        else
+        {
+            // Os canais do arquivo (R8, RG8, RGBA8); em sRGB, sempre RGBA
+            unsigned char *data = nullptr;
+            if (!filePath.empty())
+                data = stbi_load(filePath.c_str(), &texture->width, &texture->height, &texture->channels,
+                                 sampler.srgb ? 4 : 0);
+            if (data)
+            {
+                decodes++;
+                int channels = sampler.srgb ? 4 : texture->channels;
+                TexelFormat format = texelFormat(channels, sampler.srgb);
+                // Mipmaps na CPU (no lugar do glGenerateMipmap), em espaço linear se sRGB
+                std::vector<MipLevel> levels =
+                    mipLevels(texture->width, texture->height, sampler.usesMipmaps(), format.pixelBytes);
+                std::vector<uint8_t> mips;
+                if (levels.size() > 1)
+                {
+                    mips.resize(mipChainBytes(levels, format.pixelBytes) - levels[1].offset);
+                    generateMipChain(data, mips.data(), levels, sampler.srgb, sampler.mipFilter, format.pixelBytes);
+                }
+                texture->levels = (int)levels.size();
+                texture->internalFormat = format.internalFormat;
+                texture->bytes = textureBytes(texture->width, texture->height, texture->levels, format.texelBytes);
+                bool immutable =
+                    allocateTextureStorage(texture->levels, format.internalFormat, texture->width, texture->height);
+                for (int l = 0; l < texture->levels; l++)
+                    uploadTextureLevel(immutable, l, format, levels[l].width, levels[l].height,
+                                       l == 0 ? data : mips.data() + (levels[l].offset - levels[1].offset));
+                setChannelSwizzle(channels);
+                stbi_image_free(data);
+            }
+            else
+            {
+                if (!filePath.empty())
+                    std::cout << "Failed to load texture: " << filePath << std::endl;
+                texture->path.clear();
+                setWhiteTexel(*texture);
+            }
+        }
+#ifndef NDEBUG
+        validateMipChain(*texture);
+#endif
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return texture;
+    }
+
+    // Remove as entradas das texturas já apagadas
+    void purge()
+    {
+        for (auto it = textures.begin(); it != textures.end();)
+            it = it->second.expired() ? textures.erase(it) : std::next(it);
+    }
+
+    std::map<Key, std::weak_ptr<const Texture>> textures;
+    size_t decodes = 0, cookedLoads = 0;
+};
+
+// Gerenciador compartilhado pelo programa (carregador de .OBJ e exemplos)
+inline TextureManager &textureManager()
+{
+    static TextureManager manager;
+    return manager;
+}
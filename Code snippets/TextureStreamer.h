@@ -0,0 +1,587 @@
+/*
+ *  TextureStreamer - só os mipmaps que aparecem na tela ficam na GPU
+ *
+ *  O TextureManager e o AsyncTextureLoader enviam todos os níveis de cada
+ *  textura. Com centenas de texturas grandes, isso passa da memória de vídeo
+ *  mesmo que a maior parte dos objetos ocupe poucos pixels: uma Suzanne a
+ *  30 unidades da câmera nunca lê o nível 0 de uma textura de 2048x2048.
+ *
+ *  Aqui cada textura começa só com a "cauda" da cadeia (os níveis de até
+ *  TEXTURE_STREAMING_TAIL_SIZE texels de lado), e o programa informa a cada
+ *  quadro o nível mais fino que cada objeto visível precisa (`require`, com
+ *  `textureMipLevel`: a distância, a escala do objeto, a densidade de UV da
+ *  malha e o tamanho da textura dão os texels por pixel). Em `update`:
+ *
+ *  1. o nível pedido de cada textura recebe um viés (o mesmo para todas),
+ *     o menor que deixa a soma dos níveis pedidos dentro do orçamento de
+ *     memória: sem memória, todas as texturas perdem resolução por igual;
+ *  2. os níveis que sobram são liberados (glTexImage2D de 0x0) e
+ *     GL_TEXTURE_BASE_LEVEL passa a ser o nível mais fino que ficou. Se a
+ *     memória não estiver faltando, a liberação espera
+ *     TEXTURE_STREAMING_EVICT_FRAMES quadros, para uma câmera que vai e volta
+ *     não carregar os mesmos níveis de novo;
+ *  3. os níveis que faltam são pedidos às threads de trabalho, que os leem
+ *     do .ktx2 mapeado (um nível por vez, do menor para o maior) ou
+ *     decodificam a imagem e geram os mipmaps (todos de uma vez: vale a pena
+ *     pré-processar as texturas com o TextureCooker);
+ *  4. os níveis lidos são enviados à GPU, até esgotar o orçamento de tempo
+ *     do quadro, e GL_TEXTURE_BASE_LEVEL desce até eles.
+ *
+ *  Um nível só é pedido quando cabe no orçamento junto com os que já estão
+ *  na GPU e os que estão a caminho, então a memória das texturas nunca passa
+ *  dele (a não ser pelas caudas, que sempre ficam).
+ *
+ *  As texturas usam glTexImage2D, um nível de cada vez, e não glTexStorage2D:
+ *  o armazenamento imutável reserva todos os níveis de uma vez, que é
+ *  justamente a memória que se quer poupar. Texture::baseLevel diz qual é o
+ *  nível mais fino na GPU e Texture::bytes, a memória que eles ocupam.
+ *
+ *  As texturas pedidas entram no TextureManager, como as do
+ *  AsyncTextureLoader. O streamer não as segura: uma textura é apagada assim
+ *  que o programa solta o último TextureHandle, mesmo com uma leitura a
+ *  caminho (que é descartada). Só a thread da OpenGL chama os métodos;
+ *  destruir o streamer antes de glfwTerminate (as texturas ficam com os
+ *  níveis que já têm).
+ *
+ *  Forma de uso
+ *  -----------------
+ *  TextureStreamer streamer(64u << 20); // 64 MB
+ *  TextureHandle wall = streamer.request("../assets/tex/pixelWall.png");
+ *  ...
+ *  while (!glfwWindowShouldClose(window))
+ *  {
+ *      streamer.update(2.0); // usa os require do quadro anterior
+ *      ...
+ *      if (sphereInFrustum(frustum, center, radius))
+ *          streamer.require(*wall, textureMipLevel(*wall, mesh.uvDensity, 1.0f, distance, projScale));
+ *      bindTexture(*wall);
+ *      ...
+ *  }
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// GLAD
+#include <glad/glad.h>
+
+// STB_IMAGE (a implementação, STB_IMAGE_IMPLEMENTATION, fica no programa)
+#include <stb_image.h>
+
+#include "BlockCompression.h"
+#include "KtxTexture.h"
+#include "MipGenerator.h"
+#include "MpscQueue.h"
+#include "ParallelFor.h"
+#include "TextureManager.h"
+
+// Orçamento padrão da memória das texturas na GPU
+const size_t TEXTURE_STREAMING_BUDGET = 256u << 20;
+// Maior lado dos níveis que ficam sempre na GPU (a cauda da cadeia)
+const int TEXTURE_STREAMING_TAIL_SIZE = 64;
+// Quadros seguidos com níveis sobrando antes de liberá-los (sem falta de memória)
+const int TEXTURE_STREAMING_EVICT_FRAMES = 90;
+
+// Nível de mipmap (fracionário) que a textura precisa num objeto a
+// `distance` da câmera: log2 dos texels por pixel. `uvDensity` é a da malha
+// (Mesh::uvDensity, unidades de UV por unidade do objeto), `scale` a escala
+// do objeto no mundo e `projScale` os pixels por unidade a uma unidade de
+// distância, altura / (2 tan(fovy / 2)), como no selectLod.
+inline float textureMipLevel(const Texture &texture, float uvDensity, float scale, float distance, float projScale)
+{
+    float texelsPerUnit = uvDensity * (float)std::max(texture.width, texture.height);
+    float pixelsPerUnit = projScale * scale / std::max(distance, 1e-4f);
+    return std::log2(std::max(texelsPerUnit / pixelsPerUnit, 1e-6f));
+}
+
+class TextureStreamer
+{
+public:
+    // nThreads = 0 usa todos os núcleos menos um (o da thread de desenho)
+    explicit TextureStreamer(size_t budgetBytes = TEXTURE_STREAMING_BUDGET, unsigned nThreads = 0,
+                             TextureManager &manager = textureManager())
+        : manager(manager), budgetBytes(budgetBytes)
+    {
+        nThreads = nThreads == 0 ? std::max(resolveThreadCount(0), 2u) - 1 : nThreads;
+        // Consultado aqui, na thread da OpenGL: as threads de trabalho só leem
+        for (int srgb = 0; srgb < 2; srgb++)
+            for (TextureFormat format : {TextureFormat::BC1, TextureFormat::BC3, TextureFormat::BC7})
+                compressedSupported[srgb][(int)format] = textureFormatSupported(format, srgb != 0);
+        for (unsigned i = 0; i < nThreads; i++)
+            workers.emplace_back([this]() { work(); });
+    }
+
+    ~TextureStreamer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &w : workers)
+            w.join();
+    }
+
+    TextureStreamer(const TextureStreamer &) = delete;
+    TextureStreamer &operator=(const TextureStreamer &) = delete;
+
+    // Textura do arquivo, compartilhada pelo TextureManager. Uma textura nova
+    // é um texel branco (loading = true) até a cauda chegar; uma que já
+    // estava carregada (pelo TextureManager) fica inteira, fora do streaming.
+    TextureHandle request(const std::string &filePath, const TextureSampler &sampler = TextureSampler())
+    {
+        return manager.acquire(filePath, sampler, [&](const std::string &canonicalPath)
+        {
+            std::shared_ptr<Texture> texture = createBoundTexture(canonicalPath, sampler);
+            setWhiteTexel(*texture);
+            glBindTexture(GL_TEXTURE_2D, 0);
+            if (filePath.empty())
+                return texture;
+
+            texture->loading = true;
+            // Uma textura apagada pode ter deixado uma entrada no mesmo endereço
+            Entry &entry = entries[texture.get()] = Entry();
+            entry.texture = texture;
+            entry.path = filePath;
+            entry.loading = true;
+            std::unique_ptr<Job> job = newJob(entry, *texture);
+            job->first = -1;
+            submit(std::move(job));
+            return texture;
+        });
+    }
+
+    // Informa que a textura aparece neste quadro e precisa do nível `mipLevel`
+    // (ver textureMipLevel). Vale o menor nível pedido desde o último update.
+    void require(const Texture &texture, float mipLevel)
+    {
+        auto it = entries.find(&texture);
+        if (it == entries.end())
+            return;
+        int level = mipLevel > 0.0f ? (int)std::min(mipLevel, 32.0f) : 0;
+        it->second.wanted = std::min(it->second.wanted, level);
+    }
+
+    // Escolhe os níveis de cada textura pelos require desde a última chamada,
+    // libera os que sobram, pede os que faltam e envia os que chegaram por
+    // até `budgetMs` milissegundos (pelo menos uma leitura por chamada).
+    // Retorna quantas leituras foram enviadas. Chamar uma vez por quadro.
+    size_t update(double budgetMs)
+    {
+        auto start = std::chrono::steady_clock::now();
+        purge();
+        plan();
+        evictAndRequest();
+
+        size_t completed = 0;
+        std::unique_ptr<Job> job;
+        while (finished.pop(job))
+        {
+            upload(*job);
+            completed++;
+            if (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() >= budgetMs)
+                break;
+        }
+
+        // Sem require até o próximo update, só a cauda
+        for (auto &item : entries)
+            item.second.wanted = item.second.tail;
+        return completed;
+    }
+
+    void setBudget(size_t bytes) { budgetBytes = bytes; }
+    size_t budget() const { return budgetBytes; }
+
+    // Memória na GPU das texturas do streamer
+    size_t residentBytes() const
+    {
+        size_t bytes = 0;
+        for (const auto &item : entries)
+            if (std::shared_ptr<Texture> texture = item.second.texture.lock())
+                bytes += texture->bytes;
+        return bytes;
+    }
+
+    // Níveis a menos que as texturas receberam no último update para caber
+    // no orçamento (0 = todas com o nível pedido)
+    int mipBias() const { return bias; }
+
+    // Leituras pedidas às threads e ainda não enviadas
+    size_t pending() const { return inFlight; }
+
+private:
+    struct Entry
+    {
+        std::weak_ptr<Texture> texture; // expirada: apagada pelo programa, a esquecer no purge
+        std::string path;
+        bool loading = false; // uma leitura por vez
+        bool failed = false;  // a imagem não pôde mais ser lida: fica com o que tem
+        bool cooked = false;  // níveis do .ktx2 (lidos um a um) ou da imagem (todos juntos)
+        bool srgb = false;    // níveis em sRGB na GPU
+        TextureFormat format = TextureFormat::RGBA8;
+        std::vector<MipLevel> levels; // vazio até a cauda chegar
+        std::vector<size_t> suffixBytes; // memória do nível l até o último
+        int tail = 0;     // primeiro nível da cauda
+        int resident = 0; // nível mais fino na GPU
+        int wanted = 0;   // pedido pelos require
+        int target = 0;   // com o viés do orçamento
+        int surplusFrames = 0;
+        size_t loadingBytes = 0;
+    };
+
+    struct Job
+    {
+        std::weak_ptr<Texture> texture;
+        std::string path;
+        bool mipmaps = false;
+        bool srgb = false;
+        MipFilter mipFilter = MipFilter::Box;
+        int first = -1, end = 0; // níveis a ler; first = -1: abre o arquivo e lê a cauda
+        // Resultado
+        bool ok = false;
+        bool cooked = false;
+        int channels = 0;
+        TextureFormat format = TextureFormat::RGBA8;
+        std::vector<MipLevel> levels;
+        std::vector<std::vector<uint8_t>> data; // níveis first até end - 1
+
+        Job() = default;
+        Job(const Job &) = delete;
+        Job &operator=(const Job &) = delete;
+        ~Job()
+        {
+            if (std::shared_ptr<Texture> alive = texture.lock())
+                alive->loading = false; // não enviada: fica o que já está na GPU
+        }
+    };
+
+    std::unique_ptr<Job> newJob(const Entry &entry, const Texture &texture)
+    {
+        std::unique_ptr<Job> job(new Job());
+        job->texture = entry.texture;
+        job->path = entry.path;
+        job->mipmaps = texture.sampler.usesMipmaps();
+        job->srgb = texture.sampler.srgb;
+        job->mipFilter = texture.sampler.mipFilter;
+        return job;
+    }
+
+    void submit(std::unique_ptr<Job> job)
+    {
+        inFlight++;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(job));
+        }
+        wake.notify_one();
+    }
+
+    void work()
+    {
+        for (;;)
+        {
+            std::unique_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                if (stopping)
+                    return;
+                job = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            read(*job);
+            finished.push(std::move(job));
+        }
+    }
+
+    // Primeiro nível com até TEXTURE_STREAMING_TAIL_SIZE texels de lado
+    static int tailLevel(const std::vector<MipLevel> &levels)
+    {
+        int l = 0;
+        while (l + 1 < (int)levels.size() && std::max(levels[l].width, levels[l].height) > TEXTURE_STREAMING_TAIL_SIZE)
+            l++;
+        return l;
+    }
+
+    // Thread de trabalho: lê os níveis first até end - 1 do .ktx2 ou da imagem
+    void read(Job &job)
+    {
+        KtxTextureView cooked;
+        if (openCookedTexture(job.path, cooked))
+        {
+            job.cooked = true;
+            job.srgb = job.srgb && cooked.srgb;
+            if (compressedSupported[job.srgb][(int)cooked.format])
+                job.format = cooked.format;
+            job.channels = cooked.format == TextureFormat::BC1 ? 3 : 4;
+            job.levels = mipLevels(cooked.width, cooked.height, job.mipmaps);
+            job.levels.resize(std::min(job.levels.size(), cooked.levels.size()));
+            if (job.first < 0)
+            {
+                job.first = tailLevel(job.levels);
+                job.end = (int)job.levels.size();
+            }
+            for (int l = job.first; l < job.end; l++)
+            {
+                const KtxLevel &level = cooked.levels[l];
+                if (job.format == cooked.format)
+                    job.data.emplace_back(level.data, level.data + level.size);
+                else
+                {
+                    job.data.emplace_back(textureLevelBytes(level.width, level.height, TextureFormat::RGBA8));
+                    decompressImage(level.data, level.width, level.height, cooked.format, job.data.back().data());
+                }
+            }
+            job.ok = true;
+            return;
+        }
+
+        int width, height;
+        unsigned char *image = stbi_load(job.path.c_str(), &width, &height, &job.channels, 4);
+        if (!image)
+        {
+            std::cout << "Failed to load texture: " << job.path << std::endl;
+            return;
+        }
+        job.levels = mipLevels(width, height, job.mipmaps);
+        if (job.first < 0)
+        {
+            job.first = tailLevel(job.levels);
+            job.end = (int)job.levels.size();
+        }
+        // Os mipmaps até o último nível pedido; uma thread por textura
+        std::vector<MipLevel> chain(job.levels.begin(), job.levels.begin() + job.end);
+        std::vector<uint8_t> mips;
+        if (chain.size() > 1)
+        {
+            mips.resize(mipChainBytes(chain) - chain[1].offset);
+            generateMipChain(image, mips.data(), chain, job.srgb, job.mipFilter, 4, 1);
+        }
+        for (int l = job.first; l < job.end; l++)
+        {
+            const uint8_t *level = l == 0 ? image : mips.data() + (chain[l].offset - chain[1].offset);
+            job.data.emplace_back(level, level + mipLevelBytes(chain[l]));
+        }
+        stbi_image_free(image);
+        job.ok = true;
+    }
+
+    // Esquece as texturas que o programa já apagou. Depois dele, as
+    // entradas valem até o fim do update (só o programa solta as texturas).
+    void purge()
+    {
+        for (auto it = entries.begin(); it != entries.end();)
+            it = it->second.texture.expired() ? entries.erase(it) : std::next(it);
+    }
+
+    // Textura de uma entrada que passou pelo purge
+    static Texture &textureOf(const Entry &entry) { return *entry.texture.lock(); }
+
+    // Memória dos níveis de `level` em diante
+    static size_t bytesFrom(const Entry &entry, int level) { return entry.suffixBytes[level]; }
+
+    // Nível de cada textura: o pedido mais o menor viés que cabe no orçamento
+    void plan()
+    {
+        for (bias = 0;; bias++)
+        {
+            size_t total = 0;
+            bool allTails = true;
+            for (const auto &item : entries)
+            {
+                const Entry &entry = item.second;
+                if (entry.levels.empty())
+                    continue;
+                int level = std::min(entry.wanted + bias, entry.tail);
+                allTails = allTails && level == entry.tail;
+                total += bytesFrom(entry, level);
+            }
+            if (total <= budgetBytes || allTails)
+                break;
+        }
+        for (auto &item : entries)
+            item.second.target = std::min(item.second.wanted + bias, item.second.tail);
+    }
+
+    void evictAndRequest()
+    {
+        size_t used = 0, needed = 0;
+        for (const auto &item : entries)
+        {
+            const Entry &entry = item.second;
+            used += textureOf(entry).bytes + entry.loadingBytes;
+            if (!entry.levels.empty() && !entry.loading && !entry.failed && entry.target < entry.resident)
+                needed += bytesFrom(entry, entry.target) - bytesFrom(entry, entry.resident);
+        }
+        bool shortOfMemory = used + needed > budgetBytes;
+
+        std::vector<Entry *> missing;
+        for (auto &item : entries)
+        {
+            Entry &entry = item.second;
+            if (entry.levels.empty() || entry.loading)
+                continue;
+            if (entry.target > entry.resident)
+            {
+                if (shortOfMemory || ++entry.surplusFrames >= TEXTURE_STREAMING_EVICT_FRAMES)
+                {
+                    used -= textureOf(entry).bytes;
+                    evict(entry, entry.target);
+                    used += textureOf(entry).bytes;
+                }
+            }
+            else
+            {
+                entry.surplusFrames = 0;
+                if (entry.target < entry.resident && !entry.failed)
+                    missing.push_back(&entry);
+            }
+        }
+
+        // As texturas mais longe do nível pedido primeiro
+        std::sort(missing.begin(), missing.end(), [](const Entry *a, const Entry *b)
+                  { return a->resident - a->target > b->resident - b->target; });
+        for (Entry *entry : missing)
+        {
+            // Do .ktx2, um nível por vez: cada leitura é pequena e a textura
+            // melhora aos poucos
+            int first = entry->cooked ? entry->resident - 1 : entry->target;
+            size_t bytes = bytesFrom(*entry, first) - bytesFrom(*entry, entry->resident);
+            if (used + bytes > budgetBytes)
+                continue; // espera as liberações dos próximos quadros
+            used += bytes;
+            entry->loading = true;
+            entry->loadingBytes = bytes;
+            std::unique_ptr<Job> job = newJob(*entry, textureOf(*entry));
+            job->first = first;
+            job->end = entry->resident;
+            submit(std::move(job));
+        }
+    }
+
+    // Libera os níveis mais finos que `level` da textura
+    void evict(Entry &entry, int level)
+    {
+        Texture &texture = textureOf(entry);
+        GLenum internalFormat = texture.internalFormat;
+        glBindTexture(GL_TEXTURE_2D, texture.id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+        for (int l = entry.resident; l < level; l++)
+        {
+            if (entry.format == TextureFormat::RGBA8)
+                glTexImage2D(GL_TEXTURE_2D, l, internalFormat, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            else
+                glCompressedTexImage2D(GL_TEXTURE_2D, l, internalFormat, 0, 0, 0, 0, nullptr);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        setResident(entry, level);
+        entry.surplusFrames = 0;
+    }
+
+    void setResident(Entry &entry, int level)
+    {
+        entry.resident = level;
+        textureOf(entry).baseLevel = level;
+        textureOf(entry).bytes = bytesFrom(entry, level);
+    }
+
+    // Envia os níveis lidos por uma thread de trabalho
+    void upload(Job &job)
+    {
+        inFlight--;
+        // Uma textura já apagada descarta a leitura (e a entrada no mesmo
+        // endereço, se houver, é de outra textura)
+        std::shared_ptr<Texture> alive = job.texture.lock();
+        auto it = alive ? entries.find(alive.get()) : entries.end();
+        if (it == entries.end())
+            return;
+        Entry &entry = it->second;
+        entry.loading = false;
+        entry.loadingBytes = 0;
+        Texture &texture = *alive;
+        bool opening = entry.levels.empty();
+        if (!job.ok)
+        {
+            // Sem a cauda, fica o texel branco; sem um nível mais fino, os que já estão
+            if (opening)
+            {
+                texture.path.clear();
+                texture.loading = false;
+                entries.erase(it);
+            }
+            else
+                entry.failed = true;
+            return;
+        }
+        if (!opening && job.end != entry.resident)
+            return; // os níveis mudaram durante a leitura (não deve acontecer: uma leitura por vez)
+
+        TexelFormat rgba = texelFormat(4, job.srgb);
+        GLenum internalFormat = textureFormatGLEnum(job.format, job.srgb);
+        glBindTexture(GL_TEXTURE_2D, texture.id);
+        if (opening)
+        {
+            entry.cooked = job.cooked;
+            entry.srgb = job.srgb;
+            entry.format = job.format;
+            entry.levels = job.levels;
+            entry.suffixBytes.assign(job.levels.size() + 1, 0);
+            for (int l = (int)job.levels.size() - 1; l >= 0; l--)
+                entry.suffixBytes[l] = entry.suffixBytes[l + 1] +
+                                       textureLevelBytes(job.levels[l].width, job.levels[l].height, job.format);
+            entry.tail = entry.wanted = entry.target = job.first;
+            // O texel branco ocupava o nível 0
+            if (job.first > 0)
+                glTexImage2D(GL_TEXTURE_2D, 0, texture.internalFormat, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            texture.width = job.levels[0].width;
+            texture.height = job.levels[0].height;
+            texture.channels = job.channels;
+            texture.levels = (int)job.levels.size();
+            texture.internalFormat = internalFormat;
+            texture.loading = false;
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, texture.levels - 1);
+        }
+        for (int l = job.first; l < job.end; l++)
+        {
+            const MipLevel &level = job.levels[l];
+            const std::vector<uint8_t> &data = job.data[l - job.first];
+            if (job.format == TextureFormat::RGBA8)
+                uploadTextureLevel(false, l, rgba, level.width, level.height, data.data());
+            else
+                uploadCompressedLevel(false, l, internalFormat, level.width, level.height, data.size(), data.data());
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, job.first);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        setResident(entry, job.first);
+    }
+
+    TextureManager &manager;
+    size_t budgetBytes;
+    bool compressedSupported[2][4] = {}; // por sRGB e TextureFormat
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::unique_ptr<Job>> tasks; // protegidos por `mutex`
+    bool stopping = false;
+    MpscQueue<std::unique_ptr<Job>> finished; // das threads de trabalho para update
+
+    // Só na thread da OpenGL
+    std::unordered_map<const Texture *, Entry> entries;
+    size_t inFlight = 0;
+    int bias = 0;
+};
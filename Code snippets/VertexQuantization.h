@@ -0,0 +1,252 @@
+/*
+ *  VertexQuantization - formato de vértice compactado (16 bytes por vértice)
+ *
+ *  No formato em float cada vértice ocupa 32 bytes (posição, coordenada de
+ *  textura e normal). O formato quantizado guarda:
+ *   - posição: 3 x unorm16 relativos à caixa envolvente da malha (+2 bytes de
+ *     alinhamento). O erro máximo é meio passo, extensão / 131070 por eixo;
+ *   - coordenada de textura: 2 x unorm16 relativos ao retângulo de UVs da
+ *     malha (funciona também com UVs fora de [0, 1], de texturas repetidas);
+ *   - normal: 2 x snorm16 em codificação octaédrica (a esfera é projetada em
+ *     um octaedro e desdobrada em um quadrado), erro abaixo de 0,01°.
+ *
+ *  A GPU converte os inteiros em [0, 1] / [-1, 1] (normalized = GL_TRUE) e o
+ *  vertex shader `quantizedVertexShaderSource` desfaz o resto: posição e UV
+ *  voltam para o intervalo original com as uniforms posMin/posExtent e
+ *  uvMin/uvExtent, e a normal é desdobrada do octaedro. Ele tem as mesmas
+ *  saídas do vertex shader do Hello3D, então serve para os mesmos fragment
+ *  shaders de Phong.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  OBJLoadOptions options;
+ *  options.layout = VertexLayout::Quantized;
+ *  loadSimpleOBJ("../assets/Modelos3D/Suzanne.obj", mesh, options);
+ *  ...
+ *  setQuantizationUniforms(shaderID, mesh); // ver LoadSimpleOBJ.cpp
+ *
+ *  Geometria montada no próprio programa (vetor de floats intercalados, como
+ *  nos exercícios Hello3D e SpherePhong):
+ *
+ *  QuantizationBounds bounds;
+ *  GLuint VAO = createQuantizedVAO(vertices, 36, 8, 3, 5, bounds); // stride, s, nx
+ *  ...
+ *  setQuantizationUniforms(shaderID, bounds);
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// GLAD
+#include <glad/glad.h>
+
+//GLM
+#include <glm/glm.hpp>
+
+struct QuantizedVertex
+{
+    uint16_t position[4]; // x, y, z em unorm16 e 1 valor de alinhamento
+    uint16_t texCoord[2]; // s, t em unorm16
+    int16_t normal[2];    // normal octaédrica em snorm16
+};
+
+inline uint16_t quantizeUnorm16(float v)
+{
+    v = std::min(std::max(v, 0.0f), 1.0f);
+    return (uint16_t)(v * 65535.0f + 0.5f);
+}
+
+// Normal unitária -> quadrado [-1, 1]²
+inline glm::vec2 octEncode(const glm::vec3 &n)
+{
+    float sum = std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+    if (sum <= 0.0f)
+        return glm::vec2(0.0f, 0.0f);
+    glm::vec2 p(n.x / sum, n.y / sum);
+    if (n.z < 0.0f)
+    {
+        // Hemisfério de baixo: dobra os triângulos do octaedro para fora
+        glm::vec2 folded((1.0f - std::fabs(p.y)) * (p.x >= 0.0f ? 1.0f : -1.0f),
+                         (1.0f - std::fabs(p.x)) * (p.y >= 0.0f ? 1.0f : -1.0f));
+        p = folded;
+    }
+    return p;
+}
+
+// Mesma conta do vertex shader (usada para medir o erro na CPU)
+inline glm::vec3 octDecode(const glm::vec2 &e)
+{
+    glm::vec3 n(e.x, e.y, 1.0f - std::fabs(e.x) - std::fabs(e.y));
+    float t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return glm::normalize(n);
+}
+
+// Codifica um vetor unitário em uma grade de `scale` passos por semieixo
+// (32767 para snorm16, 511 para snorm10), testando os 4 vizinhos da grade e
+// ficando com o que, depois de decodificado, mais se aproxima do original
+inline void quantizeOctahedral(const glm::vec3 &n, float scale, int out[2])
+{
+    glm::vec2 e = octEncode(n);
+    float bx = std::floor(std::min(std::max(e.x, -1.0f), 1.0f) * scale);
+    float by = std::floor(std::min(std::max(e.y, -1.0f), 1.0f) * scale);
+    float bestDot = -2.0f;
+    for (int dy = 0; dy < 2; dy++)
+        for (int dx = 0; dx < 2; dx++)
+        {
+            float qx = std::min(bx + dx, scale), qy = std::min(by + dy, scale);
+            float d = glm::dot(octDecode(glm::vec2(qx / scale, qy / scale)), n);
+            if (d > bestDot)
+            {
+                bestDot = d;
+                out[0] = (int)qx;
+                out[1] = (int)qy;
+            }
+        }
+}
+
+inline void quantizeNormal(const glm::vec3 &n, int16_t out[2])
+{
+    int q[2];
+    quantizeOctahedral(n, 32767.0f, q);
+    out[0] = (int16_t)q[0];
+    out[1] = (int16_t)q[1];
+}
+
+// `posMin`/`posExtent` e `uvMin`/`uvExtent` são as caixas envolventes da malha
+inline QuantizedVertex quantizeVertex(const glm::vec3 &position, const glm::vec2 &texCoord, const glm::vec3 &normal,
+                                      const glm::vec3 &posMin, const glm::vec3 &posExtent,
+                                      const glm::vec2 &uvMin, const glm::vec2 &uvExtent)
+{
+    QuantizedVertex q;
+    for (int i = 0; i < 3; i++)
+        q.position[i] = quantizeUnorm16(posExtent[i] > 0.0f ? (position[i] - posMin[i]) / posExtent[i] : 0.0f);
+    q.position[3] = 0;
+    for (int i = 0; i < 2; i++)
+        q.texCoord[i] = quantizeUnorm16(uvExtent[i] > 0.0f ? (texCoord[i] - uvMin[i]) / uvExtent[i] : 0.0f);
+    float len = glm::length(normal);
+    quantizeNormal(len > 0.0f ? normal / len : glm::vec3(0.0f, 0.0f, 1.0f), q.normal);
+    return q;
+}
+
+// Caixas envolventes da quantização: os mesmos valores vão para as uniforms
+// posMin, posExtent, uvMin e uvExtent do vertex shader
+struct QuantizationBounds
+{
+    glm::vec3 posMin = glm::vec3(0.0f), posExtent = glm::vec3(0.0f);
+    glm::vec2 uvMin = glm::vec2(0.0f), uvExtent = glm::vec2(0.0f);
+};
+
+// Cria um VAO com os `nVertices` vértices de `data` (floats intercalados,
+// `stride` floats por vértice, posição no início e coordenada de textura e
+// normal a partir dos deslocamentos dados) no formato quantizado. A posição
+// fica na localização 0; as da coordenada de textura e da normal seguem o
+// vertex shader do programa. Preenche `bounds` para a decodificação.
+inline GLuint createQuantizedVAO(const GLfloat *data, size_t nVertices, int stride, int texCoordOffset, int normalOffset,
+                                 QuantizationBounds &bounds, GLuint texCoordLocation = 1, GLuint normalLocation = 2)
+{
+    glm::vec3 posMax(-FLT_MAX);
+    glm::vec2 uvMax(-FLT_MAX);
+    bounds.posMin = glm::vec3(FLT_MAX);
+    bounds.uvMin = glm::vec2(FLT_MAX);
+    for (size_t i = 0; i < nVertices; i++)
+    {
+        const GLfloat *v = data + i * stride;
+        glm::vec3 position(v[0], v[1], v[2]);
+        glm::vec2 texCoord(v[texCoordOffset], v[texCoordOffset + 1]);
+        bounds.posMin = glm::min(bounds.posMin, position);
+        posMax = glm::max(posMax, position);
+        bounds.uvMin = glm::min(bounds.uvMin, texCoord);
+        uvMax = glm::max(uvMax, texCoord);
+    }
+    if (nVertices == 0)
+        bounds = QuantizationBounds();
+    else
+    {
+        bounds.posExtent = posMax - bounds.posMin;
+        bounds.uvExtent = uvMax - bounds.uvMin;
+    }
+
+    std::vector<QuantizedVertex> vertices(nVertices);
+    for (size_t i = 0; i < nVertices; i++)
+    {
+        const GLfloat *v = data + i * stride;
+        vertices[i] = quantizeVertex(glm::vec3(v[0], v[1], v[2]), glm::vec2(v[texCoordOffset], v[texCoordOffset + 1]),
+                                     glm::vec3(v[normalOffset], v[normalOffset + 1], v[normalOffset + 2]),
+                                     bounds.posMin, bounds.posExtent, bounds.uvMin, bounds.uvExtent);
+    }
+
+    GLuint VBO, VAO;
+    glGenBuffers(1, &VBO);
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(QuantizedVertex), vertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(QuantizedVertex),
+                          (GLvoid *)offsetof(QuantizedVertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(texCoordLocation, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(QuantizedVertex),
+                          (GLvoid *)offsetof(QuantizedVertex, texCoord));
+    glEnableVertexAttribArray(texCoordLocation);
+    glVertexAttribPointer(normalLocation, 2, GL_SHORT, GL_TRUE, sizeof(QuantizedVertex),
+                          (GLvoid *)offsetof(QuantizedVertex, normal));
+    glEnableVertexAttribArray(normalLocation);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    return VAO;
+}
+
+// Uniforms de decodificação de um VAO de createQuantizedVAO (o programa
+// precisa estar em uso)
+inline void setQuantizationUniforms(GLuint shaderID, const QuantizationBounds &bounds)
+{
+    glUniform3fv(glGetUniformLocation(shaderID, "posMin"), 1, &bounds.posMin.x);
+    glUniform3fv(glGetUniformLocation(shaderID, "posExtent"), 1, &bounds.posExtent.x);
+    glUniform2fv(glGetUniformLocation(shaderID, "uvMin"), 1, &bounds.uvMin.x);
+    glUniform2fv(glGetUniformLocation(shaderID, "uvExtent"), 1, &bounds.uvExtent.x);
+}
+
+// Declarações GLSL da decodificação: as uniforms das caixas e octDecode. Para
+// vertex shaders que aceitam também os vértices em float (ver SpherePhong)
+#define QUANTIZED_VERTEX_DECODE                                             \
+    "uniform vec3 posMin;\n"                                                \
+    "uniform vec3 posExtent;\n"                                             \
+    "uniform vec2 uvMin;\n"                                                 \
+    "uniform vec2 uvExtent;\n"                                              \
+    "vec3 octDecode(vec2 e)\n"                                              \
+    "{\n"                                                                   \
+    "    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));\n"                    \
+    "    float t = max(-n.z, 0.0);\n"                                       \
+    "    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);\n"         \
+    "    return normalize(n);\n"                                            \
+    "}\n"
+
+// Vertex shader do formato quantizado (mesmas saídas do vertex shader do Hello3D)
+const GLchar* const quantizedVertexShaderSource = R"(
+	#version 450
+	layout(location = 0) in vec3 position; // unorm16: [0, 1] dentro da caixa envolvente
+	layout(location = 1) in vec2 texc;     // unorm16: [0, 1] dentro do retângulo de UVs
+	layout(location = 2) in vec2 octNormal; // snorm16: normal octaédrica
+	uniform mat4 projection;
+	uniform mat4 view;
+	uniform mat4 model;
+	out vec2 texCoord;
+	out vec3 FragPos;
+	out vec3 Normal;
+	)" QUANTIZED_VERTEX_DECODE R"(
+	void main()
+	{
+		vec3 p   = posMin + position * posExtent;
+		gl_Position = projection * view * model * vec4(p, 1.0);
+		texCoord = uvMin + texc * uvExtent;
+		FragPos  = vec3(model * vec4(p, 1.0));
+		Normal   = mat3(transpose(inverse(model))) * octDecode(octNormal);
+	}
+	)";
@@ -28,15 +28,25 @@ using namespace std;
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+// Texturas compartilhadas (Code snippets/TextureManager.h)
+#include "TextureManager.h"
+
+// Formato de vértice compactado (Code snippets/VertexQuantization.h)
+#include "VertexQuantization.h"
+
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 int setupShader();
 int setupGeometry();
-GLuint loadTexture(std::string filePath, int &width, int &height);
 void loadTrajectoryPoints(std::vector<glm::vec3> &points, const std::string &filename);
 void saveTrajectoryPoints(const std::vector<glm::vec3> &points, const std::string &filename);
 
 const GLuint WIDTH = 1000, HEIGHT = 1000;
 
+// Com QUANTIZED_VERTICES o cubo usa o formato compactado: 16 bytes por
+// vértice em vez de 32, decodificados por quantizedVertexShaderSource
+const bool QUANTIZED_VERTICES = false;
+QuantizationBounds cubeBounds;
+
 std::vector<glm::vec3> trajectoryPoints1 = {
     glm::vec3(0.0f, 0.0f, -3.0f),
     glm::vec3(2.0f, 0.0f, -3.0f),
@@ -201,14 +211,14 @@ int main()
 	GLuint shaderID = setupShader();
 	GLuint VAO = setupGeometry();
 
-	int imgWidth, imgHeight;
-	GLuint textID = loadTexture("../assets/tex/pixelWall.png", imgWidth, imgHeight);
+	TextureHandle wall = textureManager().load("../assets/tex/pixelWall.png");
 
 	glUseProgram(shaderID);
+	if (QUANTIZED_VERTICES)
+		setQuantizationUniforms(shaderID, cubeBounds);
 
     glUniform1i(glGetUniformLocation(shaderID, "texBuff"), 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textID);
+    bindTexture(*wall);
 
     GLint projLoc  = glGetUniformLocation(shaderID, "projection");
     GLint viewLoc  = glGetUniformLocation(shaderID, "view");
@@ -295,6 +305,7 @@ int main()
 		glfwSwapBuffers(window);
 	}
 	glDeleteVertexArrays(1, &VAO);
+	wall.reset(); // apaga a textura antes de destruir o contexto
 	glfwTerminate();
 	return 0;
 }
@@ -383,8 +394,9 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 
 int setupShader()
 {
+	const GLchar* vertexSource = QUANTIZED_VERTICES ? quantizedVertexShaderSource : vertexShaderSource;
 	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
+	glShaderSource(vertexShader, 1, &vertexSource, NULL);
 	glCompileShader(vertexShader);
 	GLint success;
 	GLchar infoLog[512];
@@ -459,6 +471,11 @@ int setupGeometry()
 	     0.5f,-0.5f, 0.5f,  0.0f,0.0f, 0.0f,-1.0f,0.0f
 	};
 
+	// Formato compactado (8 floats por vértice: s e t a partir do float 3, a
+	// normal a partir do 5)
+	if (QUANTIZED_VERTICES)
+		return createQuantizedVAO(vertices, 36, 8, 3, 5, cubeBounds);
+
 	GLuint VBO, VAO;
 	glGenBuffers(1, &VBO);
 	glGenVertexArrays(1, &VAO);
@@ -480,32 +497,6 @@ int setupGeometry()
 	return VAO;
 }
 
-GLuint loadTexture(std::string filePath, int &width, int &height)
-{
-    GLuint texID;
-    glGenTextures(1, &texID);
-    glBindTexture(GL_TEXTURE_2D, texID);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    int nrChannels;
-    unsigned char *data = stbi_load(filePath.c_str(), &width, &height, &nrChannels, 0);
-    if (data)
-    {
-        GLenum format = (nrChannels == 3) ? GL_RGB : GL_RGBA;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else
-    {
-        std::cout << "Failed to load texture: " << filePath << std::endl;
-    }
-    stbi_image_free(data);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    return texID;
-}
-
 void loadTrajectoryPoints(std::vector<glm::vec3> &points, const std::string &filename)
 {
     std::ifstream inFile(filename);
@@ -0,0 +1,553 @@
+/* Loader Benchmark - medição do carregador de .OBJ
+ *
+ * Mede `loadSimpleOBJ` e os seus caminhos alternativos (cache .meshbin,
+ * formato quantizado, LODs e meshlets, tangentes e leitura em fluxo) nos
+ * modelos de assets/Modelos3D e, opcionalmente, em .OBJ sintéticos grandes
+ * (ver Code snippets/ObjGenerator.h). Cada caso é repetido e relata a
+ * mediana do tempo, MB/s (do .OBJ), faces/s, o pico de memória residente
+ * (RSS) e o número de alocações feitas com `new`. Com --json os resultados
+ * são gravados em um arquivo, para acompanhar regressões ao longo do tempo.
+ *
+ * O tempo inclui o envio à GPU (glFinish): o programa cria uma janela
+ * invisível só para ter um contexto OpenGL. Sem contexto (máquina sem
+ * vídeo), só o caso "parse" é medido.
+ *
+ * Uso (a partir da pasta de build, como os outros exercícios):
+ *   LoaderBenchmark [opções] [arquivo.obj ...]
+ *     --repeticoes N       repetições de cada caso (padrão 5)
+ *     --casos a,b,...      parse, padrao, cache, quantizado, lod, tangentes, fluxo
+ *     --json arquivo       grava os resultados em JSON
+ *     --sintetico FACES    gera (se ainda não existir) e mede um .OBJ sintético
+ *     --tipo tri|quad|ngon --celulas K --sem-vt --sem-vn --semente S --objetos N
+ *                          opções dos .OBJ sintéticos
+ *   LoaderBenchmark --gerar arquivo.obj --faces N [opções dos sintéticos]
+ *                          só grava o .OBJ sintético
+ *
+ * Sem arquivos na linha de comando, mede Cube, Suzanne e SuzanneSubdiv1.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <thread>
+
+using namespace std;
+
+// GLAD
+#include <glad/glad.h>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+//GLM
+#include <glm/glm.hpp>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "LoadSimpleOBJ.cpp"
+#include "ObjGenerator.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#include <malloc.h> // _aligned_malloc
+#else
+#include <sys/resource.h>
+#endif
+
+// Contagem de alocações: substitui o operator new global deste programa.
+// Não vê o que é alocado com malloc (stb_image) nem pelo driver OpenGL.
+static std::atomic<size_t> allocationCount(0), allocationBytes(0);
+
+void *operator new(std::size_t size)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	allocationBytes.fetch_add(size, std::memory_order_relaxed);
+	if (void *p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+// Versões alinhadas, usadas pelo std::pmr::new_delete_resource (de onde a
+// arena do carregador pede os seus blocos, ver ArenaAllocator.h)
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	allocationBytes.fetch_add(size, std::memory_order_relaxed);
+	std::size_t a = std::max((std::size_t)alignment, sizeof(void *));
+#if defined(_WIN32)
+	void *p = _aligned_malloc(size ? size : 1, a);
+#else
+	void *p = nullptr;
+	if (posix_memalign(&p, a, size ? size : 1) != 0)
+		p = nullptr;
+#endif
+	if (p)
+		return p;
+	throw std::bad_alloc();
+}
+
+#if defined(_WIN32)
+void operator delete(void *p, std::align_val_t) noexcept { _aligned_free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { _aligned_free(p); }
+#else
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+#endif
+
+// Memória residente atual e de pico, em bytes. No Linux o pico pode ser
+// zerado entre os casos (clear_refs); nos outros sistemas é o pico do processo.
+bool resetPeakRSS()
+{
+#if defined(__linux__)
+	std::ofstream clearRefs("/proc/self/clear_refs");
+	clearRefs << "5";
+	return (bool)clearRefs;
+#else
+	return false;
+#endif
+}
+
+void readRSS(size_t &current, size_t &peak)
+{
+	current = peak = 0;
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		current = counters.WorkingSetSize;
+		peak = counters.PeakWorkingSetSize;
+	}
+#elif defined(__linux__)
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line))
+	{
+		if (line.compare(0, 6, "VmRSS:") == 0)
+			current = std::strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+		else if (line.compare(0, 6, "VmHWM:") == 0)
+			peak = std::strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+	}
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+		peak = (size_t)usage.ru_maxrss; // bytes no macOS
+	current = peak;
+#endif
+}
+
+// Número de faces (registros `f`) do .OBJ, para as faces/s
+size_t countObjFaces(const std::string &filePath)
+{
+	ObjLineReader reader;
+	if (!reader.open(filePath, OBJ_STREAM_MAX_WINDOW))
+		return 0;
+	size_t faces = 0;
+	const char *begin, *end;
+	while (reader.nextLine(begin, end))
+	{
+		const char *p = objSkipSpaces(begin, end);
+		if (end - p >= 2 && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+			faces++;
+	}
+	return faces;
+}
+
+size_t fileSize(const std::string &filePath)
+{
+	std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+	return file ? (size_t)file.tellg() : 0;
+}
+
+struct BenchCase
+{
+	std::string name;
+	OBJLoadOptions options;
+	bool parseOnly = false; // só parseOBJFile, sem soldagem nem OpenGL
+};
+
+std::vector<BenchCase> allCases()
+{
+	std::vector<BenchCase> cases(7);
+	cases[0].name = "parse";
+	cases[0].parseOnly = true;
+	cases[1].name = "padrao";
+	cases[1].options.useCache = false;
+	cases[2].name = "cache";
+	cases[3].name = "quantizado";
+	cases[3].options.useCache = false;
+	cases[3].options.layout = VertexLayout::Quantized;
+	cases[4].name = "lod";
+	cases[4].options.useCache = false;
+	cases[4].options.lodLevels = 4;
+	cases[4].options.meshlets = true;
+	cases[5].name = "tangentes";
+	cases[5].options.useCache = false;
+	cases[5].options.tangents = true;
+	cases[6].name = "fluxo";
+	cases[6].options.useCache = false;
+	cases[6].options.streamBudget = 64u << 20;
+	return cases;
+}
+
+struct BenchResult
+{
+	std::string model, file, caseName;
+	size_t bytes = 0, faces = 0;
+	std::vector<double> times; // ms, uma por repetição
+	double medianMs = 0.0, minMs = 0.0;
+	size_t baselineRSS = 0, peakRSS = 0;
+	size_t allocations = 0, allocatedBytes = 0; // da última repetição
+	size_t vertices = 0, indices = 0;
+	bool ok = true;
+};
+
+// Apaga os objetos OpenGL da malha (buffers e texturas dos materiais) e
+// espera a GPU, para que uma repetição não carregue a memória nem o
+// trabalho da anterior. Fora do tempo medido.
+void releaseMesh(Mesh &mesh)
+{
+	glDeleteVertexArrays(1, &mesh.VAO);
+	glDeleteBuffers(1, &mesh.VBO);
+	glDeleteBuffers(1, &mesh.EBO);
+	// Os materiais guardam só os ids: a última referência está em mesh.textures
+	mesh.materials.clear();
+	mesh.textures.clear();
+	glFinish();
+}
+
+// Uma carga completa, com a saída do carregador silenciada; `mesh` deve ser
+// liberada com releaseMesh
+bool runOnce(const std::string &filePath, const BenchCase &bench, BenchResult &result, Mesh &mesh)
+{
+	if (bench.parseOnly)
+	{
+		ObjData obj;
+		if (!parseOBJFile(filePath, obj, 0))
+			return false;
+		result.vertices = obj.vertices.size();
+		result.indices = obj.corners.size();
+		return true;
+	}
+
+	std::streambuf *out = std::cout.rdbuf(nullptr);
+	int VAO = loadSimpleOBJ(filePath, mesh, bench.options);
+	glFinish();
+	std::cout.rdbuf(out);
+	std::cout.clear();
+	if (VAO < 0)
+		return false;
+	result.vertices = (size_t)mesh.nVertices;
+	result.indices = (size_t)mesh.nIndices;
+	return true;
+}
+
+BenchResult runCase(const std::string &model, const std::string &filePath, const BenchCase &bench, int repetitions)
+{
+	BenchResult result;
+	result.model = model;
+	result.file = filePath;
+	result.caseName = bench.name;
+	result.bytes = fileSize(filePath);
+	result.faces = countObjFaces(filePath);
+
+	// O caso "cache" mede a leitura do .meshbin: a primeira carga (não medida) o grava
+	if (bench.options.useCache && !bench.parseOnly)
+	{
+		BenchResult warmup;
+		Mesh mesh = Mesh();
+		if (runOnce(filePath, bench, warmup, mesh))
+			releaseMesh(mesh);
+	}
+
+	for (int r = 0; r < repetitions && result.ok; r++)
+	{
+		size_t rssBefore, peak;
+		resetPeakRSS();
+		readRSS(rssBefore, peak);
+		allocationCount = 0;
+		allocationBytes = 0;
+
+		Mesh mesh = Mesh();
+		auto start = std::chrono::steady_clock::now();
+		result.ok = runOnce(filePath, bench, result, mesh);
+		auto stop = std::chrono::steady_clock::now();
+
+		result.allocations = allocationCount;
+		result.allocatedBytes = allocationBytes;
+		size_t rssAfter;
+		readRSS(rssAfter, peak);
+		if (result.ok && !bench.parseOnly)
+			releaseMesh(mesh);
+		result.times.push_back(std::chrono::duration<double, std::milli>(stop - start).count());
+		result.baselineRSS = r == 0 ? rssBefore : std::min(result.baselineRSS, rssBefore);
+		result.peakRSS = std::max(result.peakRSS, peak);
+	}
+
+	if (!result.times.empty())
+	{
+		std::vector<double> sorted = result.times;
+		std::sort(sorted.begin(), sorted.end());
+		result.medianMs = sorted[sorted.size() / 2];
+		result.minMs = sorted[0];
+	}
+	return result;
+}
+
+std::string jsonString(const std::string &s)
+{
+	std::string out = "\"";
+	for (char c : s)
+	{
+		if (c == '"' || c == '\\')
+			out += '\\';
+		if ((unsigned char)c < 0x20)
+			continue;
+		out += c;
+	}
+	return out + "\"";
+}
+
+bool writeJSON(const std::string &filePath, const std::vector<BenchResult> &results, int repetitions, const std::string &renderer)
+{
+	std::ofstream json(filePath);
+	if (!json)
+	{
+		std::cerr << "Erro ao tentar gravar o arquivo " << filePath << std::endl;
+		return false;
+	}
+
+	char date[32];
+	std::time_t now = std::time(nullptr);
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+#if defined(__clang__)
+	std::string compiler = std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+	std::string compiler = std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+	std::string compiler = "msvc " + std::to_string(_MSC_VER);
+#else
+	std::string compiler = "desconhecido";
+#endif
+#ifdef NDEBUG
+	const char *optimized = "true";
+#else
+	const char *optimized = "false";
+#endif
+
+	json << "{\n";
+	json << "  \"benchmark\": \"LoaderBenchmark\",\n";
+	json << "  \"format_version\": 1,\n";
+	json << "  \"date\": " << jsonString(date) << ",\n";
+	json << "  \"compiler\": " << jsonString(compiler) << ",\n";
+	json << "  \"optimized\": " << optimized << ",\n";
+	json << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+	json << "  \"gl_renderer\": " << jsonString(renderer) << ",\n";
+	json << "  \"repetitions\": " << repetitions << ",\n";
+	json << "  \"results\": [";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchResult &r = results[i];
+		double seconds = r.medianMs / 1000.0;
+		json << (i ? ",\n" : "\n") << "    {";
+		json << "\"model\": " << jsonString(r.model) << ", \"file\": " << jsonString(r.file);
+		json << ", \"case\": " << jsonString(r.caseName) << ", \"ok\": " << (r.ok ? "true" : "false");
+		json << ", \"bytes\": " << r.bytes << ", \"faces\": " << r.faces;
+		json << ", \"vertices\": " << r.vertices << ", \"indices\": " << r.indices;
+		json << ", \"median_ms\": " << r.medianMs << ", \"min_ms\": " << r.minMs << ", \"times_ms\": [";
+		for (size_t t = 0; t < r.times.size(); t++)
+			json << (t ? ", " : "") << r.times[t];
+		json << "], \"mb_per_s\": " << (seconds > 0.0 ? r.bytes / 1048576.0 / seconds : 0.0);
+		json << ", \"faces_per_s\": " << (seconds > 0.0 ? r.faces / seconds : 0.0);
+		json << ", \"baseline_rss_bytes\": " << r.baselineRSS << ", \"peak_rss_bytes\": " << r.peakRSS;
+		json << ", \"allocations\": " << r.allocations << ", \"allocated_bytes\": " << r.allocatedBytes << "}";
+	}
+	json << "\n  ]\n}\n";
+	return (bool)json;
+}
+
+bool parseFaceType(const std::string &name, ObjFaceType &type)
+{
+	if (name == "tri")
+		type = ObjFaceType::Triangles;
+	else if (name == "quad")
+		type = ObjFaceType::Quads;
+	else if (name == "ngon")
+		type = ObjFaceType::NGons;
+	else
+		return false;
+	return true;
+}
+
+// Nome do .OBJ sintético: as opções fazem parte do nome, então um arquivo já
+// gerado com as mesmas opções pode ser reaproveitado
+std::string syntheticName(const ObjGeneratorOptions &options)
+{
+	std::string name = "sintetico_" + std::to_string(options.faces) + "_" + objFaceTypeName(options.faceType);
+	if (options.faceType == ObjFaceType::NGons)
+		name += std::to_string(options.ngonCells);
+	if (!options.texCoords)
+		name += "_semvt";
+	if (!options.normals)
+		name += "_semvn";
+	if (options.seed != 1)
+		name += "_s" + std::to_string(options.seed);
+	if (options.objects > 1)
+		name += "_o" + std::to_string(options.objects);
+	return name + ".obj";
+}
+
+int main(int argc, char *argv[])
+{
+	int repetitions = 5;
+	std::string jsonPath, generatePath;
+	std::vector<std::string> caseNames, files;
+	std::vector<size_t> syntheticFaces;
+	ObjGeneratorOptions generator;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--repeticoes" && hasValue)
+			repetitions = std::max(std::atoi(argv[++i]), 1);
+		else if (arg == "--json" && hasValue)
+			jsonPath = argv[++i];
+		else if (arg == "--casos" && hasValue)
+		{
+			std::stringstream list(argv[++i]);
+			std::string name;
+			while (std::getline(list, name, ','))
+				caseNames.push_back(name);
+		}
+		else if (arg == "--sintetico" && hasValue)
+			syntheticFaces.push_back((size_t)std::strtoull(argv[++i], nullptr, 10));
+		else if (arg == "--gerar" && hasValue)
+			generatePath = argv[++i];
+		else if (arg == "--faces" && hasValue)
+			generator.faces = (size_t)std::strtoull(argv[++i], nullptr, 10);
+		else if (arg == "--tipo" && hasValue)
+		{
+			if (!parseFaceType(argv[++i], generator.faceType))
+			{
+				std::cerr << "Erro: tipo de face desconhecido " << argv[i] << " (tri, quad ou ngon)" << std::endl;
+				return -1;
+			}
+		}
+		else if (arg == "--celulas" && hasValue)
+			generator.ngonCells = std::max(std::atoi(argv[++i]), 1);
+		else if (arg == "--semente" && hasValue)
+			generator.seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+		else if (arg == "--objetos" && hasValue)
+			generator.objects = (size_t)std::strtoull(argv[++i], nullptr, 10);
+		else if (arg == "--sem-vt")
+			generator.texCoords = false;
+		else if (arg == "--sem-vn")
+			generator.normals = false;
+		else if (arg.compare(0, 2, "--") == 0)
+		{
+			std::cerr << "Erro: opcao desconhecida ou sem valor " << arg << std::endl;
+			return -1;
+		}
+		else
+			files.push_back(arg);
+	}
+
+	if (!generatePath.empty())
+	{
+		auto start = std::chrono::steady_clock::now();
+		if (!writeSyntheticOBJ(generatePath, generator))
+			return -1;
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << generatePath << ": " << generator.faces << " faces, " << fileSize(generatePath) / 1048576.0
+				  << " MB em " << seconds << " s" << std::endl;
+		return 0;
+	}
+
+	for (size_t faces : syntheticFaces)
+	{
+		ObjGeneratorOptions options = generator;
+		options.faces = faces;
+		std::string path = syntheticName(options);
+		if (fileSize(path) == 0)
+		{
+			std::cout << "Gerando " << path << "..." << std::endl;
+			if (!writeSyntheticOBJ(path, options))
+				return -1;
+		}
+		files.push_back(path);
+	}
+	if (files.empty())
+		files = {"../assets/Modelos3D/Cube.obj", "../assets/Modelos3D/Suzanne.obj", "../assets/Modelos3D/SuzanneSubdiv1.obj"};
+
+	std::vector<BenchCase> cases;
+	for (const BenchCase &bench : allCases())
+		if (caseNames.empty() || std::find(caseNames.begin(), caseNames.end(), bench.name) != caseNames.end())
+			cases.push_back(bench);
+	if (cases.empty())
+	{
+		std::cerr << "Erro: nenhum caso reconhecido em --casos" << std::endl;
+		return -1;
+	}
+
+	// Contexto OpenGL em uma janela invisível
+	std::string renderer = "nenhum";
+	bool hasContext = false;
+	if (glfwInit())
+	{
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		GLFWwindow *window = glfwCreateWindow(64, 64, "Loader Benchmark", nullptr, nullptr);
+		if (window)
+		{
+			glfwMakeContextCurrent(window);
+			hasContext = gladLoadGLLoader((GLADloadproc)glfwGetProcAddress) != 0;
+		}
+	}
+	if (hasContext)
+		renderer = (const char *)glGetString(GL_RENDERER);
+	else
+		std::cerr << "Aviso: sem contexto OpenGL, so o caso parse sera medido" << std::endl;
+
+	std::vector<BenchResult> results;
+	std::cout << "modelo                         caso        mediana ms      MB/s     Mfaces/s  pico RSS MB  alocacoes" << std::endl;
+	for (const std::string &file : files)
+	{
+		std::string model = file.substr(file.find_last_of("/\\") + 1);
+		for (const BenchCase &bench : cases)
+		{
+			if (!hasContext && !bench.parseOnly)
+				continue;
+			BenchResult r = runCase(model, file, bench, repetitions);
+			results.push_back(r);
+			double seconds = r.medianMs / 1000.0;
+			char line[256];
+			std::snprintf(line, sizeof(line), "%-30s %-10s %11.2f %9.1f %12.3f %12.1f %10zu%s", model.c_str(),
+						  r.caseName.c_str(), r.medianMs, seconds > 0.0 ? r.bytes / 1048576.0 / seconds : 0.0,
+						  seconds > 0.0 ? r.faces / seconds / 1e6 : 0.0, r.peakRSS / 1048576.0, r.allocations,
+						  r.ok ? "" : "  (falhou)");
+			std::cout << line << std::endl;
+		}
+	}
+
+	if (!jsonPath.empty() && writeJSON(jsonPath, results, repetitions, renderer))
+		std::cout << "Resultados gravados em " << jsonPath << std::endl;
+
+	glfwTerminate();
+	return 0;
+}
@@ -9,6 +9,7 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 #include <assert.h>
 
 using namespace std;
@@ -27,6 +28,13 @@ using namespace std;
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+// Várias imagens em uma textura só, desenhadas por instância
+// (Code snippets/TextureAtlas.h e AtlasInstances.h)
+#include "AtlasInstances.h"
+
+// Formato de vértice compactado (Code snippets/VertexQuantization.h)
+#include "VertexQuantization.h"
+
 using namespace glm;
 
 #include <cmath>
@@ -37,7 +45,6 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 // Protótipos das funções
 int setupShader();
 int setupGeometry();
-GLuint loadTexture(string filePath, int &width, int &height);
 
 void drawGeometry(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, float angle, int nVertices, vec3 color= vec3(1.0,0.0,0.0), vec3 axis = (vec3(0.0, 0.0, 1.0)));
 GLuint generateSphere(float radius, int latSegments, int lonSegments, int &nVertices);
@@ -45,6 +52,15 @@ GLuint generateSphere(float radius, int latSegments, int lonSegments, int &nVert
 // Dimensões da janela (pode ser alterado em tempo de execução)
 const GLuint WIDTH = 800, HEIGHT = 800;
 
+// Tecla T: alterna entre a esfera com a cor dos vértices e as esferas
+// texturizadas pelo atlas
+bool showAtlas = false;
+
+// Com QUANTIZED_VERTICES a esfera usa o formato compactado: 16 bytes por
+// vértice em vez de 44 (a cor, igual em todos, vai como atributo constante)
+const bool QUANTIZED_VERTICES = false;
+QuantizationBounds sphereBounds;
+
 // Código fonte do Vertex Shader (em GLSL): ainda hardcoded
 const GLchar *vertexShaderSource = R"(
 #version 400
@@ -55,17 +71,30 @@ layout (location = 3) in vec2 texc;
 
 uniform mat4 projection;
 uniform mat4 model;
+// Com quantized, posição e UV relativas às caixas da esfera e normal
+// octaédrica em normal.xy (QUANTIZED_VERTICES)
+uniform bool quantized;
+)" QUANTIZED_VERTEX_DECODE R"(
+// Com useAtlas, um elemento por esfera (instância): a matriz de modelo e a
+// região dela no atlas
+uniform bool useAtlas;
+)" ATLAS_INSTANCE_UNIFORMS R"(
 
 out vec2 texCoord;
+flat out int layer;
 out vec3 vNormal;
 out vec4 fragPos; 
 out vec4 vColor;
 void main()
 {
-   	gl_Position = projection * model * vec4(position.x, position.y, position.z, 1.0);
-	fragPos = model * vec4(position.x, position.y, position.z, 1.0);
-	texCoord = texc;
-	vNormal = normal;
+	vec3 p = quantized ? posMin + position * posExtent : position;
+	vec2 uv = quantized ? uvMin + texc * uvExtent : texc;
+	mat4 m = useAtlas ? models[gl_InstanceID] : model;
+   	gl_Position = projection * m * vec4(p, 1.0);
+	fragPos = m * vec4(p, 1.0);
+	texCoord = useAtlas ? uvRects[gl_InstanceID].xy + uv * uvRects[gl_InstanceID].zw : uv;
+	layer = useAtlas ? layers[gl_InstanceID] : 0;
+	vNormal = quantized ? octDecode(normal.xy) : normal;
 	vColor = vec4(color,1.0);
 })";
 
@@ -73,7 +102,9 @@ void main()
 const GLchar *fragmentShaderSource = R"(
 #version 400
 in vec2 texCoord;
-uniform sampler2D texBuff;
+flat in int layer;
+uniform bool useAtlas;
+uniform sampler2DArray atlas;
 uniform vec3 lightPos;
 uniform vec3 camPos;
 uniform float ka;
@@ -88,8 +119,7 @@ void main()
 {
 
 	vec3 lightColor = vec3(1.0,1.0,1.0);
-	//vec4 objectColor = texture(texBuff,texCoord);
-	vec4 objectColor = vColor;
+	vec4 objectColor = useAtlas ? texture(atlas, vec3(texCoord, layer)) : vColor;
 
 	//Coeficiente de luz ambiente
 	vec3 ambient = ka * lightColor;
@@ -162,9 +192,19 @@ int main()
 	int nVertices;
 	GLuint VAO = generateSphere(0.5, 16, 16, nVertices);
 
-	// Carregando uma textura e armazenando seu id
-	int imgWidth, imgHeight;
-	GLuint texID = loadTexture("../assets/tex/pixelWall.png",imgWidth,imgHeight);
+	// Para a cena da tecla T: as texturas das esferas juntas em um atlas, uma
+	// textura só para todas
+	TextureAtlas atlas;
+	int wallRegion = atlas.add("../assets/tex/pixelWall.png");
+	int suzanneRegion = atlas.add("../assets/Modelos3D/Suzanne.png");
+	int uvRegion = atlas.add("../assets/Modelos3D/SuzanneUV.png");
+	atlas.build();
+
+	// As esferas da cena com o atlas, cada uma com a sua imagem
+	vector<AtlasInstance> spheres = {
+		{vec3(-0.6, 0.0, 0.0), vec3(0.55, 0.55, 0.55), 0.0, wallRegion},
+		{vec3(0.0, 0.0, 0.0), vec3(0.55, 0.55, 0.55), 0.0, suzanneRegion},
+		{vec3(0.6, 0.0, 0.0), vec3(0.55, 0.55, 0.55), 0.0, uvRegion}};
 
 	float ka = 0.1, kd =0.5, ks = 0.5, q = 10.0;
 	vec3 lightPos = vec3(0.6, 1.2, -0.5);
@@ -173,8 +213,13 @@ int main()
 
 	glUseProgram(shaderID);
 
+	// Decodificação dos vértices compactados
+	glUniform1i(glGetUniformLocation(shaderID, "quantized"), QUANTIZED_VERTICES);
+	if (QUANTIZED_VERTICES)
+		setQuantizationUniforms(shaderID, sphereBounds);
+
 	// Enviar a informação de qual variável armazenará o buffer da textura
-	glUniform1i(glGetUniformLocation(shaderID, "texBuff"), 0);
+	glUniform1i(glGetUniformLocation(shaderID, "atlas"), 0);
 
 	glUniform1f(glGetUniformLocation(shaderID, "ka"), ka);
 	glUniform1f(glGetUniformLocation(shaderID, "kd"), kd);
@@ -183,8 +228,9 @@ int main()
 	glUniform3f(glGetUniformLocation(shaderID, "lightPos"), lightPos.x,lightPos.y,lightPos.z);
 	glUniform3f(glGetUniformLocation(shaderID, "camPos"), camPos.x,camPos.y,camPos.z);
 
-	//Ativando o primeiro buffer de textura da OpenGL
+	//Ativando o primeiro buffer de textura da OpenGL e conectando o atlas uma única vez
 	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, atlas.id());
 	
 
 	// Matriz de projeção paralela ortográfica
@@ -207,10 +253,14 @@ int main()
 		glClear(GL_COLOR_BUFFER_BIT);
 
 		glBindVertexArray(VAO); // Conectando ao buffer de geometria
-		glBindTexture(GL_TEXTURE_2D, texID); //conectando com o buffer de textura que será usado no draw
 
-		// Primeiro Triângulo
-		drawGeometry(shaderID, VAO, vec3(0, 0, 0), vec3(1, 1, 1), 0.0, nVertices);
+		glUniform1i(glGetUniformLocation(shaderID, "useAtlas"), showAtlas);
+		if (showAtlas)
+			// As três esferas, com texturas diferentes, em uma única chamada de desenho
+			drawAtlasInstances(shaderID, atlas, spheres, nVertices);
+		else
+			// Primeira esfera
+			drawGeometry(shaderID, VAO, vec3(0, 0, 0), vec3(1, 1, 1), 0.0, nVertices);
 
 	
 		glBindVertexArray(0); // Desconectando o buffer de geometria
@@ -220,6 +270,8 @@ int main()
 	}
 	// Pede pra OpenGL desalocar os buffers
 	glDeleteVertexArrays(1, &VAO);
+	// Apaga a textura do atlas antes de destruir o contexto
+	atlas.clear();
 	// Finaliza a execução da GLFW, limpando os recursos alocados por ela
 	glfwTerminate();
 	return 0;
@@ -232,6 +284,8 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 {
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, GL_TRUE);
+	if (key == GLFW_KEY_T && action == GLFW_PRESS)
+		showAtlas = !showAtlas;
 }
 
 // Esta função está basntante hardcoded - objetivo é compilar e "buildar" um programa de
@@ -348,50 +402,6 @@ int setupGeometry()
 	return VAO;
 }
 
-GLuint loadTexture(string filePath, int &width, int &height)
-{
-	GLuint texID; // id da textura a ser carregada
-
-	// Gera o identificador da textura na memória
-	glGenTextures(1, &texID);
-	glBindTexture(GL_TEXTURE_2D, texID);
-
-	// Ajuste dos parâmetros de wrapping e filtering
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	// Carregamento da imagem usando a função stbi_load da biblioteca stb_image
-	int nrChannels;
-
-	unsigned char *data = stbi_load(filePath.c_str(), &width, &height, &nrChannels, 0);
-
-	if (data)
-	{
-		if (nrChannels == 3) // jpg, bmp
-		{
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		}
-		else // assume que é 4 canais png
-		{
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-		}
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture " << filePath << std::endl;
-	}
-
-	stbi_image_free(data);
-
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-	return texID;
-}
-
 void drawGeometry(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, float angle, int nVertices, vec3 color, vec3 axis)
 {
 	// Matriz de modelo: transformações na geometria (objeto)
@@ -457,6 +467,18 @@ GLuint generateSphere(float radius, int latSegments, int lonSegments, int &nVert
         }
     }
 
+    nVertices = vBuffer.size() / 11; // Cada vértice agora tem 11 floats!
+
+    // Formato compactado: UV (float 9) na localização 3 e normal (float 6) na
+    // 2, como no layout abaixo. A localização 1 fica desligada no VAO e o
+    // shader recebe a cor do valor constante do atributo.
+    if (QUANTIZED_VERTICES)
+    {
+        GLuint VAO = createQuantizedVAO(vBuffer.data(), nVertices, 11, 9, 6, sphereBounds, 3, 2);
+        glVertexAttrib3f(1, color.r, color.g, color.b);
+        return VAO;
+    }
+
     // Criar VAO e VBO
     GLuint VAO, VBO;
     glGenVertexArrays(1, &VAO);
@@ -485,7 +507,5 @@ glEnableVertexAttribArray(3);
 
     glBindVertexArray(0);
 
-    nVertices = vBuffer.size() / 11; // Cada vértice agora tem 11 floats!
-
     return VAO;
 }
\ No newline at end of file
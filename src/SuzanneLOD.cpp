@@ -0,0 +1,442 @@
+/* Suzanne LOD - níveis de detalhe escolhidos por erro projetado em pixels
+ *
+ * Uma grade de Suzannes é desenhada com os níveis gerados por
+ * `loadSimpleOBJ` (ver Code snippets/MeshSimplifier.h). A cada quadro, cada
+ * instância usa o nível mais simples cujo erro geométrico, projetado na tela,
+ * fica abaixo de `pixelError`. Esse limite é ajustado automaticamente para que
+ * o total de triângulos do quadro fique dentro de `triangleBudget`. As
+ * instâncias desenhadas no nível 0 (as mais próximas) ainda descartam os
+ * meshlets fora da tela ou de costas para a câmera (ver MeshletBuilder.h).
+ *
+ * As texturas dos materiais ficam em streaming (ver Code
+ * snippets/TextureStreamer.h): só os mipmaps que a Suzanne visível mais
+ * próxima precisa vão para a GPU, dentro de `textureBudget` bytes.
+ *
+ * Teclas: setas giram a câmera, I/K/J/L movem, +/- mudam o orçamento de
+ * triângulos, [/] o de texturas, espaço liga/desliga os níveis de detalhe e
+ * C liga/desliga o descarte de meshlets (para comparar).
+ *
+ * Com QUANTIZED_VERTICES os vértices usam o formato compactado de 16 bytes
+ * (ver Code snippets/VertexQuantization.h) e o vertex shader correspondente.
+ *
+ * Os materiais vêm do .MTL do modelo. O desenho é ordenado por material: cada
+ * material (uniforms e textura) é vinculado uma única vez por quadro e depois
+ * são desenhadas as submalhas desse material de todas as instâncias.
+ *
+ * O modelo é carregado em segundo plano (AsyncMeshLoader): a janela já
+ * desenha desde o primeiro quadro e as Suzannes aparecem quando a malha
+ * termina de chegar à GPU, enviada em trechos de até `uploadBudgetMs` por quadro.
+ */
+
+#include <iostream>
+#include <string>
+#include <assert.h>
+#include <vector>
+#include <cmath>
+
+using namespace std;
+
+// GLAD
+#include <glad/glad.h>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+//GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "LoadSimpleOBJ.cpp"
+
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
+int setupShader();
+
+const GLuint WIDTH = 1000, HEIGHT = 1000;
+const float FOVY = 45.0f;
+
+// Grade de GRID_SIZE x GRID_SIZE instâncias
+const int GRID_SIZE = 40;
+const float GRID_SPACING = 3.0f;
+
+size_t triangleBudget = 1000000; // triângulos por quadro
+float pixelError = 1.0f;         // erro máximo tolerado, em pixels
+bool useLod = true;
+const bool QUANTIZED_VERTICES = true; // 16 bytes por vértice em vez de 32
+bool cullMeshletsOn = true;
+const double uploadBudgetMs = 2.0; // tempo de envio de geometria por quadro
+size_t textureBudget = 2u << 20;   // memória das texturas na GPU
+
+class Camera
+{
+public:
+    glm::vec3 position;
+    glm::vec3 target;
+    float radius;
+    float yaw;
+    float pitch;
+
+    Camera(glm::vec3 focus = glm::vec3(0.0f), float startRadius = 6.0f, float startYaw = -90.0f, float startPitch = 0.0f)
+        : target(focus), radius(startRadius), yaw(startYaw), pitch(startPitch)
+    {
+        updatePosition();
+    }
+
+    glm::mat4 getViewMatrix()
+    {
+        return glm::lookAt(position, target, glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+
+    void moveForward(float delta)
+    {
+        glm::vec3 front = glm::normalize(target - position);
+        target += delta * front;
+        updatePosition();
+    }
+
+    void moveRight(float delta)
+    {
+        glm::vec3 front = glm::normalize(target - position);
+        glm::vec3 right = glm::normalize(glm::cross(front, glm::vec3(0.0f, 1.0f, 0.0f)));
+        target += delta * right;
+        updatePosition();
+    }
+
+    void rotate(float deltaYaw, float deltaPitch)
+    {
+        yaw += deltaYaw;
+        pitch += deltaPitch;
+        if (pitch > 89.0f) pitch = 89.0f;
+        if (pitch < -89.0f) pitch = -89.0f;
+        updatePosition();
+    }
+
+private:
+    void updatePosition()
+    {
+        position.x = target.x + radius * cos(glm::radians(pitch)) * sin(glm::radians(yaw));
+        position.y = target.y + radius * sin(glm::radians(pitch));
+        position.z = target.z + radius * cos(glm::radians(pitch)) * cos(glm::radians(yaw));
+    }
+};
+
+Camera camera(glm::vec3(0.0f, 0.0f, 0.0f), 8.0f, 0.0f, 15.0f);
+
+const GLchar* vertexShaderSource = R"(
+	#version 450
+	layout(location = 0) in vec3 position;
+	layout(location = 1) in vec2 texc;
+	layout(location = 2) in vec3 normal;
+	uniform mat4 projection;
+	uniform mat4 view;
+	uniform mat4 model;
+	out vec2 texCoord;
+	out vec3 FragPos;
+	out vec3 Normal;
+	void main()
+	{
+		gl_Position = projection * view * model * vec4(position, 1.0);
+		texCoord = texc;
+		FragPos  = vec3(model * vec4(position, 1.0));
+		Normal   = mat3(model) * normal;
+	}
+	)";
+
+const GLchar* fragmentShaderSource = R"(
+	#version 450
+	in vec2 texCoord;
+	in vec3 FragPos;
+	in vec3 Normal;
+	uniform sampler2D texBuff;
+	uniform vec3 lightPos;
+	uniform vec3 viewPos;
+	uniform vec3 lightColor;
+	uniform vec3 ka;
+	uniform vec3 kd;
+	uniform vec3 ks;
+	uniform float q;
+	out vec4 color;
+	void main()
+	{
+		vec3 ambient  = 0.2 * ka * lightColor;
+		vec3 norm     = normalize(Normal);
+		vec3 lightDir = normalize(lightPos - FragPos);
+		float diff    = max(dot(norm, lightDir), 0.0);
+		vec3 diffuse  = kd * diff * lightColor;
+		vec3 viewDir = normalize(viewPos - FragPos);
+		vec3 reflectDir = reflect(-lightDir, norm);
+		float spec = pow(max(dot(viewDir, reflectDir), 0.0), q);
+		vec3 specular = ks * spec * lightColor;
+		vec3 phong = ambient + diffuse + specular;
+		color = vec4(phong, 1.0) * texture(texBuff, texCoord);
+	}
+	)";
+
+int main()
+{
+	glfwInit();
+	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "Suzanne LOD", nullptr, nullptr);
+	glfwMakeContextCurrent(window);
+	glfwSetKeyCallback(window, key_callback);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+	}
+
+	int width, height;
+	glfwGetFramebufferSize(window, &width, &height);
+	glViewport(0, 0, width, height);
+
+	GLuint shaderID = setupShader();
+
+	OBJLoadOptions options;
+	options.lodLevels = 6;
+	options.meshlets = true;
+	if (QUANTIZED_VERTICES)
+		options.layout = VertexLayout::Quantized;
+	// Destruídos antes de glfwTerminate (ver AsyncMeshLoader e TextureStreamer)
+	std::unique_ptr<TextureStreamer> streamer(new TextureStreamer(textureBudget));
+	std::unique_ptr<AsyncMeshLoader> loader(new AsyncMeshLoader(1, streamer.get()));
+	int suzanneID = loader->request("../assets/Modelos3D/SuzanneSubdiv1.obj", options);
+	Mesh *suzanne = nullptr; // até a malha ficar pronta
+
+	glUseProgram(shaderID);
+	glUniform1i(glGetUniformLocation(shaderID, "texBuff"), 0);
+
+	GLint viewLoc  = glGetUniformLocation(shaderID, "view");
+	GLint modelLoc = glGetUniformLocation(shaderID, "model");
+	GLint viewPosLoc = glGetUniformLocation(shaderID, "viewPos");
+
+	glm::mat4 projection = glm::perspective(glm::radians(FOVY), (float)width / (float)height, 0.1f, 300.0f);
+	glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+
+	glm::vec3 lightPos(0.0f, 30.0f, 30.0f);
+	glm::vec3 lightColor(1.0f, 1.0f, 1.0f);
+	glUniform3fv(glGetUniformLocation(shaderID, "lightPos"), 1, glm::value_ptr(lightPos));
+	glUniform3fv(glGetUniformLocation(shaderID, "lightColor"), 1, glm::value_ptr(lightColor));
+
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+
+	// Raio da esfera envolvente, usado para não trocar de nível "por dentro" do objeto
+	float radius = 0.0f;
+
+	std::vector<glm::vec3> positions;
+	for (int z = 0; z < GRID_SIZE; z++)
+		for (int x = 0; x < GRID_SIZE; x++)
+			positions.push_back(glm::vec3((x - GRID_SIZE / 2) * GRID_SPACING, 0.0f, -z * GRID_SPACING));
+
+	std::vector<size_t> lodHistogram;
+	std::vector<int> levels(positions.size());
+	double lastTitleTime = glfwGetTime();
+
+	while (!glfwWindowShouldClose(window))
+	{
+		glfwPollEvents();
+		glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// Continua o carregamento; a malha é usada a partir do quadro em que fica pronta
+		loader->update(uploadBudgetMs);
+		streamer->setBudget(textureBudget);
+		streamer->update(uploadBudgetMs);
+		if (!suzanne && loader->ready(suzanneID))
+		{
+			suzanne = &loader->mesh(suzanneID);
+			if (QUANTIZED_VERTICES)
+				setQuantizationUniforms(shaderID, *suzanne);
+			radius = 0.5f * glm::length(suzanne->boundsMax - suzanne->boundsMin);
+			lodHistogram.assign(suzanne->lods.size(), 0);
+		}
+		if (!suzanne)
+		{
+			bool failed = suzanneID < 0 || loader->state(suzanneID) == AsyncLoadState::Failed;
+			glfwSetWindowTitle(window, failed ? "Suzanne LOD -- erro ao carregar o modelo" : "Suzanne LOD -- carregando...");
+			glfwSwapBuffers(window);
+			continue;
+		}
+
+		glm::mat4 view = camera.getViewMatrix();
+		glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+		glUniform3fv(viewPosLoc, 1, glm::value_ptr(camera.position));
+		glm::mat4 viewProjection = projection * view;
+
+		// projScale: pixels por unidade a uma unidade de distância da câmera
+		float projScale = height / (2.0f * tan(glm::radians(FOVY) * 0.5f));
+
+		// Nível de cada instância na tela (-1 fora do frustum: nem escolhe o
+		// nível nem desenha) e a distância da mais próxima
+		Frustum frustum = frustumFromMatrix(viewProjection);
+		float nearest = -1.0f;
+		size_t culled = 0;
+		std::fill(lodHistogram.begin(), lodHistogram.end(), 0);
+		for (size_t i = 0; i < positions.size(); i++)
+		{
+			if (!sphereInFrustum(frustum, positions[i], radius))
+			{
+				levels[i] = -1;
+				culled++;
+				continue;
+			}
+			float distance = std::max(glm::length(camera.position - positions[i]) - radius, 0.0f);
+			levels[i] = useLod ? selectLod(suzanne->lods, 1.0f, distance, projScale, pixelError) : 0;
+			lodHistogram[levels[i]]++;
+			if (nearest < 0.0f || distance < nearest)
+				nearest = distance;
+		}
+		// Mipmaps que as texturas precisam (nenhum pedido se nada estiver na tela)
+		if (nearest >= 0.0f)
+			for (const TextureHandle &texture : suzanne->textures)
+				streamer->require(*texture, textureMipLevel(*texture, suzanne->uvDensity, 1.0f, nearest, projScale));
+
+		// Desenho ordenado por material: um vínculo de material por quadro
+		glBindVertexArray(suzanne->VAO);
+		size_t triangles = 0;
+		for (size_t m = 0; m < suzanne->materials.size(); m++)
+		{
+			bindMaterial(shaderID, suzanne->materials[m]);
+			for (size_t i = 0; i < positions.size(); i++)
+			{
+				if (levels[i] < 0)
+					continue;
+				glm::mat4 model = glm::translate(glm::mat4(1.0f), positions[i]);
+				bool modelSet = false;
+				for (const Submesh &part : suzanne->submeshes)
+				{
+					if (part.material != m || part.lod != (uint32_t)levels[i])
+						continue;
+					if (!modelSet)
+					{
+						glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+						modelSet = true;
+					}
+					if (levels[i] == 0 && cullMeshletsOn && !suzanne->meshlets.empty())
+						triangles += drawMeshlets(*suzanne, model, viewProjection, camera.position, &part);
+					else
+					{
+						drawSubmesh(*suzanne, part);
+						triangles += part.indexCount / 3;
+					}
+				}
+			}
+		}
+		glBindVertexArray(0);
+
+		// Ajusta o limite de erro para o próximo quadro conforme o orçamento
+		if (triangles > triangleBudget)
+			pixelError = std::min(pixelError * 1.1f, 64.0f);
+		else if (triangles < triangleBudget * 8 / 10)
+			pixelError = std::max(pixelError / 1.1f, 0.25f);
+
+		double now = glfwGetTime();
+		if (now - lastTitleTime > 0.5)
+		{
+			std::string title = "Suzanne LOD -- " + std::to_string(triangles) + " triangulos (orcamento " +
+			                    std::to_string(triangleBudget) + "), erro " + std::to_string(pixelError) + " px, niveis:";
+			for (size_t count : lodHistogram)
+				title += " " + std::to_string(count);
+			title += " (" + std::to_string(culled) + " fora da tela)";
+			title += ", texturas " + std::to_string(streamer->residentBytes() >> 10) + " KB (orcamento " +
+			         std::to_string(textureBudget >> 10) + " KB, vies " + std::to_string(streamer->mipBias()) + ")";
+			glfwSetWindowTitle(window, title.c_str());
+			lastTitleTime = now;
+		}
+
+		glfwSwapBuffers(window);
+	}
+	if (suzanne)
+	{
+		glDeleteVertexArrays(1, &suzanne->VAO);
+		glDeleteBuffers(1, &suzanne->VBO);
+		glDeleteBuffers(1, &suzanne->EBO);
+	}
+	loader.reset();
+	streamer.reset();
+	glfwTerminate();
+	return 0;
+}
+
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode)
+{
+	const float moveSpeed = 0.5f;
+	const float rotateSpeed = 2.0f;
+	bool pressed = action == GLFW_PRESS || action == GLFW_REPEAT;
+
+	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, GL_TRUE);
+
+	if (key == GLFW_KEY_UP && pressed)
+		camera.rotate(0.0f, rotateSpeed);
+	if (key == GLFW_KEY_DOWN && pressed)
+		camera.rotate(0.0f, -rotateSpeed);
+	if (key == GLFW_KEY_LEFT && pressed)
+		camera.rotate(-rotateSpeed, 0.0f);
+	if (key == GLFW_KEY_RIGHT && pressed)
+		camera.rotate(rotateSpeed, 0.0f);
+
+	if (key == GLFW_KEY_I && pressed)
+		camera.moveForward(moveSpeed);
+	if (key == GLFW_KEY_K && pressed)
+		camera.moveForward(-moveSpeed);
+	if (key == GLFW_KEY_L && pressed)
+		camera.moveRight(moveSpeed);
+	if (key == GLFW_KEY_J && pressed)
+		camera.moveRight(-moveSpeed);
+
+	if ((key == GLFW_KEY_EQUAL || key == GLFW_KEY_KP_ADD) && pressed)
+		triangleBudget += 250000;
+	if ((key == GLFW_KEY_MINUS || key == GLFW_KEY_KP_SUBTRACT) && pressed && triangleBudget > 250000)
+		triangleBudget -= 250000;
+
+	if (key == GLFW_KEY_RIGHT_BRACKET && pressed)
+		textureBudget *= 2;
+	if (key == GLFW_KEY_LEFT_BRACKET && pressed && textureBudget > (64u << 10))
+		textureBudget /= 2;
+
+	if (key == GLFW_KEY_SPACE && action == GLFW_PRESS)
+		useLod = !useLod;
+	if (key == GLFW_KEY_C && action == GLFW_PRESS)
+		cullMeshletsOn = !cullMeshletsOn;
+}
+
+int setupShader()
+{
+	const GLchar* vertexSource = QUANTIZED_VERTICES ? quantizedVertexShaderSource : vertexShaderSource;
+	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(vertexShader, 1, &vertexSource, NULL);
+	glCompileShader(vertexShader);
+	GLint success;
+	GLchar infoLog[512];
+	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
+		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+	}
+	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
+	glCompileShader(fragmentShader);
+	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
+		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+	}
+	GLuint shaderProgram = glCreateProgram();
+	glAttachShader(shaderProgram, vertexShader);
+	glAttachShader(shaderProgram, fragmentShader);
+	glLinkProgram(shaderProgram);
+	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+	if (!success) {
+		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
+		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+	}
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+
+	return shaderProgram;
+}
@@ -0,0 +1,251 @@
+/* Texture Cooker - pré-processamento das texturas em .ktx2
+ *
+ * Lê cada imagem com o stb_image, gera a cadeia de mipmaps completa com um
+ * filtro em espaço linear (Code snippets/MipGenerator.h), comprime os níveis
+ * em blocos BC (Code snippets/BlockCompression.h) e grava um .ktx2 ao lado
+ * da imagem (pixelWall.png -> pixelWall.ktx2, ver Code snippets/KtxTexture.h).
+ * Depois disso, o TextureManager e o AsyncTextureLoader carregam o .ktx2
+ * mapeado em memória: sem descompactar o PNG e sem glGenerateMipmap. Um
+ * .ktx2 mais antigo que a imagem é ignorado na carga, então basta rodar o
+ * programa de novo depois de editar uma imagem.
+ *
+ * Para cada imagem, mostra a memória da textura na GPU (com os mipmaps)
+ * comparada à do RGBA8 e a qualidade do nível 0 comprimido (PSNR, em dB,
+ * calculado sobre a imagem descomprimida; acima de ~40 dB a diferença
+ * praticamente não se vê).
+ *
+ * Não usa a OpenGL: pode rodar em uma máquina sem vídeo, como etapa do build.
+ *
+ * Uso (a partir da pasta de build, como os outros exercícios):
+ *   TextureCooker [--linear] [--format auto|rgba8|bc1|bc3|bc7]
+ *                 [--filter box|kaiser|lanczos] [imagem ...]
+ *   TextureCooker --benchmark
+ *     --linear     imagens de dados (mapas de normais, máscaras): filtro
+ *                  direto sobre os valores, sem a conversão sRGB
+ *     --format     formato dos níveis. auto (o padrão) usa BC1 nas imagens
+ *                  opacas e BC3 nas com transparência; bc7 tem a melhor
+ *                  qualidade de cor, com o mesmo tamanho do BC3
+ *     --filter     filtro dos mipmaps. kaiser (o padrão) e lanczos mantêm
+ *                  os detalhes dos níveis menores; box é a média de 2x2 do
+ *                  glGenerateMipmap, a mais rápida
+ *     --benchmark  mede a geração da cadeia de mipmaps de imagens 4096x4096
+ *                  e 8192x8192 com cada filtro, em uma thread e em todas
+ *
+ * Sem imagens na linha de comando, processa as texturas de assets/.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+using namespace std;
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "BlockCompression.h"
+#include "KtxTexture.h"
+#include "MipGenerator.h"
+
+// PSNR (dB) entre duas imagens RGBA8 nos `channels` primeiros canais
+double psnr(const uint8_t *a, const uint8_t *b, size_t texels, int channels)
+{
+	double sum = 0.0;
+	for (size_t i = 0; i < texels; i++)
+		for (int k = 0; k < channels; k++)
+		{
+			double d = (double)a[i * 4 + k] - (double)b[i * 4 + k];
+			sum += d * d;
+		}
+	if (sum == 0.0)
+		return INFINITY;
+	return 10.0 * std::log10(255.0 * 255.0 * (double)texels * channels / sum);
+}
+
+// Grava o .ktx2 de uma imagem. `automatic` escolhe BC1 ou BC3 pelo alfa da
+// imagem. Retorna false se a imagem não puder ser lida ou o .ktx2 gravado.
+bool cookTexture(const std::string &imagePath, bool srgb, TextureFormat format, bool automatic, MipFilter filter)
+{
+	auto start = std::chrono::steady_clock::now();
+	int width, height, channels;
+	unsigned char *data = stbi_load(imagePath.c_str(), &width, &height, &channels, 4);
+	if (!data)
+	{
+		std::cerr << "Erro ao ler a imagem " << imagePath << std::endl;
+		return false;
+	}
+
+	std::vector<MipLevel> levels = mipLevels(width, height);
+	std::vector<uint8_t> chain(mipChainBytes(levels));
+	std::memcpy(chain.data(), data, mipLevelBytes(levels[0]));
+	stbi_image_free(data);
+	if (levels.size() > 1)
+		generateMipChain(chain.data(), chain.data() + levels[1].offset, levels, srgb, filter);
+
+	bool opaque = true;
+	for (size_t i = 3; i < mipLevelBytes(levels[0]) && opaque; i += 4)
+		opaque = chain[i] == 255;
+	if (automatic)
+		format = opaque ? TextureFormat::BC1 : TextureFormat::BC3;
+
+	// Níveis no formato escolhido: os de RGBA8 apontam direto para a cadeia
+	std::vector<std::vector<uint8_t>> blocks(levels.size());
+	std::vector<KtxLevel> cooked;
+	size_t bytes = 0;
+	for (size_t l = 0; l < levels.size(); l++)
+	{
+		const MipLevel &level = levels[l];
+		const uint8_t *data = chain.data() + level.offset;
+		size_t size = textureLevelBytes(level.width, level.height, format);
+		if (format != TextureFormat::RGBA8)
+		{
+			blocks[l].resize(size);
+			compressImage(data, level.width, level.height, format, blocks[l].data());
+			data = blocks[l].data();
+		}
+		cooked.push_back({level.width, level.height, data, size});
+		bytes += size;
+	}
+
+	std::string cookedPath = cookedTexturePath(imagePath);
+	if (!writeKtx2(cookedPath, cooked, format, srgb))
+	{
+		std::cerr << "Erro ao gravar o arquivo " << cookedPath << std::endl;
+		return false;
+	}
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	std::cout << imagePath << " -> " << cookedPath << ": " << width << "x" << height << " (" << channels
+			  << " canais), " << levels.size() << " niveis (" << mipFilterName(filter) << "), " << textureFormatName(format)
+			  << (srgb ? " sRGB" : " linear") << ", " << (bytes >> 10) << " KB (RGBA8: " << (chain.size() >> 10)
+			  << " KB), " << ms << " ms" << std::endl;
+
+	if (format != TextureFormat::RGBA8)
+	{
+		std::vector<uint8_t> decoded(mipLevelBytes(levels[0]));
+		decompressImage(blocks[0].data(), width, height, format, decoded.data());
+		size_t texels = (size_t)width * height;
+		std::cout << "  PSNR do nivel 0: RGB " << psnr(chain.data(), decoded.data(), texels, 3) << " dB";
+		if (!opaque)
+			std::cout << ", RGBA " << psnr(chain.data(), decoded.data(), texels, 4) << " dB";
+		std::cout << std::endl;
+	}
+	return true;
+}
+
+// Tempo (ms) e vazão (milhões de texels do nível 0 por segundo) da cadeia
+// de mipmaps de imagens RGBA sRGB sintéticas, com cada filtro. Mostra o
+// melhor de algumas rodadas, para não medir o primeiro acesso às páginas.
+void benchmarkMipChain()
+{
+#if defined(MIP_GENERATOR_AVX2)
+	const char *simd = "AVX2/FMA";
+#elif defined(MIP_GENERATOR_SSE2)
+	const char *simd = "SSE2";
+#else
+	const char *simd = "escalar";
+#endif
+	unsigned cores = std::max(std::thread::hardware_concurrency(), 1u);
+	std::cout << "Cadeia de mipmaps RGBA8 sRGB, " << simd << ", " << cores << " threads" << std::endl;
+
+	const MipFilter filters[] = {MipFilter::Box, MipFilter::Kaiser, MipFilter::Lanczos};
+	for (int size : {4096, 8192})
+	{
+		std::vector<MipLevel> levels = mipLevels(size, size);
+		std::vector<uint8_t> chain(mipChainBytes(levels));
+		// Gradientes com ruído: o conteúdo não muda o tempo, só evita páginas zeradas
+		uint32_t seed = 1;
+		for (size_t i = 0; i < mipLevelBytes(levels[0]); i++)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			chain[i] = (uint8_t)((i >> 4) + (seed >> 28));
+		}
+
+		for (MipFilter filter : filters)
+			for (unsigned nThreads : {1u, cores})
+			{
+				double best = INFINITY;
+				for (int run = 0; run < 3; run++)
+				{
+					auto start = std::chrono::steady_clock::now();
+					generateMipChain(chain.data(), chain.data() + levels[1].offset, levels, true, filter, 4, nThreads);
+					best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+				}
+				std::cout << "  " << size << "x" << size << " " << mipFilterName(filter) << ", " << nThreads
+						  << (nThreads == 1 ? " thread: " : " threads: ") << best << " ms, "
+						  << (double)size * size / (best * 1000.0) << " Mtexels/s" << std::endl;
+				if (cores == 1)
+					break;
+			}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bool srgb = true, automatic = true;
+	TextureFormat format = TextureFormat::RGBA8;
+	MipFilter filter = MipFilter::Kaiser;
+	std::vector<std::string> images;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--linear")
+			srgb = false;
+		else if (arg == "--format" && i + 1 < argc)
+		{
+			std::string name = argv[++i];
+			automatic = name == "auto";
+			if (name == "rgba8")
+				format = TextureFormat::RGBA8;
+			else if (name == "bc1")
+				format = TextureFormat::BC1;
+			else if (name == "bc3")
+				format = TextureFormat::BC3;
+			else if (name == "bc7")
+				format = TextureFormat::BC7;
+			else if (!automatic)
+			{
+				std::cerr << "Erro: formato desconhecido " << name << std::endl;
+				return -1;
+			}
+		}
+		else if (arg == "--filter" && i + 1 < argc)
+		{
+			std::string name = argv[++i];
+			if (name == "box")
+				filter = MipFilter::Box;
+			else if (name == "kaiser")
+				filter = MipFilter::Kaiser;
+			else if (name == "lanczos")
+				filter = MipFilter::Lanczos;
+			else
+			{
+				std::cerr << "Erro: filtro desconhecido " << name << std::endl;
+				return -1;
+			}
+		}
+		else if (arg == "--benchmark")
+		{
+			benchmarkMipChain();
+			return 0;
+		}
+		else if (arg.compare(0, 2, "--") == 0)
+		{
+			std::cerr << "Erro: opcao desconhecida " << arg << std::endl;
+			return -1;
+		}
+		else
+			images.push_back(arg);
+	}
+	if (images.empty())
+		images = {"../assets/tex/pixelWall.png", "../assets/Modelos3D/Suzanne.png", "../assets/Modelos3D/SuzanneUV.png"};
+
+	int failures = 0;
+	for (const std::string &image : images)
+		if (!cookTexture(image, srgb, format, automatic, filter))
+			failures++;
+	return failures == 0 ? 0 : -1;
+}
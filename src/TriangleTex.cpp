@@ -9,6 +9,7 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 #include <assert.h>
 
 using namespace std;
@@ -27,6 +28,13 @@ using namespace std;
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+// Texturas compartilhadas (Code snippets/TextureManager.h)
+#include "TextureManager.h"
+
+// Várias imagens em uma textura só, desenhadas por instância
+// (Code snippets/TextureAtlas.h e AtlasInstances.h)
+#include "AtlasInstances.h"
+
 using namespace glm;
 
 #include <cmath>
@@ -37,13 +45,16 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 // Protótipos das funções
 int setupShader();
 int setupGeometry();
-GLuint loadTexture(string filePath, int &width, int &height);
 
 void drawTriangle(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, float angle, vec3 color, vec3 axis = (vec3(0.0, 0.0, 1.0)));
 
 // Dimensões da janela (pode ser alterado em tempo de execução)
 const GLuint WIDTH = 800, HEIGHT = 600;
 
+// Tecla T: alterna entre os triângulos com a mesma textura e os triângulos
+// com imagens diferentes do atlas
+bool showAtlas = false;
+
 // Código fonte do Vertex Shader (em GLSL): ainda hardcoded
 const GLchar *vertexShaderSource = R"(
 #version 400
@@ -51,22 +62,32 @@ layout (location = 0) in vec3 position;
 layout (location = 1) in vec2 texc;
 uniform mat4 projection;
 uniform mat4 model;
+// Com useAtlas, um elemento por triângulo (instância): a matriz de modelo e a
+// região dele no atlas
+uniform bool useAtlas;
+)" ATLAS_INSTANCE_UNIFORMS R"(
 out vec2 texCoord;
+flat out int layer;
 void main()
 {
-   	gl_Position = projection * model * vec4(position.x, position.y, position.z, 1.0);
-	texCoord = texc;
+	mat4 m = useAtlas ? models[gl_InstanceID] : model;
+   	gl_Position = projection * m * vec4(position.x, position.y, position.z, 1.0);
+	texCoord = useAtlas ? uvRects[gl_InstanceID].xy + texc * uvRects[gl_InstanceID].zw : texc;
+	layer = useAtlas ? layers[gl_InstanceID] : 0;
 })";
 
 // Código fonte do Fragment Shader (em GLSL): ainda hardcoded
 const GLchar *fragmentShaderSource = R"(
 #version 400
 in vec2 texCoord;
+flat in int layer;
+uniform bool useAtlas;
 uniform sampler2D texBuff;
+uniform sampler2DArray atlas;
 out vec4 color;
 void main()
 {
-	color = texture(texBuff,texCoord);
+	color = useAtlas ? texture(atlas, vec3(texCoord, layer)) : texture(texBuff,texCoord);
 })";
 
 // Função MAIN
@@ -118,18 +139,36 @@ int main()
 	// Gerando um buffer simples, com a geometria de um triângulo
 	GLuint VAO = setupGeometry();
 
-	// Carregando uma textura e armazenando seu id
-	int imgWidth, imgHeight;
-	GLuint texID = loadTexture("../assets/tex/pixelWall.png",imgWidth,imgHeight);
+	// Carregando uma textura (compartilhada com quem já usar o mesmo arquivo) e armazenando seu id
+	TextureHandle wall = textureManager().load("../assets/tex/pixelWall.png");
+	GLuint texID = wall->id;
+
+	// Para a cena da tecla T: as texturas dos triângulos juntas em um atlas,
+	// uma textura só para todos
+	TextureAtlas atlas;
+	int wallRegion = atlas.add("../assets/tex/pixelWall.png");
+	int suzanneRegion = atlas.add("../assets/Modelos3D/Suzanne.png");
+	int uvRegion = atlas.add("../assets/Modelos3D/SuzanneUV.png");
+	atlas.build();
 
 	glUseProgram(shaderID);
 
 	// Enviar a informação de qual variável armazenará o buffer da textura
 	glUniform1i(glGetUniformLocation(shaderID, "texBuff"), 0);
+	glUniform1i(glGetUniformLocation(shaderID, "atlas"), 1);
+
+	//Conectando o atlas uma única vez, no segundo buffer de textura da OpenGL
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, atlas.id());
 
 	//Ativando o primeiro buffer de textura da OpenGL
 	glActiveTexture(GL_TEXTURE0);
-	
+
+	// Os triângulos da cena com o atlas, cada um com a sua imagem
+	vector<AtlasInstance> triangles = {
+		{vec3(100.0, 500.0, 0.0), vec3(100.0, 100.0, 1.0), 0.0, wallRegion},
+		{vec3(350.0, 300.0, 0.0), vec3(200.0, 200.0, 1.0), 180.0, suzanneRegion},
+		{vec3(600.0, 200.0, 0.0), vec3(300.0, 300.0, 1.0), 0.0, uvRegion}};
 
 	// Matriz de projeção paralela ortográfica
 	// mat4 projection = ortho(-10.0, 10.0, -10.0, 10.0, -1.0, 1.0);
@@ -153,14 +192,21 @@ int main()
 		glBindVertexArray(VAO); // Conectando ao buffer de geometria
 		glBindTexture(GL_TEXTURE_2D, texID); //conectando com o buffer de textura que será usado no draw
 
-		// Primeiro Triângulo
-		drawTriangle(shaderID, VAO, vec3(100.0, 500.0, 0.0), vec3(100.0, 100.0, 1.0), 0.0, vec3(0.0, 0.0, 1.0));
+		glUniform1i(glGetUniformLocation(shaderID, "useAtlas"), showAtlas);
+		if (showAtlas)
+			// Os três triângulos, com texturas diferentes, em uma única chamada de desenho
+			drawAtlasInstances(shaderID, atlas, triangles, 3);
+		else
+		{
+			// Primeiro Triângulo
+			drawTriangle(shaderID, VAO, vec3(100.0, 500.0, 0.0), vec3(100.0, 100.0, 1.0), 0.0, vec3(0.0, 0.0, 1.0));
 
-		// Segundo Triângulo
-		drawTriangle(shaderID, VAO, vec3(350.0, 300.0, 0.0), vec3(200.0, 200.0, 1.0), 180.0, vec3(0.0, 1.0, 0.0));
+			// Segundo Triângulo
+			drawTriangle(shaderID, VAO, vec3(350.0, 300.0, 0.0), vec3(200.0, 200.0, 1.0), 180.0, vec3(0.0, 1.0, 0.0));
 
-		// Terceiro Triângulo
-		drawTriangle(shaderID, VAO, vec3(600.0, 200.0, 0.0), vec3(300.0, 300.0, 1.0), 0.0, vec3(1.0, 0.0, 0.0));
+			// Terceiro Triângulo
+			drawTriangle(shaderID, VAO, vec3(600.0, 200.0, 0.0), vec3(300.0, 300.0, 1.0), 0.0, vec3(1.0, 0.0, 0.0));
+		}
 
 		glBindVertexArray(0); // Desconectando o buffer de geometria
 
@@ -169,6 +215,9 @@ int main()
 	}
 	// Pede pra OpenGL desalocar os buffers
 	glDeleteVertexArrays(1, &VAO);
+	// Apaga a textura (último handle) e a do atlas antes de destruir o contexto
+	wall.reset();
+	atlas.clear();
 	// Finaliza a execução da GLFW, limpando os recursos alocados por ela
 	glfwTerminate();
 	return 0;
@@ -181,6 +230,8 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 {
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, GL_TRUE);
+	if (key == GLFW_KEY_T && action == GLFW_PRESS)
+		showAtlas = !showAtlas;
 }
 
 // Esta função está basntante hardcoded - objetivo é compilar e "buildar" um programa de
@@ -293,50 +344,6 @@ int setupGeometry()
 	return VAO;
 }
 
-GLuint loadTexture(string filePath, int &width, int &height)
-{
-	GLuint texID; // id da textura a ser carregada
-
-	// Gera o identificador da textura na memória
-	glGenTextures(1, &texID);
-	glBindTexture(GL_TEXTURE_2D, texID);
-
-	// Ajuste dos parâmetros de wrapping e filtering
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	// Carregamento da imagem usando a função stbi_load da biblioteca stb_image
-	int nrChannels;
-
-	unsigned char *data = stbi_load(filePath.c_str(), &width, &height, &nrChannels, 0);
-
-	if (data)
-	{
-		if (nrChannels == 3) // jpg, bmp
-		{
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		}
-		else // assume que é 4 canais png
-		{
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-		}
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture " << filePath << std::endl;
-	}
-
-	stbi_image_free(data);
-
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-	return texID;
-}
-
 void drawTriangle(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, float angle, vec3 color, vec3 axis)
 {
 	// Matriz de modelo: transformações na geometria (objeto)